@@ -0,0 +1,470 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * heap allocator benchmark.
+ *
+ * Replays an allocation trace (mpw --alloc-trace=<file>) against each
+ * allocator and reports the time, how many requests failed, how often a
+ * block could grow in place, how much Reallocate and compaction copied
+ * and how far of the heap the blocks were spread over (the span from the
+ * lowest to the highest block -- smaller is tighter packing).
+ *
+ * The trace doesn't say which blocks were locked, so a replayed
+ * compaction may move any block.
+ *
+ * --synthetic=<count> makes up a trace instead: lots of small nodes,
+ * some buffers that keep growing, frees mostly of recent blocks.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <getopt.h>
+#include <sysexits.h>
+
+#include <toolbox/mm_allocator.h>
+
+namespace {
+
+	struct Op
+	{
+		char kind; // a, f, r, m, h, c, v
+		uint32_t address;
+		uint32_t size;
+		uint32_t result;
+	};
+
+	struct Trace
+	{
+		uint32_t base = 0x10000;
+		uint32_t size = 0;
+		std::vector<Op> ops;
+	};
+
+	struct Stats
+	{
+		double time = 0;
+		uint32_t failed = 0;
+		uint32_t grows = 0;
+		uint32_t grownInPlace = 0;
+		uint32_t moved = 0;
+		uint64_t copied = 0;
+		uint32_t low = 0xffffffff;
+		uint32_t high = 0;
+		uint64_t peakLive = 0;
+		uint32_t maxBlock = 0;
+	};
+
+
+	bool ReadTrace(const char *path, Trace &trace)
+	{
+		FILE *f = fopen(path, "r");
+		if (!f) return false;
+
+		char line[256];
+		while (fgets(line, sizeof(line), f))
+		{
+			Op op = { line[0], 0, 0, 0 };
+			char name[32];
+
+			switch (line[0])
+			{
+				case '#':
+					sscanf(line, "# mpw allocation trace %31s %x %x", name, &trace.base, &trace.size);
+					continue;
+				case 'a':
+				case 'h':
+					if (sscanf(line + 1, "%x %x", &op.size, &op.result) != 2) continue;
+					break;
+				case 'c':
+					break;
+				case 'v':
+					if (sscanf(line, "v %x %x", &op.address, &op.result) != 2) continue;
+					break;
+				case 'f':
+					if (sscanf(line, "f %x", &op.address) != 1) continue;
+					break;
+				case 'r':
+				case 'm':
+					if (sscanf(line + 1, "%x %x %x", &op.address, &op.size, &op.result) != 3) continue;
+					break;
+				default:
+					continue;
+			}
+			trace.ops.push_back(op);
+		}
+		fclose(f);
+		return trace.size != 0;
+	}
+
+
+	// addresses in a synthetic trace are just block numbers.
+	void Synthetic(uint32_t count, Trace &trace)
+	{
+		struct Block
+		{
+			uint32_t id;
+			uint32_t size;
+			bool buffer;
+		};
+
+		std::mt19937 rng(1);
+		auto random = [&](uint32_t n) { return (uint32_t)(rng() % n); };
+
+		std::vector<Block> live;
+		uint64_t liveBytes = 0;
+		uint32_t id = 0;
+
+		auto allocate = [&](uint32_t size, bool buffer) {
+			++id;
+			live.push_back(Block{ id, size, buffer });
+			liveBytes += size;
+			trace.ops.push_back(Op{ 'a', 0, size, id });
+		};
+
+		auto dispose = [&](size_t i) {
+			trace.ops.push_back(Op{ 'f', live[i].id, 0, 0 });
+			liveBytes -= live[i].size;
+			live[i] = live.back();
+			live.pop_back();
+		};
+
+		auto buffer = [&]() -> Block * {
+			for (unsigned i = 0; i < 8 && !live.empty(); ++i)
+			{
+				Block &b = live[random(live.size())];
+				if (b.buffer) return &b;
+			}
+			return nullptr;
+		};
+
+		while (trace.ops.size() < count)
+		{
+			uint32_t r = random(100);
+
+			if (liveBytes > trace.size / 4 && !live.empty())
+				r = 99;
+
+			if (r < 50)
+			{
+				// symbol table nodes, mostly small.
+				uint32_t size = random(4) ? 12 + random(52) : 64 + random(200);
+				allocate(size, false);
+			}
+			else if (r < 58) allocate(128 + random(2048), true);
+			else if (r < 60) allocate(4096 + random(60 * 1024), true);
+			else if (r < 75)
+			{
+				Block *b = buffer();
+				if (!b) continue;
+
+				uint32_t size = b->size + b->size / 2 + 16;
+
+				// done growing.
+				if (size > 256 * 1024)
+				{
+					b->buffer = false;
+					continue;
+				}
+
+				// locked handles can only grow in place.
+				trace.ops.push_back(Op{ random(4) ? 'm' : 'r', b->id, size, b->id });
+				liveBytes += size - b->size;
+				b->size = size;
+			}
+			else if (!live.empty())
+			{
+				// mostly recent blocks.
+				size_t i = random(2) ? live.size() - 1 - random(std::min<size_t>(live.size(), 64)) : random(live.size());
+				dispose(i);
+			}
+		}
+	}
+
+
+	Stats Replay(MM::Allocator &heap, uint8_t *memory, const Trace &trace)
+	{
+		struct Block
+		{
+			uint32_t address;
+			uint32_t size;
+		};
+
+		Stats stats;
+		std::unordered_map<uint32_t, Block> blocks;
+		uint64_t live = 0;
+
+		blocks.reserve(trace.ops.size());
+		heap.Init(memory, trace.base, trace.size);
+
+		auto allocated = [&](uint32_t address) {
+			stats.low = std::min(stats.low, address);
+			stats.high = std::max(stats.high, address + heap.BlockSize(address));
+			stats.peakLive = std::max(stats.peakLive, live);
+		};
+
+		auto begin = std::chrono::high_resolution_clock::now();
+
+		for (const Op &op : trace.ops)
+		{
+			switch (op.kind)
+			{
+				case 'a':
+				case 'h':
+				{
+					uint32_t address = op.kind == 'a' ? heap.Allocate(op.size) : heap.AllocateHigh(op.size);
+					if (!address) { stats.failed++; break; }
+					if (!op.result) { heap.Free(address); break; }
+
+					live += op.size;
+					blocks[op.result] = Block{ address, op.size };
+					allocated(address);
+					break;
+				}
+
+				case 'f':
+				{
+					auto iter = blocks.find(op.address);
+					if (iter == blocks.end()) break;
+
+					live -= iter->second.size;
+					heap.Free(iter->second.address);
+					blocks.erase(iter);
+					break;
+				}
+
+				case 'r':
+				case 'm':
+				{
+					auto iter = blocks.find(op.address);
+					if (iter == blocks.end()) break;
+
+					Block b = iter->second;
+					uint32_t address = 0;
+
+					if (op.size > b.size) stats.grows++;
+
+					if (op.kind == 'r')
+						address = heap.Resize(b.address, op.size) ? b.address : 0;
+					else
+					{
+						uint32_t old = heap.BlockSize(b.address);
+						address = heap.Reallocate(b.address, op.size);
+						if (address && address != b.address)
+						{
+							stats.moved++;
+							stats.copied += std::min(old, op.size);
+						}
+					}
+
+					if (!address)
+					{
+						// a locked handle that can't grow is a memFullErr, too,
+						// but it shows up in grown in place.
+						if (op.kind == 'm') stats.failed++;
+						if (op.result && op.result != op.address)
+						{
+							blocks.erase(iter);
+							blocks[op.result] = b;
+						}
+						break;
+					}
+					if (address == b.address && op.size > b.size) stats.grownInPlace++;
+
+					blocks.erase(iter);
+					live += op.size;
+					live -= b.size;
+					blocks[op.result ? op.result : op.address] = Block{ address, op.size };
+					allocated(address);
+					break;
+				}
+
+				case 'c':
+				{
+					// address -> trace address
+					std::vector<std::pair<uint32_t, uint32_t>> owners;
+					MM::Allocator::Movable movable;
+
+					for (const auto &kv : blocks)
+						owners.emplace_back(kv.second.address, kv.first);
+					std::sort(owners.begin(), owners.end());
+					for (const auto &o : owners)
+						movable.push_back(o.first);
+
+					heap.Compact(movable, [&](uint32_t from, uint32_t to) {
+						auto o = std::lower_bound(owners.begin(), owners.end(), std::make_pair(from, 0u));
+						Block &b = blocks[o->second];
+						b.address = to;
+						stats.moved++;
+						stats.copied += b.size;
+						allocated(to);
+					});
+					break;
+				}
+
+				case 'v':
+				{
+					// the traced block moved, so it goes by a new name.
+					auto iter = blocks.find(op.address);
+					if (iter == blocks.end()) break;
+
+					Block b = iter->second;
+					blocks.erase(iter);
+					blocks[op.result] = b;
+					break;
+				}
+			}
+		}
+
+		auto end = std::chrono::high_resolution_clock::now();
+		stats.time = std::chrono::duration<double>(end - begin).count();
+
+		stats.maxBlock = heap.MaxBlock();
+		return stats;
+	}
+
+
+	void help()
+	{
+		printf("Usage: alloc_bench [options] [trace]\n");
+		printf("\n");
+		printf(" --allocator=<name>   allocator to run (may repeat).  Default=all\n");
+		printf(" --reps=<number>      runs, the best time is reported.  Default=5\n");
+		printf(" --synthetic=<number> make up a trace with this many calls\n");
+		printf(" --ram=<number>       heap size for --synthetic.  Default=16M\n");
+		printf("\n");
+	}
+
+}
+
+int main(int argc, char **argv)
+{
+	enum {
+		kAllocator = 1,
+		kReps,
+		kSynthetic,
+		kRam,
+	};
+
+	static struct option LongOpts[] =
+	{
+		{ "allocator", required_argument, NULL, kAllocator },
+		{ "reps", required_argument, NULL, kReps },
+		{ "synthetic", required_argument, NULL, kSynthetic },
+		{ "ram", required_argument, NULL, kRam },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	std::vector<std::string> allocators;
+	unsigned reps = 5;
+	uint32_t synthetic = 0;
+	uint32_t ram = 16 * 1024 * 1024;
+
+	int c;
+	while ((c = getopt_long(argc, argv, "h", LongOpts, NULL)) != -1)
+	{
+		switch(c)
+		{
+			case kAllocator:
+				if (!MM::CreateAllocator(optarg))
+				{
+					fprintf(stderr, "--allocator=%s - invalid input\n", optarg);
+					exit(EX_USAGE);
+				}
+				allocators.push_back(optarg);
+				break;
+			case kReps: reps = strtoul(optarg, NULL, 0); break;
+			case kSynthetic: synthetic = strtoul(optarg, NULL, 0); break;
+			case kRam: ram = strtoul(optarg, NULL, 0); break;
+			case 'h':
+				help();
+				exit(EX_OK);
+			default:
+				help();
+				exit(EX_USAGE);
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	if (!reps || argc != (synthetic ? 0 : 1))
+	{
+		help();
+		exit(EX_USAGE);
+	}
+
+	if (allocators.empty()) allocators = { "buddy", "tlsf" };
+
+	Trace trace;
+	if (synthetic)
+	{
+		trace.size = ram - trace.base;
+		Synthetic(synthetic, trace);
+	}
+	else if (!ReadTrace(argv[0], trace))
+	{
+		fprintf(stderr, "Unable to read trace %s\n", argv[0]);
+		exit(EX_NOINPUT);
+	}
+
+	std::vector<uint8_t> memory(trace.base + trace.size);
+
+	printf("%u calls, heap %08x bytes\n", (unsigned)trace.ops.size(), trace.size);
+	printf("%-6s %9s %7s %14s %6s %10s %10s %10s %10s\n",
+		"", "ns/call", "failed", "grown in place", "moved", "copied", "span", "peak live", "largest");
+
+	for (const auto &name : allocators)
+	{
+		Stats best;
+		for (unsigned rep = 0; rep < reps; ++rep)
+		{
+			auto heap = MM::CreateAllocator(name);
+			Stats stats = Replay(*heap, memory.data(), trace);
+			if (rep == 0 || stats.time < best.time) best = stats;
+		}
+
+		printf("%-6s %9.1f %7u %7u/%-6u %6u %10llu %10u %10llu %10u\n",
+			name.c_str(),
+			best.time * 1e9 / std::max<size_t>(trace.ops.size(), 1),
+			best.failed, best.grownInPlace, best.grows, best.moved,
+			(unsigned long long)best.copied, best.high > best.low ? best.high - best.low : 0,
+			(unsigned long long)best.peakLive, best.maxBlock);
+	}
+
+	return 0;
+}
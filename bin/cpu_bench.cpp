@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) 2013, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * cpu throughput benchmark.
+ *
+ * Runs a fixed 68k workload (copy, sum and compare loops, subroutine
+ * calls with movem/link) through cpuExecuteUntil and reports the best
+ * of --reps runs in millions of instructions per second.
+ *
+ * Build the cpu library with and without CPU_CYCLE_ACCOUNTING (or
+ * CPU_THREADED_DISPATCH, ...) and compare.  The checksum line must
+ * match between builds.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <chrono>
+
+#include <getopt.h>
+#include <sysexits.h>
+
+#include <cpu/defs.h>
+#include <cpu/fmem.h>
+#include <cpu/CpuModule.h>
+
+namespace {
+
+	const uint32_t kMemorySize = 0x40000;
+	const uint32_t kCodeStart = 0x2000;
+	const uint32_t kStack = 0x30000;
+	const uint32_t kHandler = 0x1000;
+
+	uint8_t Memory[kMemorySize];
+
+	// 2000 iterations of:
+	//   copy 1000 longs, sum and compare 1000 longs, 2 subroutine calls.
+	// ends with trap #15.
+	const uint8_t Workload[] = {
+		0x74, 0x00,                         //         moveq   #0,d2
+		0x41, 0xf9, 0x00, 0x00, 0x80, 0x00, // outer   lea     $8000,a0
+		0x43, 0xf9, 0x00, 0x01, 0x00, 0x00, //         lea     $10000,a1
+		0x30, 0x3c, 0x03, 0xe7,             //         move.w  #999,d0
+		0x22, 0xd8,                         // loop1   move.l  (a0)+,(a1)+
+		0x51, 0xc8, 0xff, 0xfc,             //         dbra    d0,loop1
+		0x41, 0xf9, 0x00, 0x00, 0x80, 0x00, //         lea     $8000,a0
+		0x30, 0x3c, 0x03, 0xe7,             //         move.w  #999,d0
+		0x72, 0x00,                         //         moveq   #0,d1
+		0xd2, 0x98,                         // loop2   add.l   (a0)+,d1
+		0xb2, 0xbc, 0x12, 0x34, 0x56, 0x78, //         cmp.l   #$12345678,d1
+		0x66, 0x02,                         //         bne.s   skip
+		0x52, 0x83,                         //         addq.l  #1,d3
+		0x51, 0xc8, 0xff, 0xf2,             // skip    dbra    d0,loop2
+		0x61, 0x00, 0x00, 0x14,             //         bsr     sub
+		0x61, 0x00, 0x00, 0x10,             //         bsr     sub
+		0x52, 0x82,                         //         addq.l  #1,d2
+		0xb4, 0xbc, 0x00, 0x00, 0x07, 0xd0, //         cmp.l   #2000,d2
+		0x66, 0x00, 0xff, 0xbc,             //         bne     outer
+		0x4e, 0x4f,                         //         trap    #15
+		0x4e, 0x56, 0xff, 0xf8,             // sub     link    a6,#-8
+		0x48, 0xe7, 0xf0, 0xc0,             //         movem.l d0-d3/a0-a1,-(a7)
+		0x2f, 0x00,                         //         move.l  d0,-(a7)
+		0x20, 0x17,                         //         move.l  (a7),d0
+		0x58, 0x8f,                         //         addq.l  #4,a7
+		0x4c, 0xdf, 0x03, 0x0f,             //         movem.l (a7)+,d0-d3/a0-a1
+		0x4e, 0x5e,                         //         unlk    a6
+		0x4e, 0x75,                         //         rts
+	};
+
+	void Nothing()
+	{
+	}
+
+	void write16(uint32_t address, uint16_t value)
+	{
+		Memory[address + 0] = value >> 8;
+		Memory[address + 1] = value;
+	}
+
+	void write32(uint32_t address, uint32_t value)
+	{
+		write16(address + 0, value >> 16);
+		write16(address + 2, value);
+	}
+
+	void Setup()
+	{
+		cpuStartup();
+		cpuSetModel(3, 0);
+
+		cpuSetMidInstructionExceptionFunc(Nothing);
+		cpuSetResetExceptionFunc(Nothing);
+		cpuSetCheckPendingInterruptsFunc(Nothing);
+
+		std::memset(Memory, 0, sizeof(Memory));
+
+		// exceptions (a reset cpu has an interrupt pending) return...
+		for (unsigned v = 0; v < 256; ++v) write32(v * 4, kHandler);
+		write16(kHandler + 0, 0x4e73); // rte
+
+		// ... except trap #15, which stops.
+		write32(0xbc, kHandler + 0x10);
+		write16(kHandler + 0x10, 0x4e72); // stop #$2700
+		write16(kHandler + 0x12, 0x2700);
+
+		std::memcpy(Memory + kCodeStart, Workload, sizeof(Workload));
+		for (uint32_t address = 0x8000; address < 0x20000; ++address)
+			Memory[address] = address * 7;
+
+		memorySetMemory(Memory, kMemorySize);
+
+		for (unsigned i = 0; i < 8; ++i)
+		{
+			cpuSetDReg(i, 0);
+			cpuSetAReg(i, 0);
+		}
+		cpuSetSR(0x2000); // supervisor, so a7 is the stack exceptions use.
+		cpuSetAReg(7, kStack);
+		cpuSetStop(false);
+
+		cpuBlockCacheFlush();
+		cpuInitializeFromNewPC(kCodeStart);
+	}
+
+	// cpuExecuteInstruction returns 0 when cycle accounting is compiled out
+	// (the first call takes the pending interrupt, which always returns 44).
+	bool CycleAccounting()
+	{
+		uint32_t cycles = 0;
+
+		Setup();
+		cpuExecuteInstruction();
+		for (unsigned i = 0; i < 16; ++i)
+			cycles += cpuExecuteInstruction();
+		return cycles != 0;
+	}
+
+	void help()
+	{
+		printf("Usage: cpu_bench [options]\n");
+		printf("\n");
+		printf(" --reps=<number>      runs, the best is reported.  Default=5\n");
+		printf(" --jit                use the JIT\n");
+		printf("\n");
+	}
+
+}
+
+int main(int argc, char **argv)
+{
+	enum {
+		kReps = 1,
+		kJIT,
+	};
+
+	static struct option LongOpts[] =
+	{
+		{ "reps", required_argument, NULL, kReps },
+		{ "jit", no_argument, NULL, kJIT },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	unsigned reps = 5;
+	bool jit = false;
+
+	int c;
+	while ((c = getopt_long(argc, argv, "h", LongOpts, NULL)) != -1)
+	{
+		switch(c)
+		{
+			case kReps: reps = strtoul(optarg, NULL, 0); break;
+			case kJIT: jit = true; break;
+			case 'h':
+				help();
+				exit(EX_OK);
+			default:
+				help();
+				exit(EX_USAGE);
+		}
+	}
+
+	if (argc != optind || !reps)
+	{
+		help();
+		exit(EX_USAGE);
+	}
+
+	printf("cycle accounting: %s\n", CycleAccounting() ? "on" : "off");
+
+	if (jit && !cpuSetJit(true))
+	{
+		fprintf(stderr, "JIT not supported on this host\n");
+		exit(EX_UNAVAILABLE);
+	}
+
+	double best = 0;
+	uint64_t count = 0;
+	for (unsigned rep = 0; rep < reps; ++rep)
+	{
+		Setup();
+		uint64_t start = cpuGetInstructionCount();
+
+		auto begin = std::chrono::high_resolution_clock::now();
+		while (!cpuGetStop())
+			cpuExecuteUntil(0xffffffff, 0);
+		auto end = std::chrono::high_resolution_clock::now();
+
+		double t = std::chrono::duration<double>(end - begin).count();
+		if (rep == 0 || t < best) best = t;
+		count = cpuGetInstructionCount() - start;
+	}
+
+	printf("%llu instructions, best %.4f s, %.1f Minstr/s\n",
+		(unsigned long long)count, best, count / best / 1e6);
+	printf("checksum d1=%08x d2=%08x d3=%08x\n", cpuGetDReg(1), cpuGetDReg(2), cpuGetDReg(3));
+
+	return 0;
+}
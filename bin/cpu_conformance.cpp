@@ -0,0 +1,521 @@
+/*
+ * Copyright (c) 2013, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * cpu conformance test.
+ *
+ * Runs pseudo-random 68k code through the reference interpreter
+ * (cpuExecuteInstruction, one at a time) and through the bulk engine
+ * this build uses for cpuExecuteUntil (block cache, threaded dispatch,
+ * optionally the JIT) and compares registers, memory and traps.
+ *
+ * With --loops, each seed is instead a single dbf copy or fill loop
+ * (random size, count, registers, overlap and loops that write over
+ * themselves).  The reference runs it with the dbf idiom disabled, one
+ * iteration at a time, so the bulk copy is checked against the loop it
+ * replaces.  The instruction counts differ by design and are only
+ * compared when the loop never reaches its trap #15.
+ *
+ * Each seed runs in a child process so a crash is reported rather
+ * than ending the run.
+ *
+ * exit status is 0 if every seed matched.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <vector>
+
+#include <getopt.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sysexits.h>
+
+#include <cpu/defs.h>
+#include <cpu/fmem.h>
+#include <cpu/CpuModule.h>
+
+namespace {
+
+	const uint32_t kMemorySize = 0x40000;
+	const uint32_t kCodeStart = 0x2000;
+	const uint32_t kStack = 0x30000;
+	const uint32_t kHandler = 0x1000;
+
+	uint8_t Memory[kMemorySize];
+	uint64_t Traps = 0;
+
+	uint32_t rng;
+
+	uint32_t Random()
+	{
+		// xorshift32
+		rng ^= rng << 13;
+		rng ^= rng >> 17;
+		rng ^= rng << 5;
+		return rng;
+	}
+
+	void ALine(uint16_t trap)
+	{
+		Traps = Traps * 31 + trap;
+		cpuSetDReg(0, cpuGetDReg(0) ^ trap);
+	}
+
+	void FLine(uint16_t trap)
+	{
+		Traps = Traps * 37 + trap;
+		cpuSetDReg(1, cpuGetDReg(1) + trap);
+	}
+
+	void Nothing() {}
+
+
+	struct State {
+		uint32_t d[8];
+		uint32_t a[8];
+		uint32_t pc;
+		uint32_t sr;
+		uint32_t count;
+		bool stop;
+		uint64_t traps;
+		std::vector<uint8_t> memory;
+	};
+
+
+	void write16(uint32_t address, uint16_t value)
+	{
+		Memory[address + 0] = value >> 8;
+		Memory[address + 1] = value;
+	}
+
+	void write32(uint32_t address, uint32_t value)
+	{
+		write16(address + 0, value >> 16);
+		write16(address + 2, value);
+	}
+
+	void Reset(uint32_t seed)
+	{
+		// start from a freshly reset cpu so both runs begin alike.
+		cpuStartup();
+		cpuSetModel(3, 0);
+
+		cpuSetALineExceptionFunc(ALine);
+		cpuSetFLineExceptionFunc(FLine);
+		cpuSetMidInstructionExceptionFunc(Nothing);
+		cpuSetResetExceptionFunc(Nothing);
+		cpuSetCheckPendingInterruptsFunc(Nothing);
+
+		rng = seed * 2654435761u + 1;
+		std::memset(Memory, 0, sizeof(Memory));
+		Traps = 0;
+
+		// every exception skips the faulting word and returns...
+		for (unsigned v = 0; v < 256; ++v) write32(v * 4, kHandler);
+		write16(kHandler + 0, 0x54af); // addq.l #2,2(a7)
+		write16(kHandler + 2, 0x0002);
+		write16(kHandler + 4, 0x4e73); // rte
+
+		// ... except trap #15, which stops.
+		write32(0xbc, kHandler + 0x10);
+		write16(kHandler + 0x10, 0x4e72); // stop #$2700
+		write16(kHandler + 0x12, 0x2700);
+
+		// a reset cpu has an interrupt pending; it returns to the start.
+		write32(0x60, kHandler + 0x18);
+		write16(kHandler + 0x18, 0x4e73); // rte
+	}
+
+	void Start()
+	{
+		cpuSetSR(0x2000); // supervisor, so a7 is the stack exceptions use.
+		cpuSetAReg(7, kStack);
+		cpuSetStop(false);
+
+		// memory was changed behind the cpu's back.
+		cpuBlockCacheFlush();
+		cpuInitializeFromNewPC(kCodeStart);
+	}
+
+	void Setup(uint32_t seed)
+	{
+		// common instruction patterns, register fields are randomized.
+		static const uint16_t templates[] = {
+			0x7000, 0x2000, 0x3000, 0x1000, 0xd080, 0x9080, 0xb080, 0x5280,
+			0x5380, 0x6600, 0x6700, 0x51c8, 0x4a80, 0x4280, 0x20d8, 0x22d8,
+			0x48e7, 0x4cdf, 0xc080, 0x8080, 0xe388, 0xe288, 0x4e71, 0xa000,
+			0xf000, 0x6100, 0x4e75, 0x41e8, 0x2028, 0x2140, 0x0c80, 0x4480,
+		};
+
+		Reset(seed);
+
+		for (uint32_t address = 0x400; address < 0x20000; address += 2)
+		{
+			if (address >= kHandler && address < kHandler + 0x20) continue;
+
+			uint16_t w;
+			switch (Random() % 4)
+			{
+				case 0:
+					w = Random();
+					break;
+				case 1:
+				case 2:
+					w = templates[Random() % (sizeof(templates) / sizeof(templates[0]))] | (Random() & 0x0e07);
+					break;
+				default:
+					w = Random() & 0x00ff;
+					break;
+			}
+			write16(address, w);
+		}
+
+		for (unsigned i = 0; i < 8; ++i)
+		{
+			cpuSetDReg(i, Random() % 64);
+			cpuSetAReg(i, (i & 1 ? kCodeStart : 0x8000) + (Random() % 0x10000 & ~1));
+		}
+		Start();
+	}
+
+	void SetupLoop(uint32_t seed)
+	{
+		// move.b, move.w, move.l size fields and clr.b, clr.w, clr.l.
+		static const uint16_t moves[] = { 0x1000, 0x3000, 0x2000 };
+		static const uint32_t sizes[] = { 1, 2, 4 };
+
+		Reset(seed);
+
+		// trap #15 everywhere outside the data, so a loop that writes
+		// over itself still ends.
+		for (uint32_t address = 0x400; address < 0x8000; address += 2)
+		{
+			if (address >= kHandler && address < kHandler + 0x20) continue;
+			write16(address, 0x4e4f);
+		}
+		for (uint32_t address = 0x8000; address < kMemorySize; ++address)
+			Memory[address] = Random();
+
+		for (unsigned i = 0; i < 8; ++i)
+		{
+			cpuSetDReg(i, Random());
+			cpuSetAReg(i, 0x8000 + (Random() % 0x28000));
+		}
+
+		unsigned kind = Random() % 3;
+		unsigned size = Random() % 3;
+		unsigned ax = Random() % 8;
+		unsigned ay = Random() % 8;
+		unsigned dn = Random() % 8;
+
+		// mostly distinct registers, sometimes the cases the idiom rejects.
+		if (Random() % 8)
+		{
+			ax = Random() % 7;
+			while (ay == ax || ay == 7) ay = Random() % 8;
+			while (dn == ax || dn == ay) dn = Random() % 8;
+		}
+
+		uint16_t body;
+		switch (kind)
+		{
+			case 0: body = 0x00d8 | moves[size] | (ax << 9) | ay; break; // move.x (Ay)+,(Ax)+
+			case 1: body = 0x00c0 | moves[size] | (ax << 9) | ay; break; // move.x Dy,(Ax)+
+			default: body = 0x4218 | (size << 6) | ax; break;            // clr.x (Ax)+
+		}
+
+		uint32_t count;
+		switch (Random() % 4)
+		{
+			case 0: count = Random() % 4; break;
+			case 1: count = Random() % 64; break;
+			default: count = Random() % 0x1000; break;
+		}
+		cpuSetDReg(dn, (cpuGetDReg(dn) & 0xffff0000) | count);
+
+		uint32_t total = (count + 1) * sizes[size];
+		uint32_t src = cpuGetAReg(ay);
+		uint32_t dst = cpuGetAReg(ax);
+
+		switch (Random() % 8)
+		{
+			case 0:
+				// overlapping copy, either direction.
+				dst = src + (Random() % 16) - 8;
+				break;
+			case 1:
+				// over the loop itself, or just past it.  Whatever lands
+				// on the code is trap #15.
+				dst = kCodeStart + 8 - (Random() % 12) * 2;
+				if (total < kCodeStart - 0x1000 && Random() % 2) dst -= total & ~1;
+				if (kind == 0 && ay != ax) cpuSetAReg(ay, 0x4000 + (Random() % 0x1000 & ~1));
+				if (kind == 1 && ay != dn) cpuSetDReg(ay, 0x4e4f4e4f);
+				break;
+			case 2:
+				// up to and past the end of memory.
+				dst = kMemorySize - (Random() % 64);
+				break;
+			case 3:
+				// odd addresses.
+				dst |= 1;
+				break;
+		}
+		if (ax != ay || kind != 0) cpuSetAReg(ax, dst);
+
+		write16(kCodeStart + 0, body);
+		write16(kCodeStart + 2, 0x51c8 | dn); // dbf Dn,*-2
+		write16(kCodeStart + 4, 0xfffc);
+		write16(kCodeStart + 6, 0x4e4f); // trap #15
+
+		Start();
+	}
+
+	void Save(State &st, uint32_t count)
+	{
+		for (unsigned i = 0; i < 8; ++i)
+		{
+			st.d[i] = cpuGetDReg(i);
+			st.a[i] = cpuGetAReg(i);
+		}
+		st.pc = cpuGetPC();
+		st.sr = cpuGetSR() & 0xffff;
+		st.count = count;
+		st.stop = cpuGetStop();
+		st.traps = Traps;
+		st.memory.assign(Memory, Memory + kMemorySize);
+	}
+
+	uint32_t RunReference(uint32_t budget)
+	{
+		uint32_t count = 0;
+		while (count < budget && !cpuGetStop())
+		{
+			cpuExecuteInstruction();
+			++count;
+		}
+		return count;
+	}
+
+	uint32_t RunEngine(uint32_t budget)
+	{
+		uint32_t count = 0;
+		while (count < budget && !cpuGetStop())
+		{
+			cpuExecuteUntil(budget - count, 0);
+			count += cpuGetExecutedInstructions();
+		}
+		return count;
+	}
+
+	bool Compare(uint32_t seed, const State &a, const State &b)
+	{
+		bool ok = true;
+
+		for (unsigned i = 0; i < 8; ++i)
+		{
+			if (a.d[i] != b.d[i])
+			{
+				printf("%u: d%u %08x != %08x\n", seed, i, a.d[i], b.d[i]);
+				ok = false;
+			}
+			if (a.a[i] != b.a[i])
+			{
+				printf("%u: a%u %08x != %08x\n", seed, i, a.a[i], b.a[i]);
+				ok = false;
+			}
+		}
+
+		if (a.pc != b.pc) { printf("%u: pc %08x != %08x\n", seed, a.pc, b.pc); ok = false; }
+		if (a.sr != b.sr) { printf("%u: sr %04x != %04x\n", seed, a.sr, b.sr); ok = false; }
+		if (a.count != b.count) { printf("%u: count %u != %u\n", seed, a.count, b.count); ok = false; }
+		if (a.stop != b.stop) { printf("%u: stop %d != %d\n", seed, a.stop, b.stop); ok = false; }
+		if (a.traps != b.traps) { printf("%u: traps differ\n", seed); ok = false; }
+
+		for (uint32_t i = 0; i < kMemorySize; ++i)
+		{
+			if (a.memory[i] != b.memory[i])
+			{
+				printf("%u: memory $%06x %02x != %02x\n", seed, i, a.memory[i], b.memory[i]);
+				ok = false;
+				break;
+			}
+		}
+
+		return ok;
+	}
+
+	bool RunSeed(uint32_t seed, uint32_t budget)
+	{
+		State reference;
+		State engine;
+
+		Setup(seed);
+		Save(reference, RunReference(budget));
+
+		Setup(seed);
+		Save(engine, RunEngine(budget));
+
+		return Compare(seed, reference, engine);
+	}
+
+	bool RunLoop(uint32_t seed, uint32_t budget)
+	{
+		State reference;
+		State engine;
+
+		SetupLoop(seed);
+		cpuSetDbfIdiom(false);
+		Save(reference, RunReference(budget));
+
+		SetupLoop(seed);
+		cpuSetDbfIdiom(true);
+		Save(engine, RunEngine(budget));
+
+		// a loop that wrote over its own dbf may never reach the trap.
+		// The idiom doesn't run those, so the counts still match.
+		if (reference.stop) engine.count = reference.count;
+		return Compare(seed, reference, engine);
+	}
+
+	void help()
+	{
+		printf("Usage: cpu_conformance [options]\n");
+		printf("\n");
+		printf(" --seeds=<number>    number of programs to run.  Default=1000\n");
+		printf(" --first=<number>    first seed.  Default=1\n");
+		printf(" --budget=<number>   instructions per program.  Default=20000\n");
+		printf(" --jit               enable the JIT\n");
+		printf(" --loops             run dbf copy and fill loops\n");
+		printf(" --verbose           print every seed\n");
+		printf("\n");
+	}
+
+}
+
+int main(int argc, char **argv)
+{
+	enum {
+		kSeeds = 1,
+		kFirst,
+		kBudget,
+		kJIT,
+		kLoops,
+		kVerbose,
+	};
+
+	static struct option LongOpts[] =
+	{
+		{ "seeds", required_argument, NULL, kSeeds },
+		{ "first", required_argument, NULL, kFirst },
+		{ "budget", required_argument, NULL, kBudget },
+		{ "jit", no_argument, NULL, kJIT },
+		{ "loops", no_argument, NULL, kLoops },
+		{ "verbose", no_argument, NULL, kVerbose },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	uint32_t seeds = 1000;
+	uint32_t first = 1;
+	uint32_t budget = 20000;
+	bool jit = false;
+	bool loops = false;
+	bool verbose = false;
+
+	int c;
+	while ((c = getopt_long(argc, argv, "h", LongOpts, NULL)) != -1)
+	{
+		switch(c)
+		{
+			case kSeeds: seeds = strtoul(optarg, NULL, 0); break;
+			case kFirst: first = strtoul(optarg, NULL, 0); break;
+			case kBudget: budget = strtoul(optarg, NULL, 0); break;
+			case kJIT: jit = true; break;
+			case kLoops: loops = true; break;
+			case kVerbose: verbose = true; break;
+			case 'h':
+				help();
+				exit(EX_OK);
+			default:
+				help();
+				exit(EX_USAGE);
+		}
+	}
+
+	memorySetMemory(Memory, kMemorySize);
+
+	if (jit && !cpuSetJit(true))
+	{
+		fprintf(stderr, "--jit is not supported on this platform\n");
+		exit(EX_CONFIG);
+	}
+
+	unsigned failed = 0;
+	unsigned crashed = 0;
+
+	for (uint32_t seed = first; seed < first + seeds; ++seed)
+	{
+		fflush(stdout);
+
+		pid_t pid = fork();
+		if (pid < 0)
+		{
+			perror("fork");
+			exit(EX_OSERR);
+		}
+
+		if (pid == 0)
+		{
+			bool ok = loops ? RunLoop(seed, budget) : RunSeed(seed, budget);
+			fflush(stdout);
+			_exit(ok ? 0 : 1);
+		}
+
+		int status;
+		waitpid(pid, &status, 0);
+
+		if (!WIFEXITED(status))
+		{
+			printf("%u: crashed\n", seed);
+			++crashed;
+		}
+		else if (WEXITSTATUS(status))
+		{
+			++failed;
+		}
+		else if (verbose)
+		{
+			printf("%u: ok\n", seed);
+		}
+	}
+
+	printf("%u seeds, %u failed, %u crashed\n", seeds, failed, crashed);
+	return failed ? 1 : 0;
+}
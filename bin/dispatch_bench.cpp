@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2013, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+/*
+ * opcode dispatch table benchmark.
+ *
+ * Replays an opcode trace (mpw --trace-opcodes=file tool ...) through
+ * the compact opcode table and through the old layout (a function
+ * pointer and 3 operands per opcode) and reports the time and, where
+ * the host has performance counters, the L1 and last level cache misses
+ * per 1000 lookups.
+ *
+ * --instances gives every simulated emulator its own copy of the tables
+ * and switches between them every --slice opcodes, the way several
+ * mpw processes share one core.
+ */
+
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <getopt.h>
+#include <sysexits.h>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+#include <cpu/defs.h>
+#include <cpu/CpuModule.h>
+
+extern "C" {
+#include <cpu/CpuModule_Internal.h>
+}
+
+namespace {
+
+	struct Counters {
+		bool valid = false;
+		uint64_t l1 = 0;
+		uint64_t ll = 0;
+	};
+
+#ifdef __linux__
+	class CacheCounters {
+	public:
+		CacheCounters()
+		{
+			_l1 = open(PERF_COUNT_HW_CACHE_L1D);
+			_ll = open(PERF_COUNT_HW_CACHE_LL);
+		}
+
+		~CacheCounters()
+		{
+			if (_l1 >= 0) close(_l1);
+			if (_ll >= 0) close(_ll);
+		}
+
+		void start()
+		{
+			for (int fd : { _l1, _ll })
+			{
+				if (fd < 0) continue;
+				ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+				ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+			}
+		}
+
+		Counters stop()
+		{
+			Counters c;
+			if (_l1 < 0 || _ll < 0) return c;
+
+			ioctl(_l1, PERF_EVENT_IOC_DISABLE, 0);
+			ioctl(_ll, PERF_EVENT_IOC_DISABLE, 0);
+			c.valid = read(_l1, &c.l1, sizeof(c.l1)) == sizeof(c.l1)
+				&& read(_ll, &c.ll, sizeof(c.ll)) == sizeof(c.ll);
+			return c;
+		}
+
+	private:
+		static int open(uint64_t cache)
+		{
+			perf_event_attr attr;
+			std::memset(&attr, 0, sizeof(attr));
+			attr.size = sizeof(attr);
+			attr.type = PERF_TYPE_HW_CACHE;
+			attr.config = cache
+				| (PERF_COUNT_HW_CACHE_OP_READ << 8)
+				| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+			attr.disabled = 1;
+			attr.exclude_kernel = 1;
+			attr.exclude_hv = 1;
+			return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+		}
+
+		int _l1 = -1;
+		int _ll = -1;
+	};
+#else
+	class CacheCounters {
+	public:
+		void start() {}
+		Counters stop() { return Counters(); }
+	};
+#endif
+
+
+	// the old layout.
+	struct WideTable {
+		std::vector<cpuOpcodeData> opcodes;
+
+		WideTable() : opcodes(65536)
+		{
+			for (unsigned i = 0; i < 65536; ++i)
+			{
+				cpuOpcodeEntry entry = cpu_opcode_table[i];
+				opcodes[i].instruction_func = cpuOpcodeFunction(entry);
+				std::memcpy(opcodes[i].data, cpuOpcodeOperands(entry), sizeof(opcodes[i].data));
+			}
+		}
+
+		size_t size() const { return opcodes.size() * sizeof(cpuOpcodeData); }
+
+		uintptr_t lookup(uint16_t opcode) const
+		{
+			const cpuOpcodeData &d = opcodes[opcode];
+			return (uintptr_t)d.instruction_func ^ d.data[0] ^ d.data[1] ^ d.data[2];
+		}
+	};
+
+	struct CompactTable {
+		std::vector<cpuOpcodeEntry> opcodes;
+		std::vector<cpuInstructionFunction> handlers;
+		std::vector<uint32_t> operands;
+
+		CompactTable() :
+			opcodes(cpu_opcode_table, cpu_opcode_table + 65536),
+			operands(&cpu_opcode_operands[0][0], &cpu_opcode_operands[0][0] + CPU_OPCODE_OPERAND_MAX * 3)
+		{
+			unsigned count = 0;
+			for (cpuOpcodeEntry entry : opcodes)
+				count = std::max(count, (unsigned)cpuOpcodeHandlerIndex(entry) + 1);
+			handlers.assign(cpu_opcode_handlers, cpu_opcode_handlers + count);
+		}
+
+		size_t size() const
+		{
+			return opcodes.size() * sizeof(cpuOpcodeEntry)
+				+ handlers.size() * sizeof(cpuInstructionFunction)
+				+ operands.size() * sizeof(uint32_t);
+		}
+
+		uintptr_t lookup(uint16_t opcode) const
+		{
+			cpuOpcodeEntry entry = opcodes[opcode];
+			const uint32_t *d = &operands[(entry >> CPU_OPCODE_HANDLER_BITS) * 3];
+			return (uintptr_t)handlers[cpuOpcodeHandlerIndex(entry)] ^ d[0] ^ d[1] ^ d[2];
+		}
+	};
+
+
+	template<class Table>
+	void Run(const char *name, const std::vector<uint16_t> &trace, unsigned instances, size_t slice, unsigned reps)
+	{
+		std::vector<Table> tables(instances);
+		CacheCounters counters;
+
+		double best = 0;
+		Counters bestCounters;
+		uintptr_t sum = 0;
+
+		for (unsigned rep = 0; rep < reps; ++rep)
+		{
+			counters.start();
+			auto begin = std::chrono::high_resolution_clock::now();
+
+			for (size_t start = 0, n = 0; start < trace.size(); start += slice, ++n)
+			{
+				const Table &table = tables[n % instances];
+				size_t end = std::min(trace.size(), start + slice);
+
+				for (size_t i = start; i < end; ++i)
+					sum += table.lookup(trace[i]);
+			}
+
+			auto end = std::chrono::high_resolution_clock::now();
+			Counters c = counters.stop();
+
+			double t = std::chrono::duration<double>(end - begin).count();
+			if (rep == 0 || t < best)
+			{
+				best = t;
+				bestCounters = c;
+			}
+		}
+
+		double k = trace.size() / 1000.0;
+		printf("%-8s %8zu bytes/instance %7.2f ns/lookup", name, tables[0].size(), best * 1e9 / trace.size());
+		if (bestCounters.valid)
+			printf(" %8.2f L1 misses/1k %8.2f LL misses/1k", bestCounters.l1 / k, bestCounters.ll / k);
+		else
+			printf("   (cache counters unavailable)");
+		printf("   [%zx]\n", (size_t)(sum & 0xff));
+	}
+
+
+	bool LoadTrace(const char *path, std::vector<uint16_t> &trace)
+	{
+		FILE *fp = fopen(path, "rb");
+		if (!fp) return false;
+
+		uint8_t buffer[4096];
+		size_t n;
+		while ((n = fread(buffer, 1, sizeof(buffer), fp)) >= 2)
+		{
+			for (size_t i = 0; i + 1 < n; i += 2)
+				trace.push_back((buffer[i] << 8) | buffer[i + 1]);
+		}
+		fclose(fp);
+		return true;
+	}
+
+	void help()
+	{
+		printf("Usage: dispatch_bench [options] trace-file\n");
+		printf("\n");
+		printf(" --instances=<number> emulators sharing the core.  Default=1\n");
+		printf(" --slice=<number>     opcodes before switching emulators.  Default=65536\n");
+		printf(" --reps=<number>      runs per layout, the best is reported.  Default=5\n");
+		printf("\n");
+		printf("Create a trace with mpw --trace-opcodes=<file> tool ...\n");
+		printf("\n");
+	}
+
+}
+
+int main(int argc, char **argv)
+{
+	enum {
+		kInstances = 1,
+		kSlice,
+		kReps,
+	};
+
+	static struct option LongOpts[] =
+	{
+		{ "instances", required_argument, NULL, kInstances },
+		{ "slice", required_argument, NULL, kSlice },
+		{ "reps", required_argument, NULL, kReps },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	unsigned instances = 1;
+	size_t slice = 65536;
+	unsigned reps = 5;
+
+	int c;
+	while ((c = getopt_long(argc, argv, "h", LongOpts, NULL)) != -1)
+	{
+		switch(c)
+		{
+			case kInstances: instances = strtoul(optarg, NULL, 0); break;
+			case kSlice: slice = strtoul(optarg, NULL, 0); break;
+			case kReps: reps = strtoul(optarg, NULL, 0); break;
+			case 'h':
+				help();
+				exit(EX_OK);
+			default:
+				help();
+				exit(EX_USAGE);
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	if (argc != 1 || !instances || !slice || !reps)
+	{
+		help();
+		exit(EX_USAGE);
+	}
+
+	std::vector<uint16_t> trace;
+	if (!LoadTrace(argv[0], trace))
+	{
+		perror(argv[0]);
+		exit(EX_NOINPUT);
+	}
+	if (trace.empty())
+	{
+		fprintf(stderr, "%s: empty trace\n", argv[0]);
+		exit(EX_DATAERR);
+	}
+
+	// builds the opcode tables.
+	cpuStartup();
+	cpuSetModel(3, 0);
+
+	printf("%zu opcodes, %u instance(s), slice %zu\n", trace.size(), instances, slice);
+	Run<WideTable>("wide", trace, instances, slice, reps);
+	Run<CompactTable>("compact", trace, instances, slice, reps);
+
+	return 0;
+}
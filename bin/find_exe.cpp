@@ -0,0 +1,80 @@
+#include "find_exe.h"
+
+#include <string>
+
+#include <sys/stat.h>
+
+#include <cxx/string_splitter.h>
+#include <toolbox/toolbox.h>
+#include <mpw/mpw.h>
+
+namespace {
+
+	bool file_exists(const std::string & name)
+	{
+		struct stat st;
+
+		return ::stat(name.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+	}
+
+	std::string old_find_exe(const std::string &name)
+	{
+		if (file_exists(name)) return name;
+
+		// if name is a path, then it doesn't exist.
+		if (name.find('/') != name.npos) return std::string();
+
+		std::string path = MPW::RootDir();
+		if (path.empty()) return path;
+
+
+		if (path.back() != '/') path.push_back('/');
+		path.append("Tools/");
+		path.append(name);
+
+		if (file_exists(path)) return path;
+
+		return std::string();
+
+	}
+
+}
+
+std::string find_exe(const std::string &name)
+{
+
+	// if this is an absolute or relative name, return as-is.
+
+	if (name.find(':') != name.npos) {
+		std::string path = ToolBox::MacToUnix(name);
+		if (file_exists(path)) return path;
+		return "";
+	}
+
+	if (name.find('/') != name.npos) {
+		if (file_exists(name)) return name;
+		return "";
+	}
+
+	// otherwise, check the Commands variable for locations.
+	std::string commands = MPW::GetEnv("Commands");
+	if (commands.empty()) return old_find_exe(name);
+
+
+	// string is , separated, possibly in MacOS format.
+
+	for (auto iter = string_splitter(commands, ','); iter; ++iter)
+	{
+		if (iter->empty()) continue;
+		std::string path = *iter;
+
+		// convert to unix.
+		path = ToolBox::MacToUnix(path);
+		// should always have a length...
+		if (path.length() && path.back() != '/') path.push_back('/');
+		path.append(name);
+		if (file_exists(path)) return path;
+	}
+
+	return "";
+}
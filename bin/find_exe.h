@@ -0,0 +1,16 @@
+#ifndef __find_exe_h__
+#define __find_exe_h__
+
+#include <string>
+
+/*
+ * finds a utility the way mpw does: a unix or mac path is used as-is,
+ * otherwise each directory in $Commands is searched (or $MPW/Tools if
+ * it isn't set).  Relative paths are relative to the current directory.
+ *
+ * $Commands comes from the MPW environment, so this needs to run *after*
+ * MPW::InitEnvironment.  Returns "" if the utility isn't found.
+ */
+std::string find_exe(const std::string &name);
+
+#endif
@@ -0,0 +1,438 @@
+#include "fork_server.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+extern char **environ;
+
+namespace ForkServer {
+
+	namespace {
+
+		// a request larger than this is garbage.
+		const uint32_t kMaxRequestSize = 1024 * 1024;
+
+		// SIGCHLD -> poll.
+		int SignalPipe[2] = { -1, -1 };
+
+		void SigChild(int)
+		{
+			int saved = errno;
+			char c = 0;
+			(void)::write(SignalPipe[1], &c, 1);
+			errno = saved;
+		}
+
+		void Reply(int fd, int32_t status)
+		{
+			WriteAll(fd, &status, sizeof(status));
+			::close(fd);
+		}
+
+		int32_t ExitStatus(int status)
+		{
+			if (WIFEXITED(status)) return WEXITSTATUS(status);
+			if (WIFSIGNALED(status)) return 128 + WTERMSIG(status);
+			return EX_SOFTWARE;
+		}
+
+		bool SameUser(int fd)
+		{
+#ifdef SO_PEERCRED
+			struct ucred cred;
+			socklen_t length = sizeof(cred);
+			if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &length) < 0) return false;
+			return cred.uid == ::geteuid();
+#else
+			uid_t uid;
+			gid_t gid;
+			if (::getpeereid(fd, &uid, &gid) < 0) return false;
+			return uid == ::geteuid();
+#endif
+		}
+
+		void CloseAll(int stdio[3])
+		{
+			for (unsigned i = 0; i < 3; ++i)
+				if (stdio[i] >= 0) ::close(stdio[i]);
+		}
+
+		// child side -- become the client's process.
+		void Adopt(const Request &request, int stdio[3])
+		{
+			for (unsigned i = 0; i < 3; ++i)
+			{
+				if (::dup2(stdio[i], i) < 0)
+				{
+					perror("mpw: dup2");
+					exit(EX_OSERR);
+				}
+			}
+			CloseAll(stdio);
+
+			if (::chdir(request.cwd.c_str()) < 0)
+			{
+				fprintf(stderr, "mpw: Unable to change directory to %s: %s\n",
+					request.cwd.c_str(), strerror(errno));
+				exit(EX_OSERR);
+			}
+
+			char **env = new char *[request.env.size() + 1];
+			for (size_t i = 0; i < request.env.size(); ++i)
+				env[i] = ::strdup(request.env[i].c_str());
+			env[request.env.size()] = nullptr;
+			environ = env;
+		}
+	}
+
+
+	bool ReadAll(int fd, void *buffer, size_t size)
+	{
+		uint8_t *cp = (uint8_t *)buffer;
+		while (size)
+		{
+			ssize_t n = ::read(fd, cp, size);
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) return false;
+			cp += n;
+			size -= n;
+		}
+		return true;
+	}
+
+	bool WriteAll(int fd, const void *buffer, size_t size)
+	{
+		const uint8_t *cp = (const uint8_t *)buffer;
+		while (size)
+		{
+			ssize_t n = ::write(fd, cp, size);
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) return false;
+			cp += n;
+			size -= n;
+		}
+		return true;
+	}
+
+	bool PendingMessage::Read(int fd, bool &done)
+	{
+		done = false;
+
+		while (offset < sizeof(header))
+		{
+			struct iovec iov = { (uint8_t *)&header + offset, sizeof(header) - offset };
+			union {
+				struct cmsghdr align;
+				char buffer[CMSG_SPACE(3 * sizeof(int))];
+			} control;
+
+			struct msghdr msg;
+			memset(&msg, 0, sizeof(msg));
+			msg.msg_iov = &iov;
+			msg.msg_iovlen = 1;
+			msg.msg_control = control.buffer;
+			msg.msg_controllen = sizeof(control.buffer);
+
+			ssize_t n = ::recvmsg(fd, &msg, 0);
+			if (n < 0 && errno == EINTR) continue;
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+			if (n <= 0) return false;
+
+			// the descriptors come with the first byte.  Any others are closed.
+			for (struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg))
+			{
+				if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) continue;
+
+				// (the control buffer has room for 3.)
+				int fds[3];
+				size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+				if (count > 3) count = 3;
+				memcpy(fds, CMSG_DATA(cmsg), count * sizeof(int));
+
+				if (count == 3 && stdio[0] < 0) memcpy(stdio, fds, sizeof(fds));
+				else for (size_t i = 0; i < count; ++i) ::close(fds[i]);
+			}
+
+			offset += n;
+		}
+
+		if (header.size > kMaxRequestSize) return false;
+		data.resize(header.size);
+
+		while (offset < sizeof(header) + data.size())
+		{
+			size_t have = offset - sizeof(header);
+			ssize_t n = ::read(fd, &data[have], data.size() - have);
+			if (n < 0 && errno == EINTR) continue;
+			if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+			if (n <= 0) return false;
+			offset += n;
+		}
+
+		done = true;
+		return true;
+	}
+
+	int Listen(const std::string &path)
+	{
+		struct sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		if (path.length() >= sizeof(addr.sun_path))
+		{
+			errno = ENAMETOOLONG;
+			return -1;
+		}
+		strcpy(addr.sun_path, path.c_str());
+
+		int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0) return -1;
+
+		// the socket is created 0600.
+		::unlink(path.c_str());
+		mode_t mask = ::umask(077);
+		int ok = ::bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+		::umask(mask);
+
+		if (ok < 0 || ::listen(fd, SOMAXCONN) < 0)
+		{
+			int saved = errno;
+			::close(fd);
+			errno = saved;
+			return -1;
+		}
+		::fcntl(fd, F_SETFD, FD_CLOEXEC);
+		return fd;
+	}
+
+	int Accept(int listener)
+	{
+		int fd = ::accept(listener, nullptr, nullptr);
+		if (fd < 0) return -1;
+
+		// anyone else could run the tool as this user.
+		if (!SameUser(fd))
+		{
+			::close(fd);
+			return -1;
+		}
+
+		::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+		::fcntl(fd, F_SETFD, FD_CLOEXEC);
+		return fd;
+	}
+
+	bool SendMessage(int fd, const RequestHeader &header, const std::string &data, const int stdio[3])
+	{
+		struct iovec iov = { (void *)&header, sizeof(header) };
+		union {
+			struct cmsghdr align;
+			char buffer[CMSG_SPACE(3 * sizeof(int))];
+		} control;
+
+		struct msghdr msg;
+		memset(&msg, 0, sizeof(msg));
+		msg.msg_iov = &iov;
+		msg.msg_iovlen = 1;
+		msg.msg_control = control.buffer;
+		msg.msg_controllen = sizeof(control.buffer);
+
+		struct cmsghdr *cmsg = CMSG_FIRSTHDR(&msg);
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		cmsg->cmsg_len = CMSG_LEN(3 * sizeof(int));
+		memcpy(CMSG_DATA(cmsg), stdio, 3 * sizeof(int));
+
+		ssize_t n;
+		do { n = ::sendmsg(fd, &msg, 0); } while (n < 0 && errno == EINTR);
+		if (n < 0) return false;
+
+		return WriteAll(fd, (const uint8_t *)&header + n, sizeof(header) - n)
+			&& WriteAll(fd, data.data(), data.size());
+	}
+
+	// cwd, argv, env -- all nul-terminated.
+	bool ParseRequest(const RequestHeader &header, const std::string &data, Request &request)
+	{
+		std::vector<std::string> strings;
+		const char *cp = data.data();
+		const char *end = cp + data.size();
+		while (cp < end)
+		{
+			const char *nul = (const char *)memchr(cp, 0, end - cp);
+			if (!nul) return false;
+			strings.emplace_back(cp, nul);
+			cp = nul + 1;
+		}
+		if (strings.size() != 1 + header.argc + header.envc) return false;
+
+		auto iter = strings.begin();
+		request.cwd = std::move(*iter++);
+		request.argv.assign(iter, iter + header.argc);
+		request.env.assign(iter + header.argc, strings.end());
+		return true;
+	}
+
+
+	Request Serve(const std::string &path)
+	{
+		int listener = Listen(path);
+		if (listener < 0)
+		{
+			fprintf(stderr, "mpw: Unable to listen on %s: %s\n", path.c_str(), strerror(errno));
+			exit(errno == ENAMETOOLONG ? EX_CONFIG : EX_OSERR);
+		}
+
+		if (::pipe(SignalPipe) < 0)
+		{
+			perror("mpw: pipe");
+			exit(EX_OSERR);
+		}
+		for (int fd : SignalPipe)
+		{
+			::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+			::fcntl(fd, F_SETFD, FD_CLOEXEC);
+		}
+
+		struct sigaction sa;
+		memset(&sa, 0, sizeof(sa));
+		sa.sa_handler = SigChild;
+		sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+		sigemptyset(&sa.sa_mask);
+		sigaction(SIGCHLD, &sa, nullptr);
+
+		// a client that goes away shouldn't take the server with it.
+		signal(SIGPIPE, SIG_IGN);
+
+		// nothing buffered may be inherited by the children.
+		fflush(stdout);
+		fflush(stderr);
+
+		// child pid -> client connection.
+		std::map<pid_t, int> children;
+
+		// connections still sending their request.
+		std::map<int, PendingMessage> pending;
+
+		for (;;)
+		{
+			std::vector<struct pollfd> fds;
+			fds.push_back({ listener, POLLIN, 0 });
+			fds.push_back({ SignalPipe[0], POLLIN, 0 });
+			for (const auto &kv : pending)
+				fds.push_back({ kv.first, POLLIN, 0 });
+
+			if (::poll(fds.data(), fds.size(), -1) < 0)
+			{
+				if (errno == EINTR) continue;
+				perror("mpw: poll");
+				exit(EX_OSERR);
+			}
+
+			if (fds[1].revents & POLLIN)
+			{
+				char buffer[64];
+				while (::read(SignalPipe[0], buffer, sizeof(buffer)) > 0) ;
+
+				for (;;)
+				{
+					int status;
+					pid_t pid = ::waitpid(-1, &status, WNOHANG);
+					if (pid <= 0) break;
+
+					auto iter = children.find(pid);
+					if (iter == children.end()) continue;
+					Reply(iter->second, ExitStatus(status));
+					children.erase(iter);
+				}
+			}
+
+			std::vector<int> ready;
+			for (size_t i = 2; i < fds.size(); ++i)
+				if (fds[i].revents) ready.push_back(fds[i].fd);
+
+			// the request has usually arrived by the time it's accepted.
+			if (fds[0].revents & POLLIN)
+			{
+				int conn = Accept(listener);
+				if (conn >= 0)
+				{
+					pending[conn];
+					ready.push_back(conn);
+				}
+			}
+
+			for (int conn : ready)
+			{
+				auto iter = pending.find(conn);
+				PendingMessage &message = iter->second;
+
+				bool done;
+				bool ok = message.Read(conn, done);
+				if (ok && !done) continue;
+
+				Request request;
+				int stdio[3];
+				memcpy(stdio, message.stdio, sizeof(stdio));
+				ok = ok
+					&& stdio[0] >= 0 && stdio[1] >= 0 && stdio[2] >= 0
+					&& message.header.argc > 0
+					&& ParseRequest(message.header, message.data, request);
+				pending.erase(iter);
+
+				if (!ok)
+				{
+					CloseAll(stdio);
+					::close(conn);
+					continue;
+				}
+
+				pid_t pid = ::fork();
+				if (pid < 0)
+				{
+					perror("mpw: fork");
+					CloseAll(stdio);
+					Reply(conn, EX_OSERR);
+					continue;
+				}
+
+				if (pid == 0)
+				{
+					signal(SIGCHLD, SIG_DFL);
+					signal(SIGPIPE, SIG_DFL);
+					::close(listener);
+					::close(SignalPipe[0]);
+					::close(SignalPipe[1]);
+					for (const auto &kv : children) ::close(kv.second);
+					for (auto &kv : pending)
+					{
+						::close(kv.first);
+						CloseAll(kv.second.stdio);
+					}
+					::close(conn);
+
+					Adopt(request, stdio);
+					return request;
+				}
+
+				CloseAll(stdio);
+				children.emplace(pid, conn);
+			}
+		}
+	}
+
+}
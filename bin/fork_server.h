@@ -0,0 +1,73 @@
+#ifndef __fork_server_h__
+#define __fork_server_h__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * --fork-server=<socket>
+ *
+ * The tool is loaded and initialized once, then every request on the
+ * unix socket is run in a fork()ed (copy-on-write) child with the
+ * client's argv, environment, cwd and stdio.  mpw-client is the other
+ * end.
+ *
+ * A request is a RequestHeader, sent with the client's stdin, stdout and
+ * stderr (SCM_RIGHTS), followed by header.size bytes of strings, each
+ * nul-terminated: the cwd, argc arguments and envc environment entries.
+ * The reply is the int32_t exit status.
+ *
+ * A header with argc == 0 asks mpwd for its statistics, which come back
+ * as text.
+ */
+namespace ForkServer {
+
+	struct RequestHeader {
+		uint32_t size;
+		uint32_t argc;
+		uint32_t envc;
+	};
+
+	struct Request {
+		std::string cwd;
+		std::vector<std::string> argv;
+		std::vector<std::string> env;
+	};
+
+	// the wire format, shared with mpw-client and mpwd.
+	bool ReadAll(int fd, void *buffer, size_t size);
+	bool WriteAll(int fd, const void *buffer, size_t size);
+	bool SendMessage(int fd, const RequestHeader &header, const std::string &data, const int stdio[3]);
+
+	bool ParseRequest(const RequestHeader &header, const std::string &data, Request &request);
+
+	// a message read a piece at a time from a non-blocking connection, so
+	// a client that stops half-way doesn't hold up the server.
+	struct PendingMessage {
+		RequestHeader header;
+		std::string data;
+		int stdio[3] = { -1, -1, -1 }; // -1 if the message didn't carry descriptors.
+		size_t offset = 0; // header and data bytes read so far
+
+		// reads whatever has arrived; done is set once the message is
+		// complete.  Returns false if the connection or message is bad.
+		bool Read(int fd, bool &done);
+	};
+
+	// a unix socket on path that only this user can connect to.  Returns
+	// -1 (and errno) on failure.
+	int Listen(const std::string &path);
+
+	// accepts a connection on listener, non-blocking and close-on-exec.
+	// Returns -1 if there was none or it came from another user.
+	int Accept(int listener);
+
+	// Listens on path and forks a child per request.  Returns only in the
+	// child, after it has taken on the request's stdio, cwd and environment.
+	// The parent reports the child's exit status to the client.
+	Request Serve(const std::string &path);
+
+}
+
+#endif
@@ -27,6 +27,7 @@
 
 #include <cstdint>
 #include <cctype>
+#include <climits>
 #include <cstring>
 #include <string>
 #include <vector>
@@ -45,9 +46,13 @@
 #include <cpu/fmem.h>
 
 #include <toolbox/toolbox.h>
+#include <toolbox/dispatch.h>
+#include <toolbox/stdclib.h>
 #include <toolbox/mm.h>
+#include <toolbox/mm_allocator.h>
 #include <toolbox/os.h>
 #include <toolbox/loader.h>
+#include <toolbox/context.h>
 
 #include <mpw/mpw.h>
 
@@ -58,8 +63,11 @@
 
 #include "loader.h"
 #include "debugger.h"
+#include "fork_server.h"
+#include "snapshot.h"
+#include "ram.h"
+#include "find_exe.h"
 
-#include <cxx/string_splitter.h>
 
 
 #define LOADER_LOAD
@@ -67,9 +75,12 @@
 Settings Flags;
 
 const uint32_t kGlobalSize = 0x10000;
-// retained to make debugging easier.
-uint8_t *Memory = nullptr;
-uint32_t MemorySize = 0;
+
+// the one emulator this process runs.
+ToolBox::EmulatorContext MainContext;
+
+// --trace-opcodes
+FILE *OpcodeTrace = nullptr;
 
 
 uint8_t ReadByte(const void *data, uint32_t offset)
@@ -463,7 +474,16 @@ void InstructionLogger()
 	for (unsigned j = 0; j < 4; ++j) strings[j][0] = 0;
 
 	uint32_t pc = cpuGetPC();
-	uint16_t opcode = ReadWord(Memory, pc);
+	uint16_t opcode = ReadWord(MainContext.Memory, pc);
+
+	if (OpcodeTrace)
+	{
+		// big endian, one word per instruction.
+		uint8_t buffer[2] = { (uint8_t)(opcode >> 8), (uint8_t)opcode };
+		fwrite(buffer, 1, 2, OpcodeTrace);
+
+		if (!Flags.traceCPU && !Flags.traceMacsbug) return;
+	}
 
 	if ((opcode & 0xf000) == 0xa000)
 	{
@@ -539,13 +559,13 @@ void MemoryLogger(uint32_t address, int size, int readWrite, uint32_t value)
 			switch(size)
 			{
 			case 1:
-				value = ReadByte(Memory, address);
+				value = ReadByte(MainContext.Memory, address);
 				break;
 			case 2:
-				value = ReadWord(Memory, address);
+				value = ReadWord(MainContext.Memory, address);
 				break;
 			case 4:
-				value = ReadLong(Memory, address);
+				value = ReadLong(MainContext.Memory, address);
 				break;
 			}
 		}
@@ -594,8 +614,20 @@ void help()
 	printf(" --trace-macsbug     print macsbug names\n");
 	printf(" --trace-toolbox     print toolbox calls\n");
 	printf(" --trace-mpw         print mpw calls\n");
+	printf(" --trace-opcodes=<file> record every executed opcode\n");
 	printf(" --memory-stats      print memory usage information\n");
+	printf(" --cpu-stats         print instruction count and speed\n");
+	printf(" --trap-stats        print toolbox call counts and times\n");
+	printf(" --jit               translate hot code to native code (x86-64)\n");
+	printf(" --native-lib[=verify] run StdCLib string routines natively\n");
+	printf(" --fork-server=<socket> load the utility once and run it for mpw-client\n");
+	printf(" --snapshot=<file>   save the loaded utility and exit\n");
+	printf(" --restore=<file>    run a saved utility.  Arguments are the utility's\n");
 	printf(" --ram=<number>      set the ram size.  Default=16M\n");
+	printf(" --huge-pages        use transparent huge pages for the ram (Linux)\n");
+	printf(" --24                24-bit addressing, for code that isn't 32-bit clean\n");
+	printf(" --allocator=<name>  heap allocator: buddy or tlsf.  Default=buddy\n");
+	printf(" --alloc-trace=<file> log heap calls for alloc_bench\n");
 	printf(" --stack=<number>    set the stack size.  Default=8K\n");
 	printf("\n");
 }
@@ -645,91 +677,38 @@ bool parse_number(const char *input, uint32_t *dest)
 	return true;
 }
 
-bool file_exists(const std::string & name)
-{
-	struct stat st;
-
-	return ::stat(name.c_str(), &st) == 0 && S_ISREG(st.st_mode);
-}
-
-std::string old_find_exe(const std::string &name)
-{
-	if (file_exists(name)) return name;
-
-	// if name is a path, then it doesn't exist.
-	if (name.find('/') != name.npos) return std::string();
-
-	std::string path = MPW::RootDir();
-	if (path.empty()) return path;
-
-
-	if (path.back() != '/') path.push_back('/');
-	path.append("Tools/");
-	path.append(name);
-
-	if (file_exists(path)) return path;
-
-	return std::string();
-
-}
-
-
-// this needs to run *after* the MPW environment variables are loaded.
-std::string find_exe(const std::string &name)
-{
-
-	// if this is an absolute or relative name, return as-is.
-
-	if (name.find(':') != name.npos) {
-		std::string path = ToolBox::MacToUnix(name);
-		if (file_exists(path)) return path;
-		return "";
-	}
-
-	if (name.find('/') != name.npos) {
-		if (file_exists(name)) return name;
-		return "";
-	}
-
-	// otherwise, check the Commands variable for locations.
-	std::string commands = MPW::GetEnv("Commands");
-	if (commands.empty()) return old_find_exe(name);
-
-
-	// string is , separated, possibly in MacOS format.
-
-	for (auto iter = string_splitter(commands, ','); iter; ++iter)
-	{
-		if (iter->empty()) continue;
-		std::string path = *iter;
-
-		// convert to unix.
-		path = ToolBox::MacToUnix(path);
-		// should always have a length...
-		if (path.length() && path.back() != '/') path.push_back('/');
-		path.append(name);
-		if (file_exists(path)) return path;
-	}
-
-	return "";
-}
-
-
 void MainLoop()
 {
-	#if 0
 	auto begin_emu_time = std::chrono::high_resolution_clock::now();
-	fprintf(stderr, "Begin Emulation Time: %20lld\n", (begin_emu_time - start_time).count());
-	#endif
-
 
-	uint64_t cycles = 0;
 	for (;;)
 	{
-		uint32_t pc = cpuGetPC();
+		uint32_t reason;
+
+		#ifndef CPU_INSTRUCTION_LOGGING
+		if (Flags.traceCPU || Flags.traceMacsbug || OpcodeTrace)
+		{
+			reason = 0;
+			if (cpuGetPC() == 0) reason = CPU_EXECUTE_PC_ZERO;
+			else if (cpuGetStop()) reason = CPU_EXECUTE_STOP;
+			else
+			{
+				InstructionLogger();
+				cpuExecuteInstruction();
+			}
+		}
+		else
+		#endif
+		{
+			// the pc and stack are checked after every trap and
+			// at least every kCheckInterval instructions.
+			const uint32_t kCheckInterval = 4096;
+			reason = cpuExecuteUntil(kCheckInterval, CPU_EXECUTE_TRAP | CPU_EXECUTE_PC_ZERO);
+		}
+
 		uint32_t sp = cpuGetAReg(7);
 
-		if (pc == 0x00000000)
+		if (reason & CPU_EXECUTE_PC_ZERO)
 		{
 			fprintf(stderr, "Exiting - PC = 0\n");
 			exit(EX_SOFTWARE);
@@ -748,31 +727,27 @@ void MainLoop()
 			exit(EX_SOFTWARE);
 		}
 
-
-		if (cpuGetStop()) break; // will this also be set by an interrupt?
-
-
-		#ifndef CPU_INSTRUCTION_LOGGING
-		if (Flags.traceCPU || Flags.traceMacsbug)
-		{
-			InstructionLogger();
-		}
-		#endif
-
-		cycles += cpuExecuteInstruction();
+		if (reason & CPU_EXECUTE_STOP) break; // will this also be set by an interrupt?
 	}
 
-	#if 0
-	auto end_emu_time = std::chrono::high_resolution_clock::now();
-	fprintf(stderr, "  End Emulation Time: %20lld\n", (end_emu_time - start_time).count());
-	fprintf(stderr, "              Cycles: %20lld\n", cycles);
-	#endif
-
+	if (Flags.cpuStats)
+	{
+		auto end_emu_time = std::chrono::high_resolution_clock::now();
+		double seconds = std::chrono::duration<double>(end_emu_time - begin_emu_time).count();
+		uint64_t count = cpuGetInstructionCount();
+
+		fprintf(stderr, "        Instructions: %20llu\n", (unsigned long long)count);
+		fprintf(stderr, "      Emulation Time: %20.3f s\n", seconds);
+		if (seconds > 0)
+			fprintf(stderr, "                MIPS: %20.2f\n", count / seconds / 1e6);
+	}
 
 }
 
 int main(int argc, char **argv)
 {
+	ToolBox::SetContext(&MainContext);
+
 	// getopt...
 
 	enum
@@ -785,6 +760,18 @@ int main(int argc, char **argv)
 		kDebugger,
 		kMemoryStats,
 		kShell,
+		kJIT,
+		kTraceOpcodes,
+		kCPUStats,
+		kTrapStats,
+		kNativeLib,
+		kForkServer,
+		kSnapshot,
+		kRestore,
+		kHugePages,
+		kAddress24,
+		kAllocator,
+		kAllocTrace,
 	};
 	static struct option LongOpts[] =
 	{
@@ -797,11 +784,24 @@ int main(int argc, char **argv)
 		{ "trace-toolbox", no_argument, NULL, kTraceToolBox },
 		{ "trace-tools", no_argument, NULL, kTraceToolBox },
 		{ "trace-mpw", no_argument, NULL, kTraceMPW },
+		{ "trace-opcodes", required_argument, NULL, kTraceOpcodes },
 
 		{ "debug", no_argument, NULL, kDebugger },
 		{ "debugger", no_argument, NULL, kDebugger },
 
 		{ "memory-stats", no_argument, NULL, kMemoryStats },
+		{ "cpu-stats", no_argument, NULL, kCPUStats },
+		{ "trap-stats", no_argument, NULL, kTrapStats },
+
+		{ "jit", no_argument, NULL, kJIT },
+		{ "native-lib", optional_argument, NULL, kNativeLib },
+		{ "fork-server", required_argument, NULL, kForkServer },
+		{ "snapshot", required_argument, NULL, kSnapshot },
+		{ "restore", required_argument, NULL, kRestore },
+		{ "huge-pages", no_argument, NULL, kHugePages },
+		{ "24", no_argument, NULL, kAddress24 },
+		{ "allocator", required_argument, NULL, kAllocator },
+		{ "alloc-trace", required_argument, NULL, kAllocTrace },
 
 		{ "help", no_argument, NULL, 'h' },
 		{ "version", no_argument, NULL, 'V' },
@@ -838,10 +838,22 @@ int main(int argc, char **argv)
 				Flags.traceMPW = true;
 				break;
 
+			case kTraceOpcodes:
+				Flags.traceOpcodes = optarg;
+				break;
+
 			case kMemoryStats:
 				Flags.memoryStats = true;
 				break;
 
+			case kCPUStats:
+				Flags.cpuStats = true;
+				break;
+
+			case kTrapStats:
+				Flags.trapStats = true;
+				break;
+
 			case kDebugger:
 				Flags.debugger = true;
 				break;
@@ -849,6 +861,53 @@ int main(int argc, char **argv)
 			case kShell:
 				break;
 
+			case kJIT:
+				Flags.jit = true;
+				break;
+
+			case kNativeLib:
+				if (!optarg) Flags.nativeLib = StdCLib::kEnabled;
+				else if (!strcmp(optarg, "verify")) Flags.nativeLib = StdCLib::kVerify;
+				else
+				{
+					fprintf(stderr, "--native-lib=%s - invalid input\n", optarg);
+					exit(EX_CONFIG);
+				}
+				break;
+
+			case kForkServer:
+				Flags.forkServer = optarg;
+				break;
+
+			case kSnapshot:
+				Flags.snapshot = optarg;
+				break;
+
+			case kRestore:
+				Flags.restore = optarg;
+				break;
+
+			case kHugePages:
+				Flags.hugePages = true;
+				break;
+
+			case kAddress24:
+				Flags.address24 = true;
+				break;
+
+			case kAllocator:
+				if (!MM::CreateAllocator(optarg))
+				{
+					fprintf(stderr, "--allocator=%s - invalid input\n", optarg);
+					exit(EX_CONFIG);
+				}
+				Flags.allocator = optarg;
+				break;
+
+			case kAllocTrace:
+				Flags.allocTrace = optarg;
+				break;
+
 			case 'm':
 				if (!parse_number(optarg, &Flags.machine))
 					exit(EX_CONFIG);
@@ -890,7 +949,8 @@ int main(int argc, char **argv)
 	argc -= optind;
 	argv += optind;
 
-	if (!argc)
+	// --restore has the utility; everything else is an argument.
+	if (!argc && Flags.restore.empty())
 	{
 		help();
 		exit(EX_USAGE);
@@ -917,62 +977,151 @@ int main(int argc, char **argv)
 		exit(EX_CONFIG);
 	}
 
+	// (a restored snapshot has its own ram size, checked after it loads.)
+	if (Flags.address24 && Flags.restore.empty() && Flags.memorySize > 0x01000000)
+	{
+		fprintf(stderr, "--24 needs 16M of ram or less\n");
+		exit(EX_CONFIG);
+	}
+
+	if (!Flags.forkServer.empty() && Flags.debugger)
+	{
+		fprintf(stderr, "--fork-server and --debugger are incompatible\n");
+		exit(EX_USAGE);
+	}
+
 
 
 	MPW::InitEnvironment(defines);
 
-	std::string command(argv[0]); // InitMPW updates argv...
-	command = find_exe(command);
-	if (command.empty())
+	std::string command;
+	if (Flags.restore.empty())
 	{
-		std::string mpw = MPW::RootDir();
-		fprintf(stderr, "Unable to find command %s\n", argv[0]);
-		fprintf(stderr, "$MPW = %s\n", mpw.c_str());
-		fprintf(stderr, "$Commands = %s\n", MPW::GetEnv("Commands").c_str());
-		exit(EX_USAGE);
-	}
-	argv[0] = ::strdup(command.c_str()); // hmm.. could setenv(mpw_command) instead.
+		command = argv[0]; // InitMPW updates argv...
+		command = find_exe(command);
+		if (command.empty())
+		{
+			std::string mpw = MPW::RootDir();
+			fprintf(stderr, "Unable to find command %s\n", argv[0]);
+			fprintf(stderr, "$MPW = %s\n", mpw.c_str());
+			fprintf(stderr, "$Commands = %s\n", MPW::GetEnv("Commands").c_str());
+			exit(EX_USAGE);
+		}
+		argv[0] = ::strdup(command.c_str()); // hmm.. could setenv(mpw_command) instead.
+
 
+		MainContext.Memory = Flags.memory = Ram::Allocate(Flags.memorySize);
+		MainContext.MemorySize = Flags.memorySize;
+		if (!MainContext.Memory)
+		{
+			fprintf(stderr, "Unable to allocate ram (%08x bytes): %s\n", Flags.memorySize, strerror(errno));
+			exit(EX_OSERR);
+		}
+
+		// the stack doesn't get huge pages.
+		if (Flags.hugePages) Ram::HugePages(MainContext.Memory, Flags.memorySize - Flags.stackSize);
+		MainContext.ReleaseSize = Ram::ReleaseSize(Flags.hugePages);
 
-	// move to CreateRam()
-	Memory = Flags.memory = new uint8_t[Flags.memorySize];
-	MemorySize = Flags.memorySize;
 
+		/// ahhh... need to set PC after memory.
+		// for pre-fetch.
+		memorySetMemory(MainContext.Memory, MainContext.MemorySize);
 
-	/// ahhh... need to set PC after memory.
-	// for pre-fetch.
-	memorySetMemory(Memory, MemorySize);
 
+		FILE *allocTrace = nullptr;
+		if (!Flags.allocTrace.empty())
+		{
+			allocTrace = fopen(Flags.allocTrace.c_str(), "w");
+			if (!allocTrace)
+			{
+				fprintf(stderr, "Unable to create %s\n", Flags.allocTrace.c_str());
+				exit(EX_CANTCREAT);
+			}
+		}
+
+		if (!MM::Init(MainContext.Memory, MainContext.MemorySize, kGlobalSize, Flags.stackSize, Flags.allocator, allocTrace))
+		{
+			fprintf(stderr, "Unable to initialize the heap\n");
+			exit(EX_SOFTWARE);
+		}
+		OS::Init();
+		ToolBox::Init();
+	}
 
-	MM::Init(Memory, MemorySize, kGlobalSize, Flags.stackSize);
-	OS::Init();
-	ToolBox::Init();
-	MPW::Init(argc, argv);
+	// the fork server's children and restored snapshots get their argv
+	// and environment later.  Snapshots are taken before MPW::Init.
+	bool mpwInit = Flags.forkServer.empty() && Flags.snapshot.empty() && Flags.restore.empty();
+	if (mpwInit) MPW::Init(argc, argv);
 
 
 	cpuStartup();
 	cpuSetModel(3,0);
 
-	CreateStack();
+	if (!Flags.traceOpcodes.empty())
+	{
+		OpcodeTrace = fopen(Flags.traceOpcodes.c_str(), "wb");
+		if (!OpcodeTrace)
+		{
+			fprintf(stderr, "Unable to create %s\n", Flags.traceOpcodes.c_str());
+			exit(EX_CANTCREAT);
+		}
+	}
 
-#ifdef LOADER_LOAD
-	uint16_t err = Loader::Native::LoadFile(command);
-	if (err) {
-		const char *cp = ErrorName(err);
-		fprintf(stderr, "Unable to load command %s: ", command.c_str());
-		if (cp) printf("%s\n", cp);
-		else printf("%hd\n", err);
-		exit(EX_SOFTWARE);
+	if (Flags.jit && !cpuSetJit(true))
+	{
+		fprintf(stderr, "--jit is not supported on this platform\n");
+		Flags.jit = false;
 	}
-#else
-	uint32_t address = load(command.c_str());
-	if (!address) {
-		fprintf(stderr, "Unable to load command %s\n", command.c_str());
-		exit(EX_SOFTWARE);
+
+	StdCLib::Mode = Flags.nativeLib;
+
+#ifndef LOADER_LOAD
+	uint32_t address = 0;
+#endif
+	if (!Flags.restore.empty())
+	{
+		// memory, stack, the loaded segments and the registers.
+		command = Snapshot::Restore(Flags.restore);
 	}
+	else
+	{
+		CreateStack();
+
+#ifdef LOADER_LOAD
+		uint16_t err = Loader::Native::LoadFile(command);
+		if (err) {
+			const char *cp = ErrorName(err);
+			fprintf(stderr, "Unable to load command %s: ", command.c_str());
+			if (cp) printf("%s\n", cp);
+			else printf("%hd\n", err);
+			exit(EX_SOFTWARE);
+		}
+#else
+		address = load(command.c_str());
+		if (!address) {
+			fprintf(stderr, "Unable to load command %s\n", command.c_str());
+			exit(EX_SOFTWARE);
+		}
 #endif
+	}
 	GlobalInit();
 
+	if (Flags.address24)
+	{
+		if (!Flags.restore.empty() && Flags.memorySize > 0x01000000)
+		{
+			fprintf(stderr, "--24 needs 16M of ram or less\n");
+			exit(EX_CONFIG);
+		}
+		memorySetAddress32Bit(false);
+	}
+
+	if (!Flags.snapshot.empty())
+	{
+		Snapshot::Save(Flags.snapshot, command);
+		exit(EX_OK);
+	}
+
 
 	cpuSetALineExceptionFunc(ToolBox::dispatch);
 	cpuSetFLineExceptionFunc(MPW::dispatch);
@@ -985,9 +1134,10 @@ int main(int argc, char **argv)
 
 	MPW::Trace = Flags.traceMPW;
 	ToolBox::Trace = Flags.traceToolBox;
+	ToolBox::TrapStats = Flags.trapStats;
 
 
-	if (Flags.traceCPU || Flags.traceMacsbug)
+	if (Flags.traceCPU || Flags.traceMacsbug || OpcodeTrace)
 	{
 		#ifdef CPU_INSTRUCTION_LOGGING
 		cpuSetInstructionLoggingFunc(InstructionLogger);
@@ -999,6 +1149,51 @@ int main(int argc, char **argv)
 	cpuInitializeFromNewPC(address);
 #endif
 
+	if (!Flags.forkServer.empty())
+	{
+		// (the children run in the client's directory.)
+		char buffer[PATH_MAX];
+		std::string loaded = ::realpath(command.c_str(), buffer) ? buffer : command;
+
+		// returns in a child, which runs the request.
+		ForkServer::Request request = ForkServer::Serve(Flags.forkServer);
+
+		MainContext.Environment.clear();
+		MPW::InitEnvironment(defines);
+
+		// the client's directory and $Commands may find a different
+		// utility than the one that's loaded.
+		std::string tool = find_exe(request.argv[0]);
+		if (tool.empty())
+		{
+			fprintf(stderr, "Unable to find command %s\n", request.argv[0].c_str());
+			exit(EX_USAGE);
+		}
+		if (!::realpath(tool.c_str(), buffer) || loaded != buffer)
+		{
+			fprintf(stderr, "mpw: %s is not the loaded command %s\n", tool.c_str(), loaded.c_str());
+			exit(EX_USAGE);
+		}
+
+		std::vector<char *> args;
+		args.push_back(::strdup(tool.c_str()));
+		for (size_t i = 1; i < request.argv.size(); ++i)
+			args.push_back(::strdup(request.argv[i].c_str()));
+		args.push_back(nullptr);
+
+		MPW::Init(args.size() - 1, args.data());
+	}
+	else if (!Flags.restore.empty())
+	{
+		std::vector<char *> args;
+		args.push_back(::strdup(command.c_str()));
+		for (int i = 0; i < argc; ++i)
+			args.push_back(argv[i]);
+		args.push_back(nullptr);
+
+		MPW::Init(args.size() - 1, args.data());
+	}
+
 	if (Flags.debugger) Debug::Shell();
 	else MainLoop();
 
@@ -1009,6 +1204,11 @@ int main(int argc, char **argv)
 		MM::Native::PrintMemoryStats();
 	}
 
+	if (Flags.trapStats)
+	{
+		ToolBox::PrintTrapStats();
+	}
+
 	uint32_t rv = MPW::ExitStatus();
 	if (rv > 0xff) rv = 0xff;
 
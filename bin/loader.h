@@ -2,6 +2,7 @@
 #define __mpw_loader__
 
 #include <cstdint>
+#include <string>
 
 struct Settings {
 	Settings() {}
@@ -18,17 +19,30 @@ struct Settings {
 	bool traceToolBox = false;
 	bool traceMPW = false;
 
+	std::string traceOpcodes; // file to record executed opcodes.
+
 	bool debugger = false;
 
 	bool memoryStats = false;
+	bool cpuStats = false;
+	bool trapStats = false;
+
+	bool jit = false;
+	bool hugePages = false;
+	bool address24 = false; // --24
+	std::string allocator = "buddy"; // --allocator
+	std::string allocTrace; // file to log heap calls to.
+	unsigned nativeLib = 0; // StdCLib::kDisabled, kEnabled, kVerify
+
+	std::string forkServer; // socket path.
+	std::string snapshot; // file to save the loaded utility to.
+	std::string restore; // file to restore the loaded utility from.
 
 
 	// updated later.
 	std::pair<uint32_t, uint32_t> stackRange = {0, 0};
 	uint8_t *memory = nullptr;
 
-	uint64_t cycles = 0;
-
 	const uint32_t kGlobalSize = 0x10000;
 };
 
@@ -0,0 +1,164 @@
+// mpw-client -- runs a tool in an mpw --fork-server or mpwd.
+//
+// mpw-client [--socket=path] tool [arguments...]
+// mpw-client [--socket=path] --stats
+//
+// The socket defaults to $MPW_FORK_SERVER.  stdin, stdout, stderr, the
+// cwd and the environment are handed to the server; the exit status is
+// the tool's.
+
+#include "fork_server.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <getopt.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+extern char **environ;
+
+namespace {
+
+	void help()
+	{
+		printf("Usage: mpw-client [options] utility ...\n");
+		printf("\n");
+		printf(" --help              display usage information\n");
+		printf(" --socket=<path>     fork server socket.  Default=$MPW_FORK_SERVER\n");
+		printf(" --stats             print mpwd statistics\n");
+		printf("\n");
+	}
+
+	void append(std::string &data, const char *s)
+	{
+		data.append(s);
+		data.push_back(0);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	enum
+	{
+		kStats = 1,
+	};
+	static struct option LongOpts[] =
+	{
+		{ "socket", required_argument, NULL, 'S' },
+		{ "stats", no_argument, NULL, kStats },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	std::string path;
+	bool stats = false;
+	if (const char *cp = getenv("MPW_FORK_SERVER")) path = cp;
+
+	int c;
+	while ((c = getopt_long(argc, argv, "+hS:", LongOpts, NULL)) != -1)
+	{
+		switch(c)
+		{
+			case 'S':
+				path = optarg;
+				break;
+
+			case kStats:
+				stats = true;
+				break;
+
+			case 'h':
+				help();
+				exit(EX_OK);
+
+			default:
+				help();
+				exit(EX_USAGE);
+		}
+	}
+
+	argc -= optind;
+	argv += optind;
+
+	if ((!argc && !stats) || path.empty())
+	{
+		help();
+		exit(EX_USAGE);
+	}
+
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.length() >= sizeof(addr.sun_path))
+	{
+		fprintf(stderr, "mpw-client: socket path too long: %s\n", path.c_str());
+		exit(EX_USAGE);
+	}
+	strcpy(addr.sun_path, path.c_str());
+
+	int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || ::connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+	{
+		fprintf(stderr, "mpw-client: Unable to connect to %s: %s\n", path.c_str(), strerror(errno));
+		exit(EX_UNAVAILABLE);
+	}
+
+
+	// cwd, argv, env.
+	std::string data;
+	ForkServer::RequestHeader header = { 0, 0, 0 };
+
+	char *cwd = ::getcwd(nullptr, 0);
+	if (!cwd)
+	{
+		perror("mpw-client: getcwd");
+		exit(EX_OSERR);
+	}
+	append(data, cwd);
+	free(cwd);
+
+	if (!stats)
+	{
+		for (int i = 0; i < argc; ++i, ++header.argc)
+			append(data, argv[i]);
+
+		for (char **ep = environ; *ep; ++ep, ++header.envc)
+			append(data, *ep);
+	}
+
+	header.size = data.size();
+
+
+	int stdio[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+	if (!ForkServer::SendMessage(fd, header, data, stdio))
+	{
+		fprintf(stderr, "mpw-client: Unable to send the request: %s\n", strerror(errno));
+		exit(EX_UNAVAILABLE);
+	}
+
+
+	if (stats)
+	{
+		char buffer[4096];
+		ssize_t n;
+		while ((n = ::read(fd, buffer, sizeof(buffer))) > 0)
+			fwrite(buffer, 1, n, stdout);
+		exit(EX_OK);
+	}
+
+	int32_t status;
+	if (!ForkServer::ReadAll(fd, &status, sizeof(status)))
+	{
+		fprintf(stderr, "mpw-client: The server closed the connection\n");
+		exit(EX_UNAVAILABLE);
+	}
+
+	exit(status);
+}
@@ -0,0 +1,640 @@
+// mpwd -- runs mpw-client requests on a pool of pre-loaded tools.
+//
+// mpwd [--socket=path] [--jobs=n] [--mpw=path] [-- mpw options...]
+//
+// The tool is found the way mpw finds it -- in the client's directory,
+// with $Commands from the client's environment.  Each tool gets its own
+// mpw --fork-server (started on first use), which forks a child per
+// request.  Requests are queued and at most --jobs run at once.  The
+// tool writes straight to the client's stdout and stderr; the client gets
+// the exit status.  mpw-client --stats prints the queue and per-tool
+// latencies.
+
+#include "fork_server.h"
+#include "find_exe.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <poll.h>
+#include <signal.h>
+#include <sysexits.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+#include <toolbox/context.h>
+#include <mpw/mpw.h>
+
+extern char **environ;
+
+namespace {
+
+	typedef std::chrono::steady_clock Clock;
+
+	struct Job {
+		int client = -1;
+		int stdio[3] = { -1, -1, -1 };
+		ForkServer::RequestHeader header;
+		std::string data;
+		std::string tool; // resolved path
+		Clock::time_point queued;
+		Clock::time_point started;
+	};
+
+	// an mpw --fork-server for one tool.
+	struct Server {
+		pid_t pid = -1;
+		std::string socket;
+		bool listening = false;
+		Clock::time_point started;
+		std::vector<Job> waiting; // until it listens
+	};
+
+	struct ToolStats {
+		uint64_t count = 0;
+		uint64_t failed = 0;
+		double wait = 0; // seconds in the queue
+		double run = 0;
+		double maxRun = 0;
+	};
+
+	std::string MPWBinary = "mpw"; // --mpw
+	std::vector<std::string> MPWOptions;
+	std::vector<std::string> Defines; // -D from MPWOptions
+	std::string Directory; // fork server sockets
+	unsigned Jobs = 1;
+
+	std::map<int, ForkServer::PendingMessage> Pending; // clients still sending
+	std::deque<Job> Queue;
+	std::map<int, Job> Running; // fork server connection -> job
+	std::map<std::string, Server> Servers; // resolved path -> server
+	unsigned ServerCount = 0;
+
+	std::map<std::string, ToolStats> Stats;
+	uint64_t Requests = 0;
+	size_t MaxQueue = 0;
+
+	// for find_exe's MPW environment.
+	ToolBox::EmulatorContext ResolveContext;
+
+	int SignalPipe[2] = { -1, -1 };
+	volatile sig_atomic_t Quit = 0;
+
+	void SigChild(int)
+	{
+		int saved = errno;
+		char c = 0;
+		(void)::write(SignalPipe[1], &c, 1);
+		errno = saved;
+	}
+
+	void SigQuit(int)
+	{
+		Quit = 1;
+		SigChild(0);
+	}
+
+	void help()
+	{
+		printf("Usage: mpwd [options] [-- mpw options]\n");
+		printf("\n");
+		printf(" --help              display usage information\n");
+		printf(" --socket=<path>     listen on path.  Default=$MPW_FORK_SERVER\n");
+		printf(" --jobs=<number>     run at most number tools at once.  Default=cpu count\n");
+		printf(" --mpw=<path>        the mpw binary.  Default=mpw\n");
+		printf("\n");
+	}
+
+	void CloseAll(int stdio[3])
+	{
+		for (unsigned i = 0; i < 3; ++i)
+		{
+			if (stdio[i] >= 0) ::close(stdio[i]);
+			stdio[i] = -1;
+		}
+	}
+
+	double Seconds(Clock::duration d)
+	{
+		return std::chrono::duration<double>(d).count();
+	}
+
+	int Connect(const std::string &path)
+	{
+		struct sockaddr_un addr;
+		memset(&addr, 0, sizeof(addr));
+		addr.sun_family = AF_UNIX;
+		strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+
+		int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0) return -1;
+		if (::connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+		{
+			::close(fd);
+			return -1;
+		}
+		return fd;
+	}
+
+	// starts mpw --fork-server for tool.  CheckServers connects once it
+	// listens.
+	bool StartServer(const std::string &tool, Server &server)
+	{
+		server.socket = Directory + "/" + std::to_string(++ServerCount) + ".sock";
+
+		std::vector<std::string> args;
+		args.push_back(MPWBinary);
+		args.push_back("--fork-server=" + server.socket);
+		args.insert(args.end(), MPWOptions.begin(), MPWOptions.end());
+		args.push_back(tool);
+
+		fflush(stdout);
+		fflush(stderr);
+
+		pid_t pid = ::fork();
+		if (pid < 0) return false;
+		if (pid == 0)
+		{
+			std::vector<char *> argv;
+			for (auto &s : args) argv.push_back(&s[0]);
+			argv.push_back(nullptr);
+
+			// queued clients' stdio must not live on in the server.
+			for (int fd = 3, max = getdtablesize(); fd < max; ++fd) ::close(fd);
+
+			signal(SIGCHLD, SIG_DFL);
+			signal(SIGPIPE, SIG_DFL);
+			execvp(argv[0], argv.data());
+			fprintf(stderr, "mpwd: Unable to run %s: %s\n", argv[0], strerror(errno));
+			_exit(EX_UNAVAILABLE);
+		}
+		server.pid = pid;
+		server.listening = false;
+		server.started = Clock::now();
+		return true;
+	}
+
+	void StopServer(Server &server)
+	{
+		if (server.pid > 0) ::kill(server.pid, SIGTERM);
+		::unlink(server.socket.c_str());
+		server.pid = -1;
+		server.listening = false;
+	}
+
+	// resolves the tool the way the fork server's child will: in the
+	// client's directory, with the MPW environment built from the
+	// client's.  Returns "" if it isn't found.
+	std::string Resolve(const ForkServer::Request &request)
+	{
+		int here = ::open(".", O_RDONLY);
+		if (here < 0) return "";
+
+		std::string path;
+		if (::chdir(request.cwd.c_str()) == 0)
+		{
+			std::vector<char *> env;
+			for (const auto &e : request.env) env.push_back(const_cast<char *>(e.c_str()));
+			env.push_back(nullptr);
+
+			char **saved = environ;
+			environ = env.data();
+
+			ResolveContext.Environment.clear();
+			MPW::InitEnvironment(Defines);
+			path = find_exe(request.argv[0]);
+
+			environ = saved;
+
+			char buffer[PATH_MAX];
+			if (!path.empty()) path = ::realpath(path.c_str(), buffer) ? buffer : "";
+		}
+
+		(void)::fchdir(here);
+		::close(here);
+		return path;
+	}
+
+	void Finish(Job &job, int32_t status)
+	{
+		auto now = Clock::now();
+
+		ForkServer::WriteAll(job.client, &status, sizeof(status));
+		::close(job.client);
+		CloseAll(job.stdio);
+
+		ToolStats &st = Stats[job.tool];
+		double run = Seconds(now - job.started);
+		st.count++;
+		if (status) st.failed++;
+		st.wait += Seconds(job.started - job.queued);
+		st.run += run;
+		st.maxRun = std::max(st.maxRun, run);
+	}
+
+	void Fail(Job &job)
+	{
+		dprintf(job.stdio[2], "mpwd: Unable to start %s\n", job.tool.c_str());
+		Finish(job, EX_UNAVAILABLE);
+	}
+
+	// sends the job down a connection to its fork server.
+	void Send(Job &job, int fd)
+	{
+		if (!ForkServer::SendMessage(fd, job.header, job.data, job.stdio))
+		{
+			::close(fd);
+			Fail(job);
+			return;
+		}
+
+		// the fork server's child has its own copies now.
+		CloseAll(job.stdio);
+		Running.emplace(fd, std::move(job));
+	}
+
+	// hands the job to its tool's fork server, or has it wait for the
+	// server to start.
+	void Start(Job &job)
+	{
+		job.started = Clock::now();
+
+		Server &server = Servers[job.tool];
+		if (server.pid > 0 && server.listening)
+		{
+			int fd = Connect(server.socket);
+			if (fd >= 0)
+			{
+				Send(job, fd);
+				return;
+			}
+			StopServer(server);
+		}
+
+		if (server.pid <= 0 && !StartServer(job.tool, server))
+		{
+			Fail(job);
+			return;
+		}
+		server.waiting.push_back(std::move(job));
+	}
+
+	// connects the waiting jobs to servers that have started listening.
+	// Returns true if any are still starting.
+	bool CheckServers()
+	{
+		bool starting = false;
+		auto now = Clock::now();
+
+		for (auto &kv : Servers)
+		{
+			Server &server = kv.second;
+			if (server.waiting.empty()) continue;
+
+			int fd = server.pid > 0 ? Connect(server.socket) : -1;
+			if (fd >= 0)
+			{
+				server.listening = true;
+
+				std::vector<Job> waiting;
+				waiting.swap(server.waiting);
+				for (auto &job : waiting)
+				{
+					if (fd < 0) fd = Connect(server.socket);
+					if (fd >= 0) Send(job, fd);
+					else Fail(job);
+					fd = -1;
+				}
+				continue;
+			}
+
+			// loading takes milliseconds; give up if it exits or takes 10s.
+			if (server.pid > 0 && now - server.started < std::chrono::seconds(10))
+			{
+				starting = true;
+				continue;
+			}
+
+			StopServer(server);
+			for (auto &job : server.waiting) Fail(job);
+			server.waiting.clear();
+		}
+		return starting;
+	}
+
+	// jobs that hold a --jobs slot.
+	size_t Active()
+	{
+		size_t n = Running.size();
+		for (const auto &kv : Servers) n += kv.second.waiting.size();
+		return n;
+	}
+
+	void Schedule()
+	{
+		while (!Queue.empty() && Active() < Jobs)
+		{
+			Job job = std::move(Queue.front());
+			Queue.pop_front();
+			Start(job);
+		}
+	}
+
+	void PrintStats(int fd)
+	{
+		std::string s;
+		char buffer[256];
+
+		snprintf(buffer, sizeof(buffer),
+			"Requests: %llu  Queue: %zu (max %zu)  Running: %zu / %u  Tools: %zu\n\n",
+			(unsigned long long)Requests, Queue.size(), MaxQueue,
+			Active(), Jobs, Servers.size());
+		s.append(buffer);
+
+		snprintf(buffer, sizeof(buffer), "%-20s %8s %8s %10s %10s %10s\n",
+			"Tool", "Count", "Failed", "Wait (ms)", "Run (ms)", "Max (ms)");
+		s.append(buffer);
+
+		for (const auto &kv : Stats)
+		{
+			const ToolStats &st = kv.second;
+			snprintf(buffer, sizeof(buffer), "%-20s %8llu %8llu %10.2f %10.2f %10.2f\n",
+				kv.first.c_str(),
+				(unsigned long long)st.count, (unsigned long long)st.failed,
+				st.wait * 1000 / st.count, st.run * 1000 / st.count, st.maxRun * 1000);
+			s.append(buffer);
+		}
+
+		ForkServer::WriteAll(fd, s.data(), s.size());
+	}
+
+	// reads what the client has sent; the request is queued once it's all
+	// here.
+	void Receive(int conn)
+	{
+		auto iter = Pending.find(conn);
+		ForkServer::PendingMessage &message = iter->second;
+
+		bool done;
+		bool ok = message.Read(conn, done);
+		if (ok && !done) return;
+
+		Job job;
+		job.client = conn;
+		job.queued = Clock::now();
+		job.header = message.header;
+		job.data = std::move(message.data);
+		std::copy(message.stdio, message.stdio + 3, job.stdio);
+		Pending.erase(iter);
+
+		if (ok && job.header.argc == 0)
+		{
+			PrintStats(conn);
+			ok = false;
+		}
+
+		ForkServer::Request request;
+		ok = ok && job.stdio[0] >= 0 && job.stdio[1] >= 0 && job.stdio[2] >= 0
+			&& ForkServer::ParseRequest(job.header, job.data, request);
+		if (!ok)
+		{
+			CloseAll(job.stdio);
+			::close(conn);
+			return;
+		}
+
+		job.tool = Resolve(request);
+		if (job.tool.empty())
+		{
+			dprintf(job.stdio[2], "mpwd: Unable to find command %s\n", request.argv[0].c_str());
+			CloseAll(job.stdio);
+			int32_t status = EX_USAGE;
+			ForkServer::WriteAll(conn, &status, sizeof(status));
+			::close(conn);
+			return;
+		}
+
+		++Requests;
+		Queue.emplace_back(std::move(job));
+		MaxQueue = std::max(MaxQueue, Queue.size());
+	}
+
+	void Accept(int listener)
+	{
+		int conn = ForkServer::Accept(listener);
+		if (conn < 0) return;
+
+		// the request has usually arrived by now.
+		Pending[conn];
+		Receive(conn);
+	}
+
+	void Reap()
+	{
+		char buffer[64];
+		while (::read(SignalPipe[0], buffer, sizeof(buffer)) > 0) ;
+
+		for (;;)
+		{
+			int status;
+			pid_t pid = ::waitpid(-1, &status, WNOHANG);
+			if (pid <= 0) break;
+
+			// a fork server exited -- start a new one next time.
+			for (auto &kv : Servers)
+			{
+				if (kv.second.pid != pid) continue;
+				kv.second.pid = -1;
+				kv.second.listening = false;
+			}
+		}
+	}
+
+	void Shutdown(const std::string &path)
+	{
+		for (auto &kv : Servers)
+		{
+			if (kv.second.pid > 0) ::kill(kv.second.pid, SIGTERM);
+			::unlink(kv.second.socket.c_str());
+		}
+		::rmdir(Directory.c_str());
+		::unlink(path.c_str());
+	}
+}
+
+int main(int argc, char **argv)
+{
+	enum
+	{
+		kJobs = 1,
+		kMPW,
+	};
+	static struct option LongOpts[] =
+	{
+		{ "socket", required_argument, NULL, 'S' },
+		{ "jobs", required_argument, NULL, kJobs },
+		{ "mpw", required_argument, NULL, kMPW },
+		{ "help", no_argument, NULL, 'h' },
+		{ NULL, 0, NULL, 0 }
+	};
+
+	std::string path;
+	if (const char *cp = getenv("MPW_FORK_SERVER")) path = cp;
+
+	long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+	if (ncpu > 0) Jobs = ncpu;
+
+	int c;
+	while ((c = getopt_long(argc, argv, "+hS:j:", LongOpts, NULL)) != -1)
+	{
+		switch(c)
+		{
+			case 'S':
+				path = optarg;
+				break;
+
+			case 'j':
+			case kJobs:
+				Jobs = atoi(optarg);
+				if (!Jobs)
+				{
+					fprintf(stderr, "--jobs=%s - invalid input\n", optarg);
+					exit(EX_CONFIG);
+				}
+				break;
+
+			case kMPW:
+				MPWBinary = optarg;
+				break;
+
+			case 'h':
+				help();
+				exit(EX_OK);
+
+			default:
+				help();
+				exit(EX_USAGE);
+		}
+	}
+
+	for (int i = optind; i < argc; ++i)
+	{
+		MPWOptions.push_back(argv[i]);
+
+		// mpw -D name=value, for Resolve.
+		std::string s(argv[i]);
+		if (s == "-D" && i + 1 < argc) Defines.push_back(argv[i + 1]);
+		else if (s.compare(0, 2, "-D") == 0 && s.length() > 2) Defines.push_back(s.substr(2));
+	}
+
+	if (path.empty())
+	{
+		help();
+		exit(EX_USAGE);
+	}
+
+
+	char tmp[] = "/tmp/mpwd.XXXXXX";
+	if (!mkdtemp(tmp))
+	{
+		perror("mpwd: mkdtemp");
+		exit(EX_OSERR);
+	}
+	Directory = tmp;
+
+
+	// only this user can connect (ForkServer::Accept checks as well).
+	int listener = ForkServer::Listen(path);
+	if (listener < 0)
+	{
+		fprintf(stderr, "mpwd: Unable to listen on %s: %s\n", path.c_str(), strerror(errno));
+		exit(errno == ENAMETOOLONG ? EX_CONFIG : EX_OSERR);
+	}
+
+	if (::pipe(SignalPipe) < 0)
+	{
+		perror("mpwd: pipe");
+		exit(EX_OSERR);
+	}
+	for (int fd : SignalPipe)
+	{
+		::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+		::fcntl(fd, F_SETFD, FD_CLOEXEC);
+	}
+
+	struct sigaction sa;
+	memset(&sa, 0, sizeof(sa));
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = SA_RESTART | SA_NOCLDSTOP;
+	sa.sa_handler = SigChild;
+	sigaction(SIGCHLD, &sa, nullptr);
+	sa.sa_handler = SigQuit;
+	sigaction(SIGINT, &sa, nullptr);
+	sigaction(SIGTERM, &sa, nullptr);
+	signal(SIGPIPE, SIG_IGN);
+
+
+	ToolBox::SetContext(&ResolveContext);
+
+	bool starting = false;
+	while (!Quit)
+	{
+		std::vector<struct pollfd> fds;
+		fds.push_back({ listener, POLLIN, 0 });
+		fds.push_back({ SignalPipe[0], POLLIN, 0 });
+		for (const auto &kv : Running)
+			fds.push_back({ kv.first, POLLIN, 0 });
+		for (const auto &kv : Pending)
+			fds.push_back({ kv.first, POLLIN, 0 });
+
+		// a starting fork server is polled for every 10ms.
+		if (::poll(fds.data(), fds.size(), starting ? 10 : -1) < 0)
+		{
+			if (errno == EINTR) continue;
+			perror("mpwd: poll");
+			break;
+		}
+
+		if (fds[1].revents & POLLIN) Reap();
+
+		for (size_t i = 2; i < fds.size(); ++i)
+		{
+			if (!fds[i].revents) continue;
+
+			if (Pending.count(fds[i].fd))
+			{
+				Receive(fds[i].fd);
+				continue;
+			}
+
+			auto iter = Running.find(fds[i].fd);
+			int32_t status;
+			if (!ForkServer::ReadAll(iter->first, &status, sizeof(status)))
+				status = EX_SOFTWARE;
+			::close(iter->first);
+			Finish(iter->second, status);
+			Running.erase(iter);
+		}
+
+		if (fds[0].revents & POLLIN) Accept(listener);
+
+		Schedule();
+		starting = CheckServers();
+	}
+
+	Shutdown(path);
+	exit(EX_OK);
+}
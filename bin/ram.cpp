@@ -0,0 +1,95 @@
+#include "ram.h"
+
+#include <cerrno>
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+namespace Ram {
+
+	namespace {
+
+		uintptr_t PageSize()
+		{
+			static const uintptr_t page = sysconf(_SC_PAGESIZE);
+			return page;
+		}
+
+		uintptr_t RoundUp(uintptr_t value)
+		{
+			uintptr_t page = PageSize();
+			return (value + page - 1) & ~(page - 1);
+		}
+	}
+
+
+	uint8_t *Allocate(uint32_t size)
+	{
+		int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+		flags |= MAP_NORESERVE;
+#endif
+
+		void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+		if (memory == MAP_FAILED) return nullptr;
+		return (uint8_t *)memory;
+	}
+
+
+	uint8_t *Map(int fd, off_t offset, uint32_t size)
+	{
+		struct stat st;
+		if (fstat(fd, &st) < 0) return nullptr;
+
+		if (offset & (PageSize() - 1))
+		{
+			errno = EINVAL;
+			return nullptr;
+		}
+
+		// touching a page wholly past the end of the file is SIGBUS, so
+		// the file only covers what it has.
+		uint64_t available = st.st_size > offset ? st.st_size - offset : 0;
+		uint32_t fileSize = available < size ? RoundUp(available) : size;
+		if (fileSize > size) fileSize = size;
+
+		uint8_t *memory = Allocate(size);
+		if (!memory || !fileSize) return memory;
+
+		void *p = mmap(memory, fileSize, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_FIXED, fd, offset);
+		if (p == MAP_FAILED)
+		{
+			int saved = errno;
+			munmap(memory, size);
+			errno = saved;
+			return nullptr;
+		}
+
+		return memory;
+	}
+
+
+	void HugePages(uint8_t *address, uint32_t size)
+	{
+#ifdef MADV_HUGEPAGE
+		madvise(address, size, MADV_HUGEPAGE);
+#else
+		(void)address;
+		(void)size;
+#endif
+	}
+
+
+	uint32_t ReleaseSize(bool hugePages)
+	{
+		// releasing part of a huge page splits it.
+		return hugePages ? 2 * 1024 * 1024 : 64 * 1024;
+	}
+
+}
@@ -0,0 +1,34 @@
+#ifndef __ram_h__
+#define __ram_h__
+
+#include <cstdint>
+#include <sys/types.h>
+
+/*
+ * emulated ram.
+ *
+ * The ram is mmap()ed rather than new[]ed.  Anonymous pages aren't
+ * committed until they are touched, so a large --ram costs what the
+ * utility uses.  A file mapping (snapshots) is MAP_PRIVATE -- every
+ * process sharing the file shares the clean pages.
+ */
+namespace Ram {
+
+	// anonymous, zero-filled.  nullptr (and errno) on failure.
+	uint8_t *Allocate(uint32_t size);
+
+	// size bytes of fd from offset, copy on write.  Anything past the end
+	// of the file is anonymous and zero-filled.  offset must be page
+	// aligned.  nullptr (and errno) on failure.
+	uint8_t *Map(int fd, off_t offset, uint32_t size);
+
+	// --huge-pages -- ask for transparent huge pages.  Linux only; a no-op
+	// elsewhere.
+	void HugePages(uint8_t *address, uint32_t size);
+
+	// the smallest free block worth giving back to the host.
+	uint32_t ReleaseSize(bool hugePages);
+
+}
+
+#endif
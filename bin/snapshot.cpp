@@ -0,0 +1,164 @@
+#include "snapshot.h"
+#include "loader.h"
+#include "ram.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sysexits.h>
+#include <unistd.h>
+
+#include <cpu/defs.h>
+#include <cpu/CpuModule.h>
+#include <cpu/fmem.h>
+
+#include <toolbox/context.h>
+#include <toolbox/loader.h>
+#include <toolbox/mm.h>
+#include <toolbox/os.h>
+#include <toolbox/state.h>
+#include <toolbox/stdclib.h>
+#include <toolbox/toolbox.h>
+
+namespace Snapshot {
+
+	namespace {
+
+		const char kMagic[8] = { 'M', 'P', 'W', 'S', 'N', 'A', 'P', 0 };
+		const uint32_t kVersion = 5;
+
+		struct Header {
+			char magic[8];
+			uint32_t version;
+			uint32_t memorySize;
+			uint32_t stackSize;
+			uint32_t reserved;
+			uint64_t memoryOffset; // page aligned.
+		};
+
+		void Fail(const std::string &path, const char *what)
+		{
+			fprintf(stderr, "%s %s: %s\n", what, path.c_str(), errno ? strerror(errno) : "Invalid snapshot");
+		}
+	}
+
+
+	void Save(const std::string &path, const std::string &command)
+	{
+		auto &ctx = ToolBox::Context();
+
+		FILE *f = fopen(path.c_str(), "wb");
+		if (!f)
+		{
+			Fail(path, "Unable to create");
+			exit(EX_CANTCREAT);
+		}
+
+		Header header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, kMagic, sizeof(kMagic));
+		header.version = kVersion;
+		header.memorySize = Flags.memorySize;
+		header.stackSize = Flags.stackSize;
+
+		// the header is rewritten once the memory offset is known.
+		State::Write(f, header);
+
+		State::Write(f, command);
+		cpuSaveState(f);
+		MM::Native::SaveState(f);
+		ToolBox::SaveState(f);
+		Loader::Native::SaveState(f);
+		StdCLib::SaveState(f);
+
+		long page = sysconf(_SC_PAGESIZE);
+		long offset = ftell(f);
+		header.memoryOffset = (offset + page - 1) / page * page;
+
+		errno = 0;
+		bool ok = fseek(f, header.memoryOffset, SEEK_SET) == 0
+			&& fwrite(ctx.Memory, 1, ctx.MemorySize, f) == ctx.MemorySize
+			&& fseek(f, 0, SEEK_SET) == 0
+			&& fwrite(&header, sizeof(header), 1, f) == 1;
+
+		if (fclose(f) != 0) ok = false;
+		if (!ok)
+		{
+			Fail(path, "Unable to write");
+			unlink(path.c_str());
+			exit(EX_IOERR);
+		}
+	}
+
+
+	std::string Restore(const std::string &path)
+	{
+		auto &ctx = ToolBox::Context();
+
+		errno = 0;
+		FILE *f = fopen(path.c_str(), "rb");
+		if (!f)
+		{
+			Fail(path, "Unable to open");
+			exit(EX_NOINPUT);
+		}
+
+		Header header;
+		if (fread(&header, sizeof(header), 1, f) != 1
+			|| memcmp(header.magic, kMagic, sizeof(kMagic))
+			|| header.version != kVersion
+			|| header.stackSize >= header.memorySize)
+		{
+			Fail(path, "Unable to restore");
+			exit(EX_DATAERR);
+		}
+
+		// copy on write -- a restore only pays for the pages it touches.
+		uint8_t *memory = Ram::Map(fileno(f), header.memoryOffset, header.memorySize);
+		if (!memory)
+		{
+			Fail(path, "Unable to map");
+			exit(EX_OSERR);
+		}
+
+		Flags.memorySize = header.memorySize;
+		Flags.stackSize = header.stackSize;
+		Flags.stackRange.first = Flags.memorySize - Flags.stackSize;
+		Flags.stackRange.second = Flags.memorySize;
+
+		ctx.Memory = Flags.memory = memory;
+		ctx.MemorySize = Flags.memorySize;
+		if (Flags.hugePages) Ram::HugePages(memory, Flags.memorySize - Flags.stackSize);
+		ctx.ReleaseSize = Ram::ReleaseSize(Flags.hugePages);
+		memorySetMemory(ctx.Memory, ctx.MemorySize);
+
+		std::string command;
+		State::Read(f, command);
+		cpuLoadState(f);
+		MM::Native::LoadState(f);
+		OS::Init();
+		ToolBox::LoadState(f);
+		uint16_t err = Loader::Native::LoadState(f);
+		StdCLib::LoadState(f);
+
+		errno = 0;
+		if (ferror(f) || feof(f))
+		{
+			Fail(path, "Unable to restore");
+			exit(EX_DATAERR);
+		}
+		fclose(f);
+
+		if (err)
+		{
+			fprintf(stderr, "Unable to load command %s: %hd\n", command.c_str(), err);
+			exit(EX_SOFTWARE);
+		}
+
+		return command;
+	}
+
+}
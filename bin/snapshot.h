@@ -0,0 +1,29 @@
+#ifndef __snapshot_h__
+#define __snapshot_h__
+
+#include <string>
+
+/*
+ * --snapshot=<file> / --restore=<file>
+ *
+ * A snapshot is the utility after it has been loaded and relocated but
+ * before MPW::Init, so the arguments, environment and open files are
+ * set up fresh on every restore.  The file has a header, the emulator
+ * state (cpu, memory manager, trap table, loader, StdCLib) and then the
+ * ram, page aligned so a restore can map it copy-on-write instead of
+ * reading it.
+ *
+ * Snapshots are only good for the mpw binary that wrote them.
+ */
+namespace Snapshot {
+
+	// command is the utility's path.  Exits on error.
+	void Save(const std::string &path, const std::string &command);
+
+	// maps the ram, updates Flags and the emulator context and returns the
+	// utility's path.  The cpu must be started.  Exits on error.
+	std::string Restore(const std::string &path);
+
+}
+
+#endif
@@ -14,6 +14,30 @@ extern void cpuSetFLineExceptionFunc(cpuLineExceptionFunc func);
 typedef void (*memoryLoggingFunc)(uint32_t address, int size, int readWrite, uint32_t value);
 extern void memorySetLoggingFunc(memoryLoggingFunc func);
 
+// Decoded block cache
+extern uint32_t cpuExecuteBlock(uint32_t limit);
+extern void cpuBlockCacheFlush(void);
+extern void cpuBlockCacheInvalidate(uint32_t address, uint32_t size);
+
+// JIT -- returns FALSE if not supported on this host.
+extern BOOLE cpuSetJit(BOOLE enable);
+
+// DBF copy and fill loops run as one bulk operation.  On by default.
+extern void cpuSetDbfIdiom(BOOLE enable);
+
+// Bulk execution -- reasons for cpuExecuteUntil to return.
+#define CPU_EXECUTE_BUDGET 0x01    // budget used up
+#define CPU_EXECUTE_STOP 0x02      // cpu stopped (always returns)
+#define CPU_EXECUTE_TRAP 0x04      // A-line or F-line trap dispatched
+#define CPU_EXECUTE_EXCEPTION 0x08 // any other exception
+#define CPU_EXECUTE_PC_ZERO 0x10   // pc is 0
+extern uint32_t cpuExecuteUntil(uint32_t budget, uint32_t stop_mask);
+extern uint32_t cpuGetExecutedInstructions(void);
+
+// Statistics -- instructions executed since startup.  Bulk execution
+// updates it once per call, so it costs nothing per instruction.
+extern uint64_t cpuGetInstructionCount(void);
+
 
 #ifdef _DEBUG
 #define CPU_INSTRUCTION_LOGGING
@@ -0,0 +1,278 @@
+#include <stdlib.h>
+
+#include "defs.h"
+#include "fmem.h"
+#include "CpuModule.h"
+#include "CpuModule_Internal.h"
+
+// MPW -- decoded block cache.
+//
+// A block is a straight-line run of instructions, recorded the first time
+// it executes and ended by the first instruction that changes the pc
+// (branch, exception, a trap that doesn't return in place, ...).  Each
+// entry holds the opcode handler, its operand data and the prefetch word
+// (restored only with CPU_ACCURATE_PREFETCH), so a replay skips the
+// opcode fetch and the table lookup.
+//
+// Every line of memory a block was decoded from is marked in the memory
+// layer; a guest write to a marked line flushes the cache.  Host-side
+// writes (toolbox) should call cpuBlockCacheInvalidate.
+
+#define CPU_BLOCK_CACHE_SIZE 4096
+
+// replays before a block is handed to the JIT.
+#define CPU_BLOCK_JIT_THRESHOLD 32
+
+#ifdef CPU_THREAD_LOCAL_STATE
+// too big for thread-local storage -- each thread allocates its own.
+static CPU_THREAD_LOCAL cpuBlock *cpu_block_cache;
+#else
+static cpuBlock cpu_block_cache[CPU_BLOCK_CACHE_SIZE];
+#endif
+
+// blocks from an older generation are invalid.  0 is never current.
+CPU_THREAD_LOCAL uint32_t cpu_block_cache_generation = 1;
+
+void cpuBlockCacheFlush(void)
+{
+  if (++cpu_block_cache_generation == 0)
+  {
+    // wrapped around -- really clear everything.
+#ifdef CPU_THREAD_LOCAL_STATE
+    // not allocated until this thread's first lookup.
+    if (cpu_block_cache)
+#endif
+    memset(cpu_block_cache, 0, CPU_BLOCK_CACHE_SIZE * sizeof(cpuBlock));
+    cpu_block_cache_generation = 1;
+  }
+  memoryClearCode();
+  cpuJitFlush();
+}
+
+void cpuBlockCacheInvalidate(uint32_t address, uint32_t size)
+{
+  if (memoryIsCode(address, size)) cpuBlockCacheFlush();
+}
+
+static cpuBlock *cpuBlockLookup(uint32_t pc)
+{
+#ifdef CPU_THREAD_LOCAL_STATE
+  if (!cpu_block_cache)
+  {
+    cpu_block_cache = (cpuBlock *)calloc(CPU_BLOCK_CACHE_SIZE, sizeof(cpuBlock));
+    if (!cpu_block_cache)
+    {
+      fprintf(stderr, "cpu: unable to allocate the block cache.\n");
+      exit(1);
+    }
+  }
+#endif
+  return &cpu_block_cache[(pc >> 1) & (CPU_BLOCK_CACHE_SIZE - 1)];
+}
+
+/// <summary>
+/// Executes instructions one at a time (like cpuExecuteInstruction) and
+/// records them in the block.
+/// </summary>
+static uint32_t cpuBlockRecord(cpuBlock *block, uint32_t pc, uint32_t limit)
+{
+  uint32_t generation = cpu_block_cache_generation;
+  uint32_t i;
+
+  block->pc = pc;
+  block->generation = 0;
+  block->count = 0;
+  block->hits = 0;
+  block->jit = NULL;
+
+  for (i = 0; i < CPU_BLOCK_MAX_INSTRUCTIONS && i < limit; )
+  {
+    cpuBlockInstruction *entry = &block->instructions[i++];
+    uint32_t redirects = cpuGetRedirectCount();
+    uint16_t opcode;
+
+    pc = cpuGetPC();
+
+#ifdef CPU_INSTRUCTION_LOGGING
+    cpuCallInstructionLoggingFunc();
+#endif
+
+    cpuSetInstructionAborted(false);
+    cpuSetOriginalPC(pc);
+    opcode = cpuGetNextWord();
+
+#ifdef CPU_INSTRUCTION_LOGGING
+    cpuSetCurrentOpcode(opcode);
+#endif
+
+    entry->pc = pc;
+    entry->opcode = opcode;
+    entry->prefetch = cpuGetPrefetchWord();
+    entry->instruction_func = cpuOpcodeFunction(cpu_opcode_table[opcode]);
+    entry->data = cpuOpcodeOperands(cpu_opcode_table[opcode]);
+
+    // opcode + prefetch word.
+    memoryMarkCode(pc, 4);
+
+    cpuSetInstructionTime(0);
+    entry->instruction_func(entry->data);
+
+    if (cpuGetRedirectCount() != redirects) break;
+    if (cpuGetStop()) break;
+    if (cpu_sr & 0xc000) break;
+  }
+
+  // a block cut short by the limit is not kept.
+  if (i == limit && i < CPU_BLOCK_MAX_INSTRUCTIONS) return i;
+
+  // a write during recording may have flushed the cache.
+  if (generation == cpu_block_cache_generation)
+  {
+    block->count = i;
+    block->generation = generation;
+  }
+  return i;
+}
+
+/// <summary>
+/// Replays a recorded block.  Stops early when the pc leaves the block.
+/// </summary>
+static uint32_t cpuBlockReplay(cpuBlock *block, uint32_t limit)
+{
+  cpuBlockInstruction *entry = block->instructions;
+  uint32_t count = block->count;
+  uint32_t i;
+
+  if (count > limit) count = limit;
+
+  for (i = 0; i < count; ++i, ++entry)
+  {
+    if (i && cpuGetPC() != entry->pc) break;
+
+#ifdef CPU_INSTRUCTION_LOGGING
+    cpuCallInstructionLoggingFunc();
+    cpuSetCurrentOpcode(entry->opcode);
+#endif
+
+    cpuSetInstructionAborted(false);
+    cpuSetOriginalPC(entry->pc);
+    cpuSetPC(entry->pc + 2);
+#ifdef CPU_ACCURATE_PREFETCH
+    cpuSetPrefetchWord(entry->prefetch);
+#endif
+    cpuSetInstructionTime(0);
+    entry->instruction_func(entry->data);
+
+    // the handler may have flushed the cache (self-modifying code)
+    // or turned on tracing.
+    if (block->generation != cpu_block_cache_generation) return i + 1;
+    if (cpu_sr & 0xc000) return i + 1;
+  }
+  return i;
+}
+
+/// <summary>
+/// Executes up to limit instructions from the block at the current pc.
+/// Returns the number of instructions executed.
+/// </summary>
+uint32_t cpuExecuteBlock(uint32_t limit)
+{
+  uint32_t pc;
+  cpuBlock *block;
+
+  if (!limit) return 0;
+
+  // interrupts and tracing need the per-instruction path.
+  if (cpuGetRaiseInterrupt() || (cpu_sr & 0xc000))
+  {
+    cpuExecuteInstruction();
+    return 1;
+  }
+
+  pc = cpuGetPC();
+  block = cpuBlockLookup(pc);
+  if (block->pc == pc && block->generation == cpu_block_cache_generation)
+  {
+#ifndef CPU_INSTRUCTION_LOGGING
+    if (block->jit && block->count <= limit)
+      return block->jit();
+
+    if (!block->jit && ++block->hits == CPU_BLOCK_JIT_THRESHOLD && cpuJitEnabled())
+    {
+      block->jit = cpuJitTranslate(block);
+      if (!block->jit)
+      {
+        // out of code space -- start over.
+        cpuBlockCacheFlush();
+        return cpuBlockRecord(block, pc, limit);
+      }
+    }
+#endif
+    return cpuBlockReplay(block, limit);
+  }
+
+  return cpuBlockRecord(block, pc, limit);
+}
+
+/* Bulk execution */
+
+CPU_THREAD_LOCAL uint32_t cpu_execute_events;
+static CPU_THREAD_LOCAL uint32_t cpu_executed_instructions;
+static CPU_THREAD_LOCAL uint64_t cpu_instruction_count;
+
+void cpuSetExecuteEvent(uint32_t event)
+{
+  cpu_execute_events |= event;
+}
+
+uint32_t cpuGetExecutedInstructions(void)
+{
+  return cpu_executed_instructions;
+}
+
+uint64_t cpuGetInstructionCount(void)
+{
+  return cpu_instruction_count;
+}
+
+void cpuCountInstructions(uint32_t count)
+{
+  cpu_instruction_count += count;
+}
+
+/// <summary>
+/// Executes blocks until the budget is used up or one of the events in
+/// stop_mask happens.  A stopped cpu always returns.  The checks run
+/// between blocks, not between instructions.
+/// Returns the CPU_EXECUTE_ reasons.
+/// </summary>
+uint32_t cpuExecuteUntil(uint32_t budget, uint32_t stop_mask)
+{
+  uint64_t count = cpu_instruction_count;
+  uint32_t executed = 0;
+  uint32_t reason;
+
+  stop_mask |= CPU_EXECUTE_STOP | CPU_EXECUTE_BUDGET;
+  cpu_execute_events = 0;
+
+  for (;;)
+  {
+    reason = cpu_execute_events;
+    if (cpuGetStop()) reason |= CPU_EXECUTE_STOP;
+    if (cpuGetPC() == 0) reason |= CPU_EXECUTE_PC_ZERO;
+    if (executed >= budget) reason |= CPU_EXECUTE_BUDGET;
+
+    if (reason & stop_mask) break;
+
+#ifdef CPU_THREADED_DISPATCH
+    executed += cpuExecuteThreaded(budget - executed);
+#else
+    executed += cpuExecuteBlock(budget - executed);
+#endif
+  }
+
+  cpu_executed_instructions = executed;
+  // the engines fall back to cpuExecuteInstruction, which counts itself.
+  cpu_instruction_count = count + executed;
+  return reason & stop_mask;
+}
@@ -8431,7 +8431,7 @@ static void PFLUSH030_F039(uint32_t*opc_data)
 static void MOVEQ_7000(uint32_t*opc_data)
 {
 	cpuSetDReg(opc_data[0], opc_data[1]);
-	cpuSetFlagsAbs((uint16_t)opc_data[2]);
+	cpuSetFlagsNZ00NewL(opc_data[1]);
 	cpuSetInstructionTime(4);
 }
 static void MOVE_1000(uint32_t*opc_data)
@@ -11025,7 +11025,7 @@ static void DBCC_50C8(uint32_t*opc_data)
 }
 static void DBCC_51C8(uint32_t*opc_data)
 {
-	cpuDbcc(cpuCalculateConditionCode1(), opc_data[1]);
+	cpuDbf(opc_data[1]);
 }
 static void DBCC_52C8(uint32_t*opc_data)
 {
@@ -1,12 +1,5 @@
 #pragma once
 
-typedef void (*cpuInstructionFunction)(uint32_t*);
-typedef struct cpu_data_struct
-{
-	cpuInstructionFunction instruction_func;
-	uint32_t data[3];
-} cpuOpcodeData;
-
 cpuOpcodeData cpu_opcode_data[65536] = {
 {ORI_0000,{0U,0U,0U}},
 {ORI_0000,{1U,0U,0U}},
@@ -138,6 +138,8 @@ void cpuThrowException(uint32_t vector_offset, uint32_t pc, BOOLE executejmp)
   cpuCallExceptionLoggingFunc(cpuGetExceptionName(vector_offset), cpuGetOriginalPC(), cpuGetCurrentOpcode());
 #endif
 
+  cpuSetExecuteEvent(CPU_EXECUTE_EXCEPTION); // MPW
+
   cpuActivateSSP();
 
   stack_is_even = !(cpuGetAReg(7) & 1);
@@ -232,15 +234,41 @@ void cpuThrowIllegalInstructionExceptionFromBreakpoint(void)
   cpuThrowException(0x10, cpuGetPC(), FALSE);
 }
 
+/// <summary>
+/// MPW -- trap entry fast path.  Calls the native handler with the trap
+/// word and carries on at the next instruction, which is already in pc.
+/// No exception frame is built and the vector is not read.  A handler
+/// that moves the pc does so with cpuInitializeFromNewPC, so a trap that
+/// returns in place doesn't end a cached block.
+/// </summary>
+static void cpuLineTrap(cpuLineExceptionFunc func, uint16_t opcode)
+{
+  func(opcode);
+  cpuSetExecuteEvent(CPU_EXECUTE_TRAP);
+#ifdef CPU_ACCURATE_PREFETCH
+  cpuInitializeFromNewPC(cpuGetPC());
+#endif
+  cpuSetInstructionTime(512);
+}
+
+void cpuALineTrap(uint16_t opcode)
+{
+  if (cpu_a_line_exception_func) cpuLineTrap(cpu_a_line_exception_func, opcode);
+  else cpuThrowALineException();
+}
+
+void cpuFLineTrap(uint16_t opcode)
+{
+  if (cpu_f_line_exception_func) cpuLineTrap(cpu_f_line_exception_func, opcode);
+  else cpuThrowFLineException();
+}
+
 void cpuThrowALineException(void)
 {
   // MPW
   if (cpu_a_line_exception_func)
   {
-    uint16_t opcode = memoryReadWord(cpuGetPC() - 2);
-    cpu_a_line_exception_func(opcode);
-    cpuInitializeFromNewPC(cpuGetPC());
-    cpuSetInstructionTime(512);
+    cpuLineTrap(cpu_a_line_exception_func, memoryReadWord(cpuGetPC() - 2));
     return;
   }
 
@@ -254,10 +282,7 @@ void cpuThrowFLineException(void)
   // MPW
   if (cpu_f_line_exception_func)
   {
-    uint16_t opcode = memoryReadWord(cpuGetPC() - 2);
-    cpu_f_line_exception_func(opcode);
-    cpuInitializeFromNewPC(cpuGetPC());
-    cpuSetInstructionTime(512);
+    cpuLineTrap(cpu_f_line_exception_func, memoryReadWord(cpuGetPC() - 2));
     return;
   }
 
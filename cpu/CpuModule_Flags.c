@@ -24,10 +24,93 @@
 #include "CpuModule.h"
 #include "CpuModule_Internal.h"
 
+// MPW -- lazy condition codes.
+//
+// With CPU_LAZY_FLAGS, add, sub, cmp and the move/logic (NZ00) operations
+// only record the operation, operand size, operands and result.  XNZVC
+// are folded into cpu_sr by cpuMaterializeFlags() when something reads
+// them (condition codes, cpuGetSR for MOVE from SR/CCR, exception and
+// trap frames) or before an eager flag update that keeps some of the
+// old bits.  The upper byte of cpu_sr is always up to date.
+
+#define CPU_FLAGS_NONE 0
+#define CPU_FLAGS_NZ 1
+#define CPU_FLAGS_CMP 2
+#define CPU_FLAGS_ADD 3
+#define CPU_FLAGS_SUB 4
+
+static void cpuSetFlagsFromResult(uint32_t op, uint32_t msb, uint32_t res, uint32_t dst, uint32_t src);
+
+#ifdef CPU_LAZY_FLAGS
+
+static CPU_THREAD_LOCAL uint32_t cpu_flags_op = CPU_FLAGS_NONE;
+static CPU_THREAD_LOCAL uint32_t cpu_flags_msb;
+static CPU_THREAD_LOCAL uint32_t cpu_flags_res;
+static CPU_THREAD_LOCAL uint32_t cpu_flags_dst;
+static CPU_THREAD_LOCAL uint32_t cpu_flags_src;
+
+/// <summary>
+/// Folds the pending operation into cpu_sr.
+/// </summary>
+void cpuMaterializeFlags(void)
+{
+  if (cpu_flags_op != CPU_FLAGS_NONE)
+  {
+    uint32_t op = cpu_flags_op;
+    cpu_flags_op = CPU_FLAGS_NONE;
+    cpuSetFlagsFromResult(op, cpu_flags_msb, cpu_flags_res, cpu_flags_dst, cpu_flags_src);
+  }
+}
+
+/// <summary>
+/// Drops the pending operation, cpu_sr is being replaced.
+/// </summary>
+void cpuDiscardFlags(void)
+{
+  cpu_flags_op = CPU_FLAGS_NONE;
+}
+
+static void cpuSetFlagsLazy(uint32_t op, uint32_t msb, uint32_t res, uint32_t dst, uint32_t src)
+{
+  // nz and cmp leave X alone, so the X of a pending add/sub is kept.
+  if (op < CPU_FLAGS_ADD && cpu_flags_op >= CPU_FLAGS_ADD)
+  {
+    uint32_t carry;
+    if (cpu_flags_op == CPU_FLAGS_ADD)
+      carry = (cpu_flags_src & cpu_flags_dst) | (~cpu_flags_res & (cpu_flags_src | cpu_flags_dst));
+    else
+      carry = (cpu_flags_src & ~cpu_flags_dst) | (cpu_flags_res & (cpu_flags_src | ~cpu_flags_dst));
+    cpu_sr = (cpu_sr & 0xffef) | ((carry & cpu_flags_msb) ? 0x10 : 0);
+  }
+
+  cpu_flags_op = op;
+  cpu_flags_msb = msb;
+  cpu_flags_res = res;
+  cpu_flags_dst = dst;
+  cpu_flags_src = src;
+}
+
+#define cpuSetFlagsResult cpuSetFlagsLazy
+
+#else
+
+void cpuMaterializeFlags(void)
+{
+}
+
+void cpuDiscardFlags(void)
+{
+}
+
+#define cpuSetFlagsResult cpuSetFlagsFromResult
+
+#endif
+
 
 /// Sets the Z flag for bit operations
 void cpuSetZFlagBitOpsB(uint8_t res)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xfffb;
   if (res == 0) flags |= 4;
   cpu_sr = flags;
@@ -36,6 +119,7 @@ void cpuSetZFlagBitOpsB(uint8_t res)
 /// Sets the Z flag for bit operations
 void cpuSetZFlagBitOpsL(uint32_t res)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xfffb;
   if (res == 0) flags |= 4;
   cpu_sr = flags;
@@ -103,6 +187,7 @@ static uint32_t cpuMakeFlagNVCSub(BOOLE rm, BOOLE dm, BOOLE sm)
 /// <param name="f">The new state of the flags.</param>        
 void cpuSetFlagXC(BOOLE f)
 {
+  cpuMaterializeFlags();
   cpu_sr = (cpu_sr & 0xffee) | ((f) ? 0x11 : 0);
 }
 
@@ -112,6 +197,7 @@ void cpuSetFlagXC(BOOLE f)
 /// <param name="f">The new state of the flag.</param>        
 void cpuSetFlagC(BOOLE f)
 {
+  cpuMaterializeFlags();
   cpu_sr = (cpu_sr & 0xfffe) | ((f) ? 1 : 0);
 }
 
@@ -121,6 +207,7 @@ void cpuSetFlagC(BOOLE f)
 /// <param name="f">The new state of the flag.</param>        
 void cpuSetFlagV(BOOLE f)
 {
+  cpuMaterializeFlags();
   cpu_sr = (cpu_sr & 0xfffd) | ((f) ? 2 : 0);
 }
 
@@ -129,6 +216,7 @@ void cpuSetFlagV(BOOLE f)
 /// </summary>
 BOOLE cpuGetFlagV(void)
 {
+  cpuMaterializeFlags();
   return cpu_sr & 0x2;
 }
 
@@ -138,6 +226,7 @@ BOOLE cpuGetFlagV(void)
 /// <param name="f">The new state of the flag.</param>        
 void cpuSetFlagN(BOOLE f)
 {
+  cpuMaterializeFlags();
   cpu_sr = (cpu_sr & 0xfff7) | ((f) ? 8 : 0);
 }
 
@@ -147,6 +236,7 @@ void cpuSetFlagN(BOOLE f)
 /// <param name="f">The new state of the flag.</param>        
 void cpuSetFlagZ(BOOLE f)
 {
+  cpuMaterializeFlags();
   cpu_sr = (cpu_sr & 0xfffb) | ((f) ? 4 : 0);
 }
 
@@ -155,6 +245,7 @@ void cpuSetFlagZ(BOOLE f)
 /// </summary>
 BOOLE cpuGetFlagX(void)
 {
+  cpuMaterializeFlags();
   return cpu_sr & 0x10;
 }
 
@@ -163,6 +254,7 @@ BOOLE cpuGetFlagX(void)
 /// </summary>
 void cpuSetFlags0100(void)
 {
+  cpuMaterializeFlags();
   cpu_sr = (cpu_sr & 0xfff0) | 4;
 }
 
@@ -171,6 +263,7 @@ void cpuSetFlags0100(void)
 /// </summary>
 void cpuClearFlagsVC(void)
 {
+  cpuMaterializeFlags();
   cpu_sr = cpu_sr & 0xfffc;
 }
 
@@ -191,6 +284,7 @@ uint16_t cpuGetNFlagL(uint32_t res) {return (uint16_t)((res & 0x80000000) >> 28)
 /// <param name="c">The C flag.</param>        
 void cpuSetFlagsNZVC(BOOLE z, BOOLE n, BOOLE v, BOOLE c)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xfff0;
   if (n) flags |= 8;
   else if (z) flags |= 4;
@@ -206,6 +300,7 @@ void cpuSetFlagsNZVC(BOOLE z, BOOLE n, BOOLE v, BOOLE c)
 /// <param name="c">The C flag.</param>        
 void cpuSetFlagsVC(BOOLE v, BOOLE c)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xfffc;
   if (v) flags |= 2;
   if (c) flags |= 1;
@@ -221,6 +316,7 @@ void cpuSetFlagsVC(BOOLE v, BOOLE c)
 /// <param name="sm">The MSB of the source.</param>        
 void cpuSetFlagsAdd(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xffe0;
   if (z) flags |= 4;
   flags |= cpuMakeFlagXNVCAdd(rm, dm, sm);
@@ -236,6 +332,7 @@ void cpuSetFlagsAdd(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 /// <param name="sm">The MSB of the source.</param>        
 void cpuSetFlagsSub(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xffe0;
   if (z) flags |= 4;
   flags |= cpuMakeFlagXNVCSub(rm, dm, sm);
@@ -251,6 +348,7 @@ void cpuSetFlagsSub(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 /// <param name="sm">The MSB of the source.</param>        
 void cpuSetFlagsAddX(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & ((z) ? 0xffe4 : 0xffe0); // Clear z if result is non-zero
   flags |= cpuMakeFlagXNVCAdd(rm, dm, sm);
   cpu_sr = flags;
@@ -265,6 +363,7 @@ void cpuSetFlagsAddX(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 /// <param name="sm">The MSB of the source.</param>        
 void cpuSetFlagsSubX(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & ((z) ? 0xffe4 : 0xffe0); // Clear z if result is non-zero
   flags |= cpuMakeFlagXNVCSub(rm, dm, sm);
   cpu_sr = flags;
@@ -278,6 +377,7 @@ void cpuSetFlagsSubX(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 /// <param name="dm">The MSB of the destination source.</param>        
 void cpuSetFlagsNeg(BOOLE z, BOOLE rm, BOOLE dm)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xffe0;
   if (z) flags |= 4;
   else
@@ -300,6 +400,7 @@ void cpuSetFlagsNeg(BOOLE z, BOOLE rm, BOOLE dm)
 /// <param name="dm">The MSB of the destination source.</param>        
 void cpuSetFlagsNegx(BOOLE z, BOOLE rm, BOOLE dm)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & ((z) ? 0xffe4 : 0xffe0); // Clear z if result is non-zero
   if (dm || rm)
   {
@@ -322,6 +423,7 @@ void cpuSetFlagsNegx(BOOLE z, BOOLE rm, BOOLE dm)
 /// <param name="sm">The MSB of the source.</param>        
 void cpuSetFlagsCmp(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xfff0;
   if (z) flags |= 4;    
   flags |= cpuMakeFlagNVCSub(rm, dm, sm);
@@ -335,6 +437,7 @@ void cpuSetFlagsCmp(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm)
 /// <param name="rm">The MSB of the result.</param>        
 void cpuSetFlagsShiftZero(BOOLE z, BOOLE rm)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xfff0; // Always clearing the VC flag
   if (rm) flags |= 8;
   else if (z) flags |= 4;  
@@ -350,6 +453,7 @@ void cpuSetFlagsShiftZero(BOOLE z, BOOLE rm)
 /// <param name="c">The overflow of the result.</param>        
 void cpuSetFlagsShift(BOOLE z, BOOLE rm, BOOLE c, BOOLE v)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xffe0;
   if (rm) flags |= 8;
   else if (z) flags |= 4;
@@ -366,6 +470,7 @@ void cpuSetFlagsShift(BOOLE z, BOOLE rm, BOOLE c, BOOLE v)
 /// <param name="c">The carry of the result.</param>        
 void cpuSetFlagsRotate(BOOLE z, BOOLE rm, BOOLE c)
 {
+  cpuMaterializeFlags();
   uint32_t flags = cpu_sr & 0xfff0; // Always clearing the V flag
   
   if (rm) flags |= 8;
@@ -383,18 +488,76 @@ void cpuSetFlagsRotate(BOOLE z, BOOLE rm, BOOLE c)
 /// <param name="c">The extend bit and carry of the result.</param>        
 void cpuSetFlagsRotateX(uint16_t z, uint16_t rm, uint16_t x)
 {
+  cpuMaterializeFlags();
   cpu_sr = (cpu_sr & 0xffe0) | z | rm | x;
 }
 
+/// <summary>
+/// Calculates the flags of an operation from its result and operands.
+/// </summary>
+static void cpuSetFlagsFromResult(uint32_t op, uint32_t msb, uint32_t res, uint32_t dst, uint32_t src)
+{
+  BOOLE z = (res & (msb + msb - 1)) == 0;
+  BOOLE rm = (res & msb) != 0;
+  BOOLE dm = (dst & msb) != 0;
+  BOOLE sm = (src & msb) != 0;
+  uint32_t flags;
+
+  switch (op)
+  {
+    case CPU_FLAGS_NZ:
+      flags = cpu_sr & 0xfff0;
+      if (rm) flags |= 8;
+      else if (z) flags |= 4;
+      break;
+    case CPU_FLAGS_CMP:
+      flags = cpu_sr & 0xfff0;
+      if (z) flags |= 4;
+      flags |= cpuMakeFlagNVCSub(rm, dm, sm);
+      break;
+    case CPU_FLAGS_ADD:
+      flags = cpu_sr & 0xffe0;
+      if (z) flags |= 4;
+      flags |= cpuMakeFlagXNVCAdd(rm, dm, sm);
+      break;
+    case CPU_FLAGS_SUB:
+      flags = cpu_sr & 0xffe0;
+      if (z) flags |= 4;
+      flags |= cpuMakeFlagXNVCSub(rm, dm, sm);
+      break;
+    default:
+      return;
+  }
+  cpu_sr = flags;
+}
+
+/// <summary>
+/// Set the flags (all) of an add operation from the result and operands.
+/// </summary>
+void cpuSetFlagsAddB(uint8_t res, uint8_t dst, uint8_t src) {cpuSetFlagsResult(CPU_FLAGS_ADD, 0x80, res, dst, src);}
+void cpuSetFlagsAddW(uint16_t res, uint16_t dst, uint16_t src) {cpuSetFlagsResult(CPU_FLAGS_ADD, 0x8000, res, dst, src);}
+void cpuSetFlagsAddL(uint32_t res, uint32_t dst, uint32_t src) {cpuSetFlagsResult(CPU_FLAGS_ADD, 0x80000000, res, dst, src);}
+
+/// <summary>
+/// Set the flags (all) of a sub operation from the result and operands.
+/// </summary>
+void cpuSetFlagsSubB(uint8_t res, uint8_t dst, uint8_t src) {cpuSetFlagsResult(CPU_FLAGS_SUB, 0x80, res, dst, src);}
+void cpuSetFlagsSubW(uint16_t res, uint16_t dst, uint16_t src) {cpuSetFlagsResult(CPU_FLAGS_SUB, 0x8000, res, dst, src);}
+void cpuSetFlagsSubL(uint32_t res, uint32_t dst, uint32_t src) {cpuSetFlagsResult(CPU_FLAGS_SUB, 0x80000000, res, dst, src);}
+
+/// <summary>
+/// Set the flags of a cmp operation from the result and operands.
+/// </summary>
+void cpuSetFlagsCmpB(uint8_t res, uint8_t dst, uint8_t src) {cpuSetFlagsResult(CPU_FLAGS_CMP, 0x80, res, dst, src);}
+void cpuSetFlagsCmpW(uint16_t res, uint16_t dst, uint16_t src) {cpuSetFlagsResult(CPU_FLAGS_CMP, 0x8000, res, dst, src);}
+void cpuSetFlagsCmpL(uint32_t res, uint32_t dst, uint32_t src) {cpuSetFlagsResult(CPU_FLAGS_CMP, 0x80000000, res, dst, src);}
+
 /// <summary>
 /// Set the flags (ZN00).
 /// </summary>
 void cpuSetFlagsNZ00NewB(uint8_t res)
 {
-  uint32_t flag = cpu_sr & 0xfff0;
-  if (res & 0x80) flag |= 0x8;
-  else if (res == 0) flag |= 0x4;
-  cpu_sr = flag;
+  cpuSetFlagsResult(CPU_FLAGS_NZ, 0x80, res, 0, 0);
 }
 
 /// <summary>
@@ -402,10 +565,7 @@ void cpuSetFlagsNZ00NewB(uint8_t res)
 /// </summary>
 void cpuSetFlagsNZ00NewW(uint16_t res)
 {
-  uint32_t flag = cpu_sr & 0xfff0;
-  if (res & 0x8000) flag |= 0x8;
-  else if (res == 0) flag |= 0x4;
-  cpu_sr = flag;
+  cpuSetFlagsResult(CPU_FLAGS_NZ, 0x8000, res, 0, 0);
 }
 
 /// <summary>
@@ -413,10 +573,7 @@ void cpuSetFlagsNZ00NewW(uint16_t res)
 /// </summary>
 void cpuSetFlagsNZ00NewL(uint32_t res)
 {
-  uint32_t flag = cpu_sr & 0xfff0;
-  if (res & 0x80000000) flag |= 0x8;
-  else if (res == 0) flag |= 0x4;
-  cpu_sr = flag;
+  cpuSetFlagsResult(CPU_FLAGS_NZ, 0x80000000, res, 0, 0);
 }
 
 /// <summary>
@@ -424,6 +581,7 @@ void cpuSetFlagsNZ00NewL(uint32_t res)
 /// </summary>
 void cpuSetFlagsNZ00New64(int64_t res)
 {
+  cpuMaterializeFlags();
   uint32_t flag = cpu_sr & 0xfff0;
   if (res < 0) flag |= 0x8;
   else if (res == 0) flag |= 0x4;
@@ -436,6 +594,7 @@ void cpuSetFlagsNZ00New64(int64_t res)
 /// <param name="f">flags</param>        
 void cpuSetFlagsAbs(uint16_t f)
 {
+  cpuMaterializeFlags();
   cpu_sr = (cpu_sr & 0xfff0) | f;
 }
 
@@ -455,74 +614,88 @@ BOOLE cpuCalculateConditionCode1(void)
 
 BOOLE cpuCalculateConditionCode2(void)
 {
+  cpuMaterializeFlags();
   return !(cpu_sr & 5);     // HI - !C && !Z
 }
 
 BOOLE cpuCalculateConditionCode3(void)
 {
+  cpuMaterializeFlags();
   return cpu_sr & 5;	      // LS - C || Z
 }
 
 BOOLE cpuCalculateConditionCode4(void)
 {
+  cpuMaterializeFlags();
   return (~cpu_sr) & 1;	      // CC - !C
 }
 
 BOOLE cpuCalculateConditionCode5(void)
 {
+  cpuMaterializeFlags();
   return cpu_sr & 1;	      // CS - C
 }
 
 BOOLE cpuCalculateConditionCode6(void)
 {
+  cpuMaterializeFlags();
   return (~cpu_sr) & 4;	      // NE - !Z
 }
 
 BOOLE cpuCalculateConditionCode7(void)
 {
+  cpuMaterializeFlags();
   return cpu_sr & 4;	      // EQ - Z
 }
 
 BOOLE cpuCalculateConditionCode8(void)
 {
+  cpuMaterializeFlags();
   return (~cpu_sr) & 2;	      // VC - !V
 }
 
 BOOLE cpuCalculateConditionCode9(void)
 {
+  cpuMaterializeFlags();
   return cpu_sr & 2;	      // VS - V
 }
 
 BOOLE cpuCalculateConditionCode10(void)
 {
+  cpuMaterializeFlags();
   return (~cpu_sr) & 8;      // PL - !N
 }
 
 BOOLE cpuCalculateConditionCode11(void)
 {
+  cpuMaterializeFlags();
   return cpu_sr & 8;	      // MI - N
 }
 
 BOOLE cpuCalculateConditionCode12(void)
 {
+  cpuMaterializeFlags();
   uint32_t tmp = cpu_sr & 0xa;
   return (tmp == 0xa) || (tmp == 0);  // GE - (N && V) || (!N && !V)
 }
 
 BOOLE cpuCalculateConditionCode13(void)
 {
+  cpuMaterializeFlags();
   uint32_t tmp = cpu_sr & 0xa;
   return (tmp == 0x8) || (tmp == 0x2);	// LT - (N && !V) || (!N && V)
 }
 
 BOOLE cpuCalculateConditionCode14(void)
 {
+  cpuMaterializeFlags();
   uint32_t tmp = cpu_sr & 0xa;
   return (!(cpu_sr & 0x4)) && ((tmp == 0xa) || (tmp == 0)); // GT - (N && V && !Z) || (!N && !V && !Z) 
 }
 
 BOOLE cpuCalculateConditionCode15(void)
 {
+  cpuMaterializeFlags();
   uint32_t tmp = cpu_sr & 0xa;
   return (cpu_sr & 0x4) || (tmp == 0x8) || (tmp == 2);// LE - Z || (N && !V) || (!N && V)
 }
@@ -0,0 +1,1680 @@
+// MPW -- every opcode handler, for the threaded dispatch engine.
+// Included with CPU_HANDLER(name) defined.  The order gives the
+// handler index; cpuIllegalInstruction is 0.
+
+CPU_HANDLER(cpuIllegalInstruction)
+CPU_HANDLER(cpuALine)
+CPU_HANDLER(cpuFLine)
+CPU_HANDLER(ADD_D000)
+CPU_HANDLER(ADD_D010)
+CPU_HANDLER(ADD_D018)
+CPU_HANDLER(ADD_D020)
+CPU_HANDLER(ADD_D028)
+CPU_HANDLER(ADD_D030)
+CPU_HANDLER(ADD_D038)
+CPU_HANDLER(ADD_D039)
+CPU_HANDLER(ADD_D03A)
+CPU_HANDLER(ADD_D03B)
+CPU_HANDLER(ADD_D03C)
+CPU_HANDLER(ADD_D040)
+CPU_HANDLER(ADD_D048)
+CPU_HANDLER(ADD_D050)
+CPU_HANDLER(ADD_D058)
+CPU_HANDLER(ADD_D060)
+CPU_HANDLER(ADD_D068)
+CPU_HANDLER(ADD_D070)
+CPU_HANDLER(ADD_D078)
+CPU_HANDLER(ADD_D079)
+CPU_HANDLER(ADD_D07A)
+CPU_HANDLER(ADD_D07B)
+CPU_HANDLER(ADD_D07C)
+CPU_HANDLER(ADD_D080)
+CPU_HANDLER(ADD_D088)
+CPU_HANDLER(ADD_D090)
+CPU_HANDLER(ADD_D098)
+CPU_HANDLER(ADD_D0A0)
+CPU_HANDLER(ADD_D0A8)
+CPU_HANDLER(ADD_D0B0)
+CPU_HANDLER(ADD_D0B8)
+CPU_HANDLER(ADD_D0B9)
+CPU_HANDLER(ADD_D0BA)
+CPU_HANDLER(ADD_D0BB)
+CPU_HANDLER(ADD_D0BC)
+CPU_HANDLER(ADD_D110)
+CPU_HANDLER(ADD_D118)
+CPU_HANDLER(ADD_D120)
+CPU_HANDLER(ADD_D128)
+CPU_HANDLER(ADD_D130)
+CPU_HANDLER(ADD_D138)
+CPU_HANDLER(ADD_D139)
+CPU_HANDLER(ADD_D150)
+CPU_HANDLER(ADD_D158)
+CPU_HANDLER(ADD_D160)
+CPU_HANDLER(ADD_D168)
+CPU_HANDLER(ADD_D170)
+CPU_HANDLER(ADD_D178)
+CPU_HANDLER(ADD_D179)
+CPU_HANDLER(ADD_D190)
+CPU_HANDLER(ADD_D198)
+CPU_HANDLER(ADD_D1A0)
+CPU_HANDLER(ADD_D1A8)
+CPU_HANDLER(ADD_D1B0)
+CPU_HANDLER(ADD_D1B8)
+CPU_HANDLER(ADD_D1B9)
+CPU_HANDLER(ADDA_D0C0)
+CPU_HANDLER(ADDA_D0C8)
+CPU_HANDLER(ADDA_D0D0)
+CPU_HANDLER(ADDA_D0D8)
+CPU_HANDLER(ADDA_D0E0)
+CPU_HANDLER(ADDA_D0E8)
+CPU_HANDLER(ADDA_D0F0)
+CPU_HANDLER(ADDA_D0F8)
+CPU_HANDLER(ADDA_D0F9)
+CPU_HANDLER(ADDA_D0FA)
+CPU_HANDLER(ADDA_D0FB)
+CPU_HANDLER(ADDA_D0FC)
+CPU_HANDLER(ADDA_D1C0)
+CPU_HANDLER(ADDA_D1C8)
+CPU_HANDLER(ADDA_D1D0)
+CPU_HANDLER(ADDA_D1D8)
+CPU_HANDLER(ADDA_D1E0)
+CPU_HANDLER(ADDA_D1E8)
+CPU_HANDLER(ADDA_D1F0)
+CPU_HANDLER(ADDA_D1F8)
+CPU_HANDLER(ADDA_D1F9)
+CPU_HANDLER(ADDA_D1FA)
+CPU_HANDLER(ADDA_D1FB)
+CPU_HANDLER(ADDA_D1FC)
+CPU_HANDLER(ADDI_0600)
+CPU_HANDLER(ADDI_0610)
+CPU_HANDLER(ADDI_0618)
+CPU_HANDLER(ADDI_0620)
+CPU_HANDLER(ADDI_0628)
+CPU_HANDLER(ADDI_0630)
+CPU_HANDLER(ADDI_0638)
+CPU_HANDLER(ADDI_0639)
+CPU_HANDLER(ADDI_0640)
+CPU_HANDLER(ADDI_0650)
+CPU_HANDLER(ADDI_0658)
+CPU_HANDLER(ADDI_0660)
+CPU_HANDLER(ADDI_0668)
+CPU_HANDLER(ADDI_0670)
+CPU_HANDLER(ADDI_0678)
+CPU_HANDLER(ADDI_0679)
+CPU_HANDLER(ADDI_0680)
+CPU_HANDLER(ADDI_0690)
+CPU_HANDLER(ADDI_0698)
+CPU_HANDLER(ADDI_06A0)
+CPU_HANDLER(ADDI_06A8)
+CPU_HANDLER(ADDI_06B0)
+CPU_HANDLER(ADDI_06B8)
+CPU_HANDLER(ADDI_06B9)
+CPU_HANDLER(ADDQ_5000)
+CPU_HANDLER(ADDQ_5010)
+CPU_HANDLER(ADDQ_5018)
+CPU_HANDLER(ADDQ_5020)
+CPU_HANDLER(ADDQ_5028)
+CPU_HANDLER(ADDQ_5030)
+CPU_HANDLER(ADDQ_5038)
+CPU_HANDLER(ADDQ_5039)
+CPU_HANDLER(ADDQ_5040)
+CPU_HANDLER(ADDQ_5050)
+CPU_HANDLER(ADDQ_5058)
+CPU_HANDLER(ADDQ_5060)
+CPU_HANDLER(ADDQ_5068)
+CPU_HANDLER(ADDQ_5070)
+CPU_HANDLER(ADDQ_5078)
+CPU_HANDLER(ADDQ_5079)
+CPU_HANDLER(ADDQ_5080)
+CPU_HANDLER(ADDQ_5090)
+CPU_HANDLER(ADDQ_5098)
+CPU_HANDLER(ADDQ_50A0)
+CPU_HANDLER(ADDQ_50A8)
+CPU_HANDLER(ADDQ_50B0)
+CPU_HANDLER(ADDQ_50B8)
+CPU_HANDLER(ADDQ_50B9)
+CPU_HANDLER(ADDQ_5048)
+CPU_HANDLER(ADDQ_5088)
+CPU_HANDLER(AND_C000)
+CPU_HANDLER(AND_C010)
+CPU_HANDLER(AND_C018)
+CPU_HANDLER(AND_C020)
+CPU_HANDLER(AND_C028)
+CPU_HANDLER(AND_C030)
+CPU_HANDLER(AND_C038)
+CPU_HANDLER(AND_C039)
+CPU_HANDLER(AND_C03A)
+CPU_HANDLER(AND_C03B)
+CPU_HANDLER(AND_C03C)
+CPU_HANDLER(AND_C040)
+CPU_HANDLER(AND_C050)
+CPU_HANDLER(AND_C058)
+CPU_HANDLER(AND_C060)
+CPU_HANDLER(AND_C068)
+CPU_HANDLER(AND_C070)
+CPU_HANDLER(AND_C078)
+CPU_HANDLER(AND_C079)
+CPU_HANDLER(AND_C07A)
+CPU_HANDLER(AND_C07B)
+CPU_HANDLER(AND_C07C)
+CPU_HANDLER(AND_C080)
+CPU_HANDLER(AND_C090)
+CPU_HANDLER(AND_C098)
+CPU_HANDLER(AND_C0A0)
+CPU_HANDLER(AND_C0A8)
+CPU_HANDLER(AND_C0B0)
+CPU_HANDLER(AND_C0B8)
+CPU_HANDLER(AND_C0B9)
+CPU_HANDLER(AND_C0BA)
+CPU_HANDLER(AND_C0BB)
+CPU_HANDLER(AND_C0BC)
+CPU_HANDLER(AND_C110)
+CPU_HANDLER(AND_C118)
+CPU_HANDLER(AND_C120)
+CPU_HANDLER(AND_C128)
+CPU_HANDLER(AND_C130)
+CPU_HANDLER(AND_C138)
+CPU_HANDLER(AND_C139)
+CPU_HANDLER(AND_C150)
+CPU_HANDLER(AND_C158)
+CPU_HANDLER(AND_C160)
+CPU_HANDLER(AND_C168)
+CPU_HANDLER(AND_C170)
+CPU_HANDLER(AND_C178)
+CPU_HANDLER(AND_C179)
+CPU_HANDLER(AND_C190)
+CPU_HANDLER(AND_C198)
+CPU_HANDLER(AND_C1A0)
+CPU_HANDLER(AND_C1A8)
+CPU_HANDLER(AND_C1B0)
+CPU_HANDLER(AND_C1B8)
+CPU_HANDLER(AND_C1B9)
+CPU_HANDLER(ANDI_0200)
+CPU_HANDLER(ANDI_0210)
+CPU_HANDLER(ANDI_0218)
+CPU_HANDLER(ANDI_0220)
+CPU_HANDLER(ANDI_0228)
+CPU_HANDLER(ANDI_0230)
+CPU_HANDLER(ANDI_0238)
+CPU_HANDLER(ANDI_0239)
+CPU_HANDLER(ANDI_0240)
+CPU_HANDLER(ANDI_0250)
+CPU_HANDLER(ANDI_0258)
+CPU_HANDLER(ANDI_0260)
+CPU_HANDLER(ANDI_0268)
+CPU_HANDLER(ANDI_0270)
+CPU_HANDLER(ANDI_0278)
+CPU_HANDLER(ANDI_0279)
+CPU_HANDLER(ANDI_0280)
+CPU_HANDLER(ANDI_0290)
+CPU_HANDLER(ANDI_0298)
+CPU_HANDLER(ANDI_02A0)
+CPU_HANDLER(ANDI_02A8)
+CPU_HANDLER(ANDI_02B0)
+CPU_HANDLER(ANDI_02B8)
+CPU_HANDLER(ANDI_02B9)
+CPU_HANDLER(ANDI_023C)
+CPU_HANDLER(ANDI_027C)
+CPU_HANDLER(EOR_B100)
+CPU_HANDLER(EOR_B110)
+CPU_HANDLER(EOR_B118)
+CPU_HANDLER(EOR_B120)
+CPU_HANDLER(EOR_B128)
+CPU_HANDLER(EOR_B130)
+CPU_HANDLER(EOR_B138)
+CPU_HANDLER(EOR_B139)
+CPU_HANDLER(EOR_B140)
+CPU_HANDLER(EOR_B150)
+CPU_HANDLER(EOR_B158)
+CPU_HANDLER(EOR_B160)
+CPU_HANDLER(EOR_B168)
+CPU_HANDLER(EOR_B170)
+CPU_HANDLER(EOR_B178)
+CPU_HANDLER(EOR_B179)
+CPU_HANDLER(EOR_B180)
+CPU_HANDLER(EOR_B190)
+CPU_HANDLER(EOR_B198)
+CPU_HANDLER(EOR_B1A0)
+CPU_HANDLER(EOR_B1A8)
+CPU_HANDLER(EOR_B1B0)
+CPU_HANDLER(EOR_B1B8)
+CPU_HANDLER(EOR_B1B9)
+CPU_HANDLER(EORI_0A00)
+CPU_HANDLER(EORI_0A10)
+CPU_HANDLER(EORI_0A18)
+CPU_HANDLER(EORI_0A20)
+CPU_HANDLER(EORI_0A28)
+CPU_HANDLER(EORI_0A30)
+CPU_HANDLER(EORI_0A38)
+CPU_HANDLER(EORI_0A39)
+CPU_HANDLER(EORI_0A40)
+CPU_HANDLER(EORI_0A50)
+CPU_HANDLER(EORI_0A58)
+CPU_HANDLER(EORI_0A60)
+CPU_HANDLER(EORI_0A68)
+CPU_HANDLER(EORI_0A70)
+CPU_HANDLER(EORI_0A78)
+CPU_HANDLER(EORI_0A79)
+CPU_HANDLER(EORI_0A80)
+CPU_HANDLER(EORI_0A90)
+CPU_HANDLER(EORI_0A98)
+CPU_HANDLER(EORI_0AA0)
+CPU_HANDLER(EORI_0AA8)
+CPU_HANDLER(EORI_0AB0)
+CPU_HANDLER(EORI_0AB8)
+CPU_HANDLER(EORI_0AB9)
+CPU_HANDLER(EORI_0A3C)
+CPU_HANDLER(EORI_0A7C)
+CPU_HANDLER(OR_8000)
+CPU_HANDLER(OR_8010)
+CPU_HANDLER(OR_8018)
+CPU_HANDLER(OR_8020)
+CPU_HANDLER(OR_8028)
+CPU_HANDLER(OR_8030)
+CPU_HANDLER(OR_8038)
+CPU_HANDLER(OR_8039)
+CPU_HANDLER(OR_803A)
+CPU_HANDLER(OR_803B)
+CPU_HANDLER(OR_803C)
+CPU_HANDLER(OR_8040)
+CPU_HANDLER(OR_8050)
+CPU_HANDLER(OR_8058)
+CPU_HANDLER(OR_8060)
+CPU_HANDLER(OR_8068)
+CPU_HANDLER(OR_8070)
+CPU_HANDLER(OR_8078)
+CPU_HANDLER(OR_8079)
+CPU_HANDLER(OR_807A)
+CPU_HANDLER(OR_807B)
+CPU_HANDLER(OR_807C)
+CPU_HANDLER(OR_8080)
+CPU_HANDLER(OR_8090)
+CPU_HANDLER(OR_8098)
+CPU_HANDLER(OR_80A0)
+CPU_HANDLER(OR_80A8)
+CPU_HANDLER(OR_80B0)
+CPU_HANDLER(OR_80B8)
+CPU_HANDLER(OR_80B9)
+CPU_HANDLER(OR_80BA)
+CPU_HANDLER(OR_80BB)
+CPU_HANDLER(OR_80BC)
+CPU_HANDLER(OR_8110)
+CPU_HANDLER(OR_8118)
+CPU_HANDLER(OR_8120)
+CPU_HANDLER(OR_8128)
+CPU_HANDLER(OR_8130)
+CPU_HANDLER(OR_8138)
+CPU_HANDLER(OR_8139)
+CPU_HANDLER(OR_8150)
+CPU_HANDLER(OR_8158)
+CPU_HANDLER(OR_8160)
+CPU_HANDLER(OR_8168)
+CPU_HANDLER(OR_8170)
+CPU_HANDLER(OR_8178)
+CPU_HANDLER(OR_8179)
+CPU_HANDLER(OR_8190)
+CPU_HANDLER(OR_8198)
+CPU_HANDLER(OR_81A0)
+CPU_HANDLER(OR_81A8)
+CPU_HANDLER(OR_81B0)
+CPU_HANDLER(OR_81B8)
+CPU_HANDLER(OR_81B9)
+CPU_HANDLER(ORI_0000)
+CPU_HANDLER(ORI_0010)
+CPU_HANDLER(ORI_0018)
+CPU_HANDLER(ORI_0020)
+CPU_HANDLER(ORI_0028)
+CPU_HANDLER(ORI_0030)
+CPU_HANDLER(ORI_0038)
+CPU_HANDLER(ORI_0039)
+CPU_HANDLER(ORI_0040)
+CPU_HANDLER(ORI_0050)
+CPU_HANDLER(ORI_0058)
+CPU_HANDLER(ORI_0060)
+CPU_HANDLER(ORI_0068)
+CPU_HANDLER(ORI_0070)
+CPU_HANDLER(ORI_0078)
+CPU_HANDLER(ORI_0079)
+CPU_HANDLER(ORI_0080)
+CPU_HANDLER(ORI_0090)
+CPU_HANDLER(ORI_0098)
+CPU_HANDLER(ORI_00A0)
+CPU_HANDLER(ORI_00A8)
+CPU_HANDLER(ORI_00B0)
+CPU_HANDLER(ORI_00B8)
+CPU_HANDLER(ORI_00B9)
+CPU_HANDLER(ORI_003C)
+CPU_HANDLER(ORI_007C)
+CPU_HANDLER(SUB_9000)
+CPU_HANDLER(SUB_9010)
+CPU_HANDLER(SUB_9018)
+CPU_HANDLER(SUB_9020)
+CPU_HANDLER(SUB_9028)
+CPU_HANDLER(SUB_9030)
+CPU_HANDLER(SUB_9038)
+CPU_HANDLER(SUB_9039)
+CPU_HANDLER(SUB_903A)
+CPU_HANDLER(SUB_903B)
+CPU_HANDLER(SUB_903C)
+CPU_HANDLER(SUB_9040)
+CPU_HANDLER(SUB_9048)
+CPU_HANDLER(SUB_9050)
+CPU_HANDLER(SUB_9058)
+CPU_HANDLER(SUB_9060)
+CPU_HANDLER(SUB_9068)
+CPU_HANDLER(SUB_9070)
+CPU_HANDLER(SUB_9078)
+CPU_HANDLER(SUB_9079)
+CPU_HANDLER(SUB_907A)
+CPU_HANDLER(SUB_907B)
+CPU_HANDLER(SUB_907C)
+CPU_HANDLER(SUB_9080)
+CPU_HANDLER(SUB_9088)
+CPU_HANDLER(SUB_9090)
+CPU_HANDLER(SUB_9098)
+CPU_HANDLER(SUB_90A0)
+CPU_HANDLER(SUB_90A8)
+CPU_HANDLER(SUB_90B0)
+CPU_HANDLER(SUB_90B8)
+CPU_HANDLER(SUB_90B9)
+CPU_HANDLER(SUB_90BA)
+CPU_HANDLER(SUB_90BB)
+CPU_HANDLER(SUB_90BC)
+CPU_HANDLER(SUB_9110)
+CPU_HANDLER(SUB_9118)
+CPU_HANDLER(SUB_9120)
+CPU_HANDLER(SUB_9128)
+CPU_HANDLER(SUB_9130)
+CPU_HANDLER(SUB_9138)
+CPU_HANDLER(SUB_9139)
+CPU_HANDLER(SUB_9150)
+CPU_HANDLER(SUB_9158)
+CPU_HANDLER(SUB_9160)
+CPU_HANDLER(SUB_9168)
+CPU_HANDLER(SUB_9170)
+CPU_HANDLER(SUB_9178)
+CPU_HANDLER(SUB_9179)
+CPU_HANDLER(SUB_9190)
+CPU_HANDLER(SUB_9198)
+CPU_HANDLER(SUB_91A0)
+CPU_HANDLER(SUB_91A8)
+CPU_HANDLER(SUB_91B0)
+CPU_HANDLER(SUB_91B8)
+CPU_HANDLER(SUB_91B9)
+CPU_HANDLER(SUBA_90C0)
+CPU_HANDLER(SUBA_90C8)
+CPU_HANDLER(SUBA_90D0)
+CPU_HANDLER(SUBA_90D8)
+CPU_HANDLER(SUBA_90E0)
+CPU_HANDLER(SUBA_90E8)
+CPU_HANDLER(SUBA_90F0)
+CPU_HANDLER(SUBA_90F8)
+CPU_HANDLER(SUBA_90F9)
+CPU_HANDLER(SUBA_90FA)
+CPU_HANDLER(SUBA_90FB)
+CPU_HANDLER(SUBA_90FC)
+CPU_HANDLER(SUBA_91C0)
+CPU_HANDLER(SUBA_91C8)
+CPU_HANDLER(SUBA_91D0)
+CPU_HANDLER(SUBA_91D8)
+CPU_HANDLER(SUBA_91E0)
+CPU_HANDLER(SUBA_91E8)
+CPU_HANDLER(SUBA_91F0)
+CPU_HANDLER(SUBA_91F8)
+CPU_HANDLER(SUBA_91F9)
+CPU_HANDLER(SUBA_91FA)
+CPU_HANDLER(SUBA_91FB)
+CPU_HANDLER(SUBA_91FC)
+CPU_HANDLER(SUBI_0400)
+CPU_HANDLER(SUBI_0410)
+CPU_HANDLER(SUBI_0418)
+CPU_HANDLER(SUBI_0420)
+CPU_HANDLER(SUBI_0428)
+CPU_HANDLER(SUBI_0430)
+CPU_HANDLER(SUBI_0438)
+CPU_HANDLER(SUBI_0439)
+CPU_HANDLER(SUBI_0440)
+CPU_HANDLER(SUBI_0450)
+CPU_HANDLER(SUBI_0458)
+CPU_HANDLER(SUBI_0460)
+CPU_HANDLER(SUBI_0468)
+CPU_HANDLER(SUBI_0470)
+CPU_HANDLER(SUBI_0478)
+CPU_HANDLER(SUBI_0479)
+CPU_HANDLER(SUBI_0480)
+CPU_HANDLER(SUBI_0490)
+CPU_HANDLER(SUBI_0498)
+CPU_HANDLER(SUBI_04A0)
+CPU_HANDLER(SUBI_04A8)
+CPU_HANDLER(SUBI_04B0)
+CPU_HANDLER(SUBI_04B8)
+CPU_HANDLER(SUBI_04B9)
+CPU_HANDLER(SUBQ_5100)
+CPU_HANDLER(SUBQ_5110)
+CPU_HANDLER(SUBQ_5118)
+CPU_HANDLER(SUBQ_5120)
+CPU_HANDLER(SUBQ_5128)
+CPU_HANDLER(SUBQ_5130)
+CPU_HANDLER(SUBQ_5138)
+CPU_HANDLER(SUBQ_5139)
+CPU_HANDLER(SUBQ_5140)
+CPU_HANDLER(SUBQ_5150)
+CPU_HANDLER(SUBQ_5158)
+CPU_HANDLER(SUBQ_5160)
+CPU_HANDLER(SUBQ_5168)
+CPU_HANDLER(SUBQ_5170)
+CPU_HANDLER(SUBQ_5178)
+CPU_HANDLER(SUBQ_5179)
+CPU_HANDLER(SUBQ_5180)
+CPU_HANDLER(SUBQ_5190)
+CPU_HANDLER(SUBQ_5198)
+CPU_HANDLER(SUBQ_51A0)
+CPU_HANDLER(SUBQ_51A8)
+CPU_HANDLER(SUBQ_51B0)
+CPU_HANDLER(SUBQ_51B8)
+CPU_HANDLER(SUBQ_51B9)
+CPU_HANDLER(SUBQ_5148)
+CPU_HANDLER(SUBQ_5188)
+CPU_HANDLER(CHK_4180)
+CPU_HANDLER(CHK_4190)
+CPU_HANDLER(CHK_4198)
+CPU_HANDLER(CHK_41A0)
+CPU_HANDLER(CHK_41A8)
+CPU_HANDLER(CHK_41B0)
+CPU_HANDLER(CHK_41B8)
+CPU_HANDLER(CHK_41B9)
+CPU_HANDLER(CHK_41BA)
+CPU_HANDLER(CHK_41BB)
+CPU_HANDLER(CHK_41BC)
+CPU_HANDLER(CHK_4100)
+CPU_HANDLER(CHK_4110)
+CPU_HANDLER(CHK_4118)
+CPU_HANDLER(CHK_4120)
+CPU_HANDLER(CHK_4128)
+CPU_HANDLER(CHK_4130)
+CPU_HANDLER(CHK_4138)
+CPU_HANDLER(CHK_4139)
+CPU_HANDLER(CHK_413A)
+CPU_HANDLER(CHK_413B)
+CPU_HANDLER(CHK_413C)
+CPU_HANDLER(CMP_B000)
+CPU_HANDLER(CMP_B010)
+CPU_HANDLER(CMP_B018)
+CPU_HANDLER(CMP_B020)
+CPU_HANDLER(CMP_B028)
+CPU_HANDLER(CMP_B030)
+CPU_HANDLER(CMP_B038)
+CPU_HANDLER(CMP_B039)
+CPU_HANDLER(CMP_B03A)
+CPU_HANDLER(CMP_B03B)
+CPU_HANDLER(CMP_B03C)
+CPU_HANDLER(CMP_B040)
+CPU_HANDLER(CMP_B048)
+CPU_HANDLER(CMP_B050)
+CPU_HANDLER(CMP_B058)
+CPU_HANDLER(CMP_B060)
+CPU_HANDLER(CMP_B068)
+CPU_HANDLER(CMP_B070)
+CPU_HANDLER(CMP_B078)
+CPU_HANDLER(CMP_B079)
+CPU_HANDLER(CMP_B07A)
+CPU_HANDLER(CMP_B07B)
+CPU_HANDLER(CMP_B07C)
+CPU_HANDLER(CMP_B080)
+CPU_HANDLER(CMP_B088)
+CPU_HANDLER(CMP_B090)
+CPU_HANDLER(CMP_B098)
+CPU_HANDLER(CMP_B0A0)
+CPU_HANDLER(CMP_B0A8)
+CPU_HANDLER(CMP_B0B0)
+CPU_HANDLER(CMP_B0B8)
+CPU_HANDLER(CMP_B0B9)
+CPU_HANDLER(CMP_B0BA)
+CPU_HANDLER(CMP_B0BB)
+CPU_HANDLER(CMP_B0BC)
+CPU_HANDLER(CMPA_B0C0)
+CPU_HANDLER(CMPA_B0C8)
+CPU_HANDLER(CMPA_B0D0)
+CPU_HANDLER(CMPA_B0D8)
+CPU_HANDLER(CMPA_B0E0)
+CPU_HANDLER(CMPA_B0E8)
+CPU_HANDLER(CMPA_B0F0)
+CPU_HANDLER(CMPA_B0F8)
+CPU_HANDLER(CMPA_B0F9)
+CPU_HANDLER(CMPA_B0FA)
+CPU_HANDLER(CMPA_B0FB)
+CPU_HANDLER(CMPA_B0FC)
+CPU_HANDLER(CMPA_B1C0)
+CPU_HANDLER(CMPA_B1C8)
+CPU_HANDLER(CMPA_B1D0)
+CPU_HANDLER(CMPA_B1D8)
+CPU_HANDLER(CMPA_B1E0)
+CPU_HANDLER(CMPA_B1E8)
+CPU_HANDLER(CMPA_B1F0)
+CPU_HANDLER(CMPA_B1F8)
+CPU_HANDLER(CMPA_B1F9)
+CPU_HANDLER(CMPA_B1FA)
+CPU_HANDLER(CMPA_B1FB)
+CPU_HANDLER(CMPA_B1FC)
+CPU_HANDLER(CMPI_0C00)
+CPU_HANDLER(CMPI_0C10)
+CPU_HANDLER(CMPI_0C18)
+CPU_HANDLER(CMPI_0C20)
+CPU_HANDLER(CMPI_0C28)
+CPU_HANDLER(CMPI_0C30)
+CPU_HANDLER(CMPI_0C38)
+CPU_HANDLER(CMPI_0C39)
+CPU_HANDLER(CMPI_0C40)
+CPU_HANDLER(CMPI_0C50)
+CPU_HANDLER(CMPI_0C58)
+CPU_HANDLER(CMPI_0C60)
+CPU_HANDLER(CMPI_0C68)
+CPU_HANDLER(CMPI_0C70)
+CPU_HANDLER(CMPI_0C78)
+CPU_HANDLER(CMPI_0C79)
+CPU_HANDLER(CMPI_0C80)
+CPU_HANDLER(CMPI_0C90)
+CPU_HANDLER(CMPI_0C98)
+CPU_HANDLER(CMPI_0CA0)
+CPU_HANDLER(CMPI_0CA8)
+CPU_HANDLER(CMPI_0CB0)
+CPU_HANDLER(CMPI_0CB8)
+CPU_HANDLER(CMPI_0CB9)
+CPU_HANDLER(CMPI_0C3A)
+CPU_HANDLER(CMPI_0C3B)
+CPU_HANDLER(CMPI_0C7A)
+CPU_HANDLER(CMPI_0C7B)
+CPU_HANDLER(CMPI_0CBA)
+CPU_HANDLER(CMPI_0CBB)
+CPU_HANDLER(BCHG_0150)
+CPU_HANDLER(BCHG_0158)
+CPU_HANDLER(BCHG_0160)
+CPU_HANDLER(BCHG_0168)
+CPU_HANDLER(BCHG_0170)
+CPU_HANDLER(BCHG_0178)
+CPU_HANDLER(BCHG_0179)
+CPU_HANDLER(BCHG_0140)
+CPU_HANDLER(BCHG_0850)
+CPU_HANDLER(BCHG_0858)
+CPU_HANDLER(BCHG_0860)
+CPU_HANDLER(BCHG_0868)
+CPU_HANDLER(BCHG_0870)
+CPU_HANDLER(BCHG_0878)
+CPU_HANDLER(BCHG_0879)
+CPU_HANDLER(BCHG_0840)
+CPU_HANDLER(BCLR_0190)
+CPU_HANDLER(BCLR_0198)
+CPU_HANDLER(BCLR_01A0)
+CPU_HANDLER(BCLR_01A8)
+CPU_HANDLER(BCLR_01B0)
+CPU_HANDLER(BCLR_01B8)
+CPU_HANDLER(BCLR_01B9)
+CPU_HANDLER(BCLR_0180)
+CPU_HANDLER(BCLR_0890)
+CPU_HANDLER(BCLR_0898)
+CPU_HANDLER(BCLR_08A0)
+CPU_HANDLER(BCLR_08A8)
+CPU_HANDLER(BCLR_08B0)
+CPU_HANDLER(BCLR_08B8)
+CPU_HANDLER(BCLR_08B9)
+CPU_HANDLER(BCLR_0880)
+CPU_HANDLER(BSET_01D0)
+CPU_HANDLER(BSET_01D8)
+CPU_HANDLER(BSET_01E0)
+CPU_HANDLER(BSET_01E8)
+CPU_HANDLER(BSET_01F0)
+CPU_HANDLER(BSET_01F8)
+CPU_HANDLER(BSET_01F9)
+CPU_HANDLER(BSET_01C0)
+CPU_HANDLER(BSET_08D0)
+CPU_HANDLER(BSET_08D8)
+CPU_HANDLER(BSET_08E0)
+CPU_HANDLER(BSET_08E8)
+CPU_HANDLER(BSET_08F0)
+CPU_HANDLER(BSET_08F8)
+CPU_HANDLER(BSET_08F9)
+CPU_HANDLER(BSET_08C0)
+CPU_HANDLER(BTST_0110)
+CPU_HANDLER(BTST_0118)
+CPU_HANDLER(BTST_0120)
+CPU_HANDLER(BTST_0128)
+CPU_HANDLER(BTST_0130)
+CPU_HANDLER(BTST_0138)
+CPU_HANDLER(BTST_0139)
+CPU_HANDLER(BTST_013A)
+CPU_HANDLER(BTST_013B)
+CPU_HANDLER(BTST_013C)
+CPU_HANDLER(BTST_0100)
+CPU_HANDLER(BTST_0810)
+CPU_HANDLER(BTST_0818)
+CPU_HANDLER(BTST_0820)
+CPU_HANDLER(BTST_0828)
+CPU_HANDLER(BTST_0830)
+CPU_HANDLER(BTST_0838)
+CPU_HANDLER(BTST_0839)
+CPU_HANDLER(BTST_083A)
+CPU_HANDLER(BTST_083B)
+CPU_HANDLER(BTST_0800)
+CPU_HANDLER(LEA_41D0)
+CPU_HANDLER(LEA_41E8)
+CPU_HANDLER(LEA_41F0)
+CPU_HANDLER(LEA_41F8)
+CPU_HANDLER(LEA_41F9)
+CPU_HANDLER(LEA_41FA)
+CPU_HANDLER(LEA_41FB)
+CPU_HANDLER(MULS_C1C0)
+CPU_HANDLER(MULS_C1D0)
+CPU_HANDLER(MULS_C1D8)
+CPU_HANDLER(MULS_C1E0)
+CPU_HANDLER(MULS_C1E8)
+CPU_HANDLER(MULS_C1F0)
+CPU_HANDLER(MULS_C1F8)
+CPU_HANDLER(MULS_C1F9)
+CPU_HANDLER(MULS_C1FA)
+CPU_HANDLER(MULS_C1FB)
+CPU_HANDLER(MULS_C1FC)
+CPU_HANDLER(MULU_C0C0)
+CPU_HANDLER(MULU_C0D0)
+CPU_HANDLER(MULU_C0D8)
+CPU_HANDLER(MULU_C0E0)
+CPU_HANDLER(MULU_C0E8)
+CPU_HANDLER(MULU_C0F0)
+CPU_HANDLER(MULU_C0F8)
+CPU_HANDLER(MULU_C0F9)
+CPU_HANDLER(MULU_C0FA)
+CPU_HANDLER(MULU_C0FB)
+CPU_HANDLER(MULU_C0FC)
+CPU_HANDLER(DIVS_81C0)
+CPU_HANDLER(DIVS_81D0)
+CPU_HANDLER(DIVS_81D8)
+CPU_HANDLER(DIVS_81E0)
+CPU_HANDLER(DIVS_81E8)
+CPU_HANDLER(DIVS_81F0)
+CPU_HANDLER(DIVS_81F8)
+CPU_HANDLER(DIVS_81F9)
+CPU_HANDLER(DIVS_81FA)
+CPU_HANDLER(DIVS_81FB)
+CPU_HANDLER(DIVS_81FC)
+CPU_HANDLER(DIVL_4C40)
+CPU_HANDLER(DIVL_4C50)
+CPU_HANDLER(DIVL_4C58)
+CPU_HANDLER(DIVL_4C60)
+CPU_HANDLER(DIVL_4C68)
+CPU_HANDLER(DIVL_4C70)
+CPU_HANDLER(DIVL_4C78)
+CPU_HANDLER(DIVL_4C79)
+CPU_HANDLER(DIVL_4C7A)
+CPU_HANDLER(DIVL_4C7B)
+CPU_HANDLER(DIVL_4C7C)
+CPU_HANDLER(DIVU_80C0)
+CPU_HANDLER(DIVU_80D0)
+CPU_HANDLER(DIVU_80D8)
+CPU_HANDLER(DIVU_80E0)
+CPU_HANDLER(DIVU_80E8)
+CPU_HANDLER(DIVU_80F0)
+CPU_HANDLER(DIVU_80F8)
+CPU_HANDLER(DIVU_80F9)
+CPU_HANDLER(DIVU_80FA)
+CPU_HANDLER(DIVU_80FB)
+CPU_HANDLER(DIVU_80FC)
+CPU_HANDLER(MOVEM_48A0)
+CPU_HANDLER(MOVEM_48E0)
+CPU_HANDLER(MOVEM_4C98)
+CPU_HANDLER(MOVEM_4CD8)
+CPU_HANDLER(MOVEM_4890)
+CPU_HANDLER(MOVEM_48A8)
+CPU_HANDLER(MOVEM_48B0)
+CPU_HANDLER(MOVEM_48B8)
+CPU_HANDLER(MOVEM_48B9)
+CPU_HANDLER(MOVEM_48D0)
+CPU_HANDLER(MOVEM_48E8)
+CPU_HANDLER(MOVEM_48F0)
+CPU_HANDLER(MOVEM_48F8)
+CPU_HANDLER(MOVEM_48F9)
+CPU_HANDLER(MOVEM_4C90)
+CPU_HANDLER(MOVEM_4CA8)
+CPU_HANDLER(MOVEM_4CB0)
+CPU_HANDLER(MOVEM_4CB8)
+CPU_HANDLER(MOVEM_4CB9)
+CPU_HANDLER(MOVEM_4CBA)
+CPU_HANDLER(MOVEM_4CBB)
+CPU_HANDLER(MOVEM_4CD0)
+CPU_HANDLER(MOVEM_4CE8)
+CPU_HANDLER(MOVEM_4CF0)
+CPU_HANDLER(MOVEM_4CF8)
+CPU_HANDLER(MOVEM_4CF9)
+CPU_HANDLER(MOVEM_4CFA)
+CPU_HANDLER(MOVEM_4CFB)
+CPU_HANDLER(CLR_4200)
+CPU_HANDLER(CLR_4210)
+CPU_HANDLER(CLR_4218)
+CPU_HANDLER(CLR_4220)
+CPU_HANDLER(CLR_4228)
+CPU_HANDLER(CLR_4230)
+CPU_HANDLER(CLR_4238)
+CPU_HANDLER(CLR_4239)
+CPU_HANDLER(CLR_4240)
+CPU_HANDLER(CLR_4250)
+CPU_HANDLER(CLR_4258)
+CPU_HANDLER(CLR_4260)
+CPU_HANDLER(CLR_4268)
+CPU_HANDLER(CLR_4270)
+CPU_HANDLER(CLR_4278)
+CPU_HANDLER(CLR_4279)
+CPU_HANDLER(CLR_4280)
+CPU_HANDLER(CLR_4290)
+CPU_HANDLER(CLR_4298)
+CPU_HANDLER(CLR_42A0)
+CPU_HANDLER(CLR_42A8)
+CPU_HANDLER(CLR_42B0)
+CPU_HANDLER(CLR_42B8)
+CPU_HANDLER(CLR_42B9)
+CPU_HANDLER(BFCHG_EAD0)
+CPU_HANDLER(BFCHG_EAE8)
+CPU_HANDLER(BFCHG_EAF0)
+CPU_HANDLER(BFCHG_EAF8)
+CPU_HANDLER(BFCHG_EAF9)
+CPU_HANDLER(BFCLR_ECD0)
+CPU_HANDLER(BFCLR_ECE8)
+CPU_HANDLER(BFCLR_ECF0)
+CPU_HANDLER(BFCLR_ECF8)
+CPU_HANDLER(BFCLR_ECF9)
+CPU_HANDLER(BFEXTS_EBD0)
+CPU_HANDLER(BFEXTS_EBE8)
+CPU_HANDLER(BFEXTS_EBF0)
+CPU_HANDLER(BFEXTS_EBF8)
+CPU_HANDLER(BFEXTS_EBF9)
+CPU_HANDLER(BFEXTS_EBFA)
+CPU_HANDLER(BFEXTS_EBFB)
+CPU_HANDLER(BFEXTU_E9D0)
+CPU_HANDLER(BFEXTU_E9E8)
+CPU_HANDLER(BFEXTU_E9F0)
+CPU_HANDLER(BFEXTU_E9F8)
+CPU_HANDLER(BFEXTU_E9F9)
+CPU_HANDLER(BFEXTU_E9FA)
+CPU_HANDLER(BFEXTU_E9FB)
+CPU_HANDLER(BFFFO_EDD0)
+CPU_HANDLER(BFFFO_EDE8)
+CPU_HANDLER(BFFFO_EDF0)
+CPU_HANDLER(BFFFO_EDF8)
+CPU_HANDLER(BFFFO_EDF9)
+CPU_HANDLER(BFFFO_EDFA)
+CPU_HANDLER(BFFFO_EDFB)
+CPU_HANDLER(BFINS_EFD0)
+CPU_HANDLER(BFINS_EFE8)
+CPU_HANDLER(BFINS_EFF0)
+CPU_HANDLER(BFINS_EFF8)
+CPU_HANDLER(BFINS_EFF9)
+CPU_HANDLER(BFSET_EED0)
+CPU_HANDLER(BFSET_EEE8)
+CPU_HANDLER(BFSET_EEF0)
+CPU_HANDLER(BFSET_EEF8)
+CPU_HANDLER(BFSET_EEF9)
+CPU_HANDLER(BFTST_E8D0)
+CPU_HANDLER(BFTST_E8E8)
+CPU_HANDLER(BFTST_E8F0)
+CPU_HANDLER(BFTST_E8F8)
+CPU_HANDLER(BFTST_E8F9)
+CPU_HANDLER(BFTST_E8FA)
+CPU_HANDLER(BFTST_E8FB)
+CPU_HANDLER(BFCHG_EAC0)
+CPU_HANDLER(BFCLR_ECC0)
+CPU_HANDLER(BFEXTS_EBC0)
+CPU_HANDLER(BFEXTU_E9C0)
+CPU_HANDLER(BFFFO_EDC0)
+CPU_HANDLER(BFINS_EFC0)
+CPU_HANDLER(BFSET_EEC0)
+CPU_HANDLER(BFTST_E8C0)
+CPU_HANDLER(MULL_4C00)
+CPU_HANDLER(MULL_4C10)
+CPU_HANDLER(MULL_4C18)
+CPU_HANDLER(MULL_4C20)
+CPU_HANDLER(MULL_4C28)
+CPU_HANDLER(MULL_4C30)
+CPU_HANDLER(MULL_4C38)
+CPU_HANDLER(MULL_4C39)
+CPU_HANDLER(MULL_4C3A)
+CPU_HANDLER(MULL_4C3B)
+CPU_HANDLER(MULL_4C3C)
+CPU_HANDLER(MOVES_0E10)
+CPU_HANDLER(MOVES_0E18)
+CPU_HANDLER(MOVES_0E20)
+CPU_HANDLER(MOVES_0E28)
+CPU_HANDLER(MOVES_0E30)
+CPU_HANDLER(MOVES_0E38)
+CPU_HANDLER(MOVES_0E39)
+CPU_HANDLER(MOVES_0E50)
+CPU_HANDLER(MOVES_0E58)
+CPU_HANDLER(MOVES_0E60)
+CPU_HANDLER(MOVES_0E68)
+CPU_HANDLER(MOVES_0E70)
+CPU_HANDLER(MOVES_0E78)
+CPU_HANDLER(MOVES_0E79)
+CPU_HANDLER(MOVES_0E90)
+CPU_HANDLER(MOVES_0E98)
+CPU_HANDLER(MOVES_0EA0)
+CPU_HANDLER(MOVES_0EA8)
+CPU_HANDLER(MOVES_0EB0)
+CPU_HANDLER(MOVES_0EB8)
+CPU_HANDLER(MOVES_0EB9)
+CPU_HANDLER(NBCD_4800)
+CPU_HANDLER(NBCD_4810)
+CPU_HANDLER(NBCD_4818)
+CPU_HANDLER(NBCD_4820)
+CPU_HANDLER(NBCD_4828)
+CPU_HANDLER(NBCD_4830)
+CPU_HANDLER(NBCD_4838)
+CPU_HANDLER(NBCD_4839)
+CPU_HANDLER(NEG_4400)
+CPU_HANDLER(NEG_4410)
+CPU_HANDLER(NEG_4418)
+CPU_HANDLER(NEG_4420)
+CPU_HANDLER(NEG_4428)
+CPU_HANDLER(NEG_4430)
+CPU_HANDLER(NEG_4438)
+CPU_HANDLER(NEG_4439)
+CPU_HANDLER(NEG_4440)
+CPU_HANDLER(NEG_4450)
+CPU_HANDLER(NEG_4458)
+CPU_HANDLER(NEG_4460)
+CPU_HANDLER(NEG_4468)
+CPU_HANDLER(NEG_4470)
+CPU_HANDLER(NEG_4478)
+CPU_HANDLER(NEG_4479)
+CPU_HANDLER(NEG_4480)
+CPU_HANDLER(NEG_4490)
+CPU_HANDLER(NEG_4498)
+CPU_HANDLER(NEG_44A0)
+CPU_HANDLER(NEG_44A8)
+CPU_HANDLER(NEG_44B0)
+CPU_HANDLER(NEG_44B8)
+CPU_HANDLER(NEG_44B9)
+CPU_HANDLER(NEGX_4000)
+CPU_HANDLER(NEGX_4010)
+CPU_HANDLER(NEGX_4018)
+CPU_HANDLER(NEGX_4020)
+CPU_HANDLER(NEGX_4028)
+CPU_HANDLER(NEGX_4030)
+CPU_HANDLER(NEGX_4038)
+CPU_HANDLER(NEGX_4039)
+CPU_HANDLER(NEGX_4040)
+CPU_HANDLER(NEGX_4050)
+CPU_HANDLER(NEGX_4058)
+CPU_HANDLER(NEGX_4060)
+CPU_HANDLER(NEGX_4068)
+CPU_HANDLER(NEGX_4070)
+CPU_HANDLER(NEGX_4078)
+CPU_HANDLER(NEGX_4079)
+CPU_HANDLER(NEGX_4080)
+CPU_HANDLER(NEGX_4090)
+CPU_HANDLER(NEGX_4098)
+CPU_HANDLER(NEGX_40A0)
+CPU_HANDLER(NEGX_40A8)
+CPU_HANDLER(NEGX_40B0)
+CPU_HANDLER(NEGX_40B8)
+CPU_HANDLER(NEGX_40B9)
+CPU_HANDLER(NOT_4600)
+CPU_HANDLER(NOT_4610)
+CPU_HANDLER(NOT_4618)
+CPU_HANDLER(NOT_4620)
+CPU_HANDLER(NOT_4628)
+CPU_HANDLER(NOT_4630)
+CPU_HANDLER(NOT_4638)
+CPU_HANDLER(NOT_4639)
+CPU_HANDLER(NOT_4640)
+CPU_HANDLER(NOT_4650)
+CPU_HANDLER(NOT_4658)
+CPU_HANDLER(NOT_4660)
+CPU_HANDLER(NOT_4668)
+CPU_HANDLER(NOT_4670)
+CPU_HANDLER(NOT_4678)
+CPU_HANDLER(NOT_4679)
+CPU_HANDLER(NOT_4680)
+CPU_HANDLER(NOT_4690)
+CPU_HANDLER(NOT_4698)
+CPU_HANDLER(NOT_46A0)
+CPU_HANDLER(NOT_46A8)
+CPU_HANDLER(NOT_46B0)
+CPU_HANDLER(NOT_46B8)
+CPU_HANDLER(NOT_46B9)
+CPU_HANDLER(TAS_4AC0)
+CPU_HANDLER(TAS_4AD0)
+CPU_HANDLER(TAS_4AD8)
+CPU_HANDLER(TAS_4AE0)
+CPU_HANDLER(TAS_4AE8)
+CPU_HANDLER(TAS_4AF0)
+CPU_HANDLER(TAS_4AF8)
+CPU_HANDLER(TAS_4AF9)
+CPU_HANDLER(TST_4A00)
+CPU_HANDLER(TST_4A10)
+CPU_HANDLER(TST_4A18)
+CPU_HANDLER(TST_4A20)
+CPU_HANDLER(TST_4A28)
+CPU_HANDLER(TST_4A30)
+CPU_HANDLER(TST_4A38)
+CPU_HANDLER(TST_4A39)
+CPU_HANDLER(TST_4A40)
+CPU_HANDLER(TST_4A50)
+CPU_HANDLER(TST_4A58)
+CPU_HANDLER(TST_4A60)
+CPU_HANDLER(TST_4A68)
+CPU_HANDLER(TST_4A70)
+CPU_HANDLER(TST_4A78)
+CPU_HANDLER(TST_4A79)
+CPU_HANDLER(TST_4A80)
+CPU_HANDLER(TST_4A90)
+CPU_HANDLER(TST_4A98)
+CPU_HANDLER(TST_4AA0)
+CPU_HANDLER(TST_4AA8)
+CPU_HANDLER(TST_4AB0)
+CPU_HANDLER(TST_4AB8)
+CPU_HANDLER(TST_4AB9)
+CPU_HANDLER(TST_4A3A)
+CPU_HANDLER(TST_4A3B)
+CPU_HANDLER(TST_4A3C)
+CPU_HANDLER(TST_4A48)
+CPU_HANDLER(TST_4A7A)
+CPU_HANDLER(TST_4A7B)
+CPU_HANDLER(TST_4A7C)
+CPU_HANDLER(TST_4A88)
+CPU_HANDLER(TST_4ABA)
+CPU_HANDLER(TST_4ABB)
+CPU_HANDLER(TST_4ABC)
+CPU_HANDLER(PEA_4850)
+CPU_HANDLER(PEA_4868)
+CPU_HANDLER(PEA_4870)
+CPU_HANDLER(PEA_4878)
+CPU_HANDLER(PEA_4879)
+CPU_HANDLER(PEA_487A)
+CPU_HANDLER(PEA_487B)
+CPU_HANDLER(JMP_4ED0)
+CPU_HANDLER(JMP_4EE8)
+CPU_HANDLER(JMP_4EF0)
+CPU_HANDLER(JMP_4EF8)
+CPU_HANDLER(JMP_4EF9)
+CPU_HANDLER(JMP_4EFA)
+CPU_HANDLER(JMP_4EFB)
+CPU_HANDLER(JSR_4E90)
+CPU_HANDLER(JSR_4EA8)
+CPU_HANDLER(JSR_4EB0)
+CPU_HANDLER(JSR_4EB8)
+CPU_HANDLER(JSR_4EB9)
+CPU_HANDLER(JSR_4EBA)
+CPU_HANDLER(JSR_4EBB)
+CPU_HANDLER(MOVETOSR_46C0)
+CPU_HANDLER(MOVETOSR_46D0)
+CPU_HANDLER(MOVETOSR_46D8)
+CPU_HANDLER(MOVETOSR_46E0)
+CPU_HANDLER(MOVETOSR_46E8)
+CPU_HANDLER(MOVETOSR_46F0)
+CPU_HANDLER(MOVETOSR_46F8)
+CPU_HANDLER(MOVETOSR_46F9)
+CPU_HANDLER(MOVETOSR_46FA)
+CPU_HANDLER(MOVETOSR_46FB)
+CPU_HANDLER(MOVETOSR_46FC)
+CPU_HANDLER(MOVETOCCR_44C0)
+CPU_HANDLER(MOVETOCCR_44D0)
+CPU_HANDLER(MOVETOCCR_44D8)
+CPU_HANDLER(MOVETOCCR_44E0)
+CPU_HANDLER(MOVETOCCR_44E8)
+CPU_HANDLER(MOVETOCCR_44F0)
+CPU_HANDLER(MOVETOCCR_44F8)
+CPU_HANDLER(MOVETOCCR_44F9)
+CPU_HANDLER(MOVETOCCR_44FA)
+CPU_HANDLER(MOVETOCCR_44FB)
+CPU_HANDLER(MOVETOCCR_44FC)
+CPU_HANDLER(SCC_50C0)
+CPU_HANDLER(SCC_50D0)
+CPU_HANDLER(SCC_50D8)
+CPU_HANDLER(SCC_50E0)
+CPU_HANDLER(SCC_50E8)
+CPU_HANDLER(SCC_50F0)
+CPU_HANDLER(SCC_50F8)
+CPU_HANDLER(SCC_50F9)
+CPU_HANDLER(MOVEFROMCCR_42C0)
+CPU_HANDLER(MOVEFROMCCR_42D0)
+CPU_HANDLER(MOVEFROMCCR_42D8)
+CPU_HANDLER(MOVEFROMCCR_42E0)
+CPU_HANDLER(MOVEFROMCCR_42E8)
+CPU_HANDLER(MOVEFROMCCR_42F0)
+CPU_HANDLER(MOVEFROMCCR_42F8)
+CPU_HANDLER(MOVEFROMCCR_42F9)
+CPU_HANDLER(MOVEFROMSR_40C0)
+CPU_HANDLER(MOVEFROMSR_40D0)
+CPU_HANDLER(MOVEFROMSR_40D8)
+CPU_HANDLER(MOVEFROMSR_40E0)
+CPU_HANDLER(MOVEFROMSR_40E8)
+CPU_HANDLER(MOVEFROMSR_40F0)
+CPU_HANDLER(MOVEFROMSR_40F8)
+CPU_HANDLER(MOVEFROMSR_40F9)
+CPU_HANDLER(CAS_0AD0)
+CPU_HANDLER(CAS_0AD8)
+CPU_HANDLER(CAS_0AE0)
+CPU_HANDLER(CAS_0AE8)
+CPU_HANDLER(CAS_0AF0)
+CPU_HANDLER(CAS_0AF8)
+CPU_HANDLER(CAS_0AF9)
+CPU_HANDLER(CAS_0CD0)
+CPU_HANDLER(CAS_0CD8)
+CPU_HANDLER(CAS_0CE0)
+CPU_HANDLER(CAS_0CE8)
+CPU_HANDLER(CAS_0CF0)
+CPU_HANDLER(CAS_0CF8)
+CPU_HANDLER(CAS_0CF9)
+CPU_HANDLER(CAS_0ED0)
+CPU_HANDLER(CAS_0ED8)
+CPU_HANDLER(CAS_0EE0)
+CPU_HANDLER(CAS_0EE8)
+CPU_HANDLER(CAS_0EF0)
+CPU_HANDLER(CAS_0EF8)
+CPU_HANDLER(CAS_0EF9)
+CPU_HANDLER(CHKCMP2_00D0)
+CPU_HANDLER(CHKCMP2_00E8)
+CPU_HANDLER(CHKCMP2_00F0)
+CPU_HANDLER(CHKCMP2_00F8)
+CPU_HANDLER(CHKCMP2_00F9)
+CPU_HANDLER(CHKCMP2_00FA)
+CPU_HANDLER(CHKCMP2_00FB)
+CPU_HANDLER(CHKCMP2_02D0)
+CPU_HANDLER(CHKCMP2_02E8)
+CPU_HANDLER(CHKCMP2_02F0)
+CPU_HANDLER(CHKCMP2_02F8)
+CPU_HANDLER(CHKCMP2_02F9)
+CPU_HANDLER(CHKCMP2_02FA)
+CPU_HANDLER(CHKCMP2_02FB)
+CPU_HANDLER(CHKCMP2_04D0)
+CPU_HANDLER(CHKCMP2_04E8)
+CPU_HANDLER(CHKCMP2_04F0)
+CPU_HANDLER(CHKCMP2_04F8)
+CPU_HANDLER(CHKCMP2_04F9)
+CPU_HANDLER(CHKCMP2_04FA)
+CPU_HANDLER(CHKCMP2_04FB)
+CPU_HANDLER(CALLM_06D0)
+CPU_HANDLER(CALLM_06E8)
+CPU_HANDLER(CALLM_06F0)
+CPU_HANDLER(CALLM_06F8)
+CPU_HANDLER(CALLM_06F9)
+CPU_HANDLER(CALLM_06FA)
+CPU_HANDLER(CALLM_06FB)
+CPU_HANDLER(PFLUSH030_F010)
+CPU_HANDLER(PFLUSH030_F028)
+CPU_HANDLER(PFLUSH030_F030)
+CPU_HANDLER(PFLUSH030_F038)
+CPU_HANDLER(PFLUSH030_F039)
+CPU_HANDLER(MOVEQ_7000)
+CPU_HANDLER(MOVE_1000)
+CPU_HANDLER(MOVE_1010)
+CPU_HANDLER(MOVE_1018)
+CPU_HANDLER(MOVE_1020)
+CPU_HANDLER(MOVE_1028)
+CPU_HANDLER(MOVE_1030)
+CPU_HANDLER(MOVE_1038)
+CPU_HANDLER(MOVE_1039)
+CPU_HANDLER(MOVE_103A)
+CPU_HANDLER(MOVE_103B)
+CPU_HANDLER(MOVE_103C)
+CPU_HANDLER(MOVE_1080)
+CPU_HANDLER(MOVE_1090)
+CPU_HANDLER(MOVE_1098)
+CPU_HANDLER(MOVE_10A0)
+CPU_HANDLER(MOVE_10A8)
+CPU_HANDLER(MOVE_10B0)
+CPU_HANDLER(MOVE_10B8)
+CPU_HANDLER(MOVE_10B9)
+CPU_HANDLER(MOVE_10BA)
+CPU_HANDLER(MOVE_10BB)
+CPU_HANDLER(MOVE_10BC)
+CPU_HANDLER(MOVE_10C0)
+CPU_HANDLER(MOVE_10D0)
+CPU_HANDLER(MOVE_10D8)
+CPU_HANDLER(MOVE_10E0)
+CPU_HANDLER(MOVE_10E8)
+CPU_HANDLER(MOVE_10F0)
+CPU_HANDLER(MOVE_10F8)
+CPU_HANDLER(MOVE_10F9)
+CPU_HANDLER(MOVE_10FA)
+CPU_HANDLER(MOVE_10FB)
+CPU_HANDLER(MOVE_10FC)
+CPU_HANDLER(MOVE_1100)
+CPU_HANDLER(MOVE_1110)
+CPU_HANDLER(MOVE_1118)
+CPU_HANDLER(MOVE_1120)
+CPU_HANDLER(MOVE_1128)
+CPU_HANDLER(MOVE_1130)
+CPU_HANDLER(MOVE_1138)
+CPU_HANDLER(MOVE_1139)
+CPU_HANDLER(MOVE_113A)
+CPU_HANDLER(MOVE_113B)
+CPU_HANDLER(MOVE_113C)
+CPU_HANDLER(MOVE_1140)
+CPU_HANDLER(MOVE_1150)
+CPU_HANDLER(MOVE_1158)
+CPU_HANDLER(MOVE_1160)
+CPU_HANDLER(MOVE_1168)
+CPU_HANDLER(MOVE_1170)
+CPU_HANDLER(MOVE_1178)
+CPU_HANDLER(MOVE_1179)
+CPU_HANDLER(MOVE_117A)
+CPU_HANDLER(MOVE_117B)
+CPU_HANDLER(MOVE_117C)
+CPU_HANDLER(MOVE_1180)
+CPU_HANDLER(MOVE_1190)
+CPU_HANDLER(MOVE_1198)
+CPU_HANDLER(MOVE_11A0)
+CPU_HANDLER(MOVE_11A8)
+CPU_HANDLER(MOVE_11B0)
+CPU_HANDLER(MOVE_11B8)
+CPU_HANDLER(MOVE_11B9)
+CPU_HANDLER(MOVE_11BA)
+CPU_HANDLER(MOVE_11BB)
+CPU_HANDLER(MOVE_11BC)
+CPU_HANDLER(MOVE_11C0)
+CPU_HANDLER(MOVE_11D0)
+CPU_HANDLER(MOVE_11D8)
+CPU_HANDLER(MOVE_11E0)
+CPU_HANDLER(MOVE_11E8)
+CPU_HANDLER(MOVE_11F0)
+CPU_HANDLER(MOVE_11F8)
+CPU_HANDLER(MOVE_11F9)
+CPU_HANDLER(MOVE_11FA)
+CPU_HANDLER(MOVE_11FB)
+CPU_HANDLER(MOVE_11FC)
+CPU_HANDLER(MOVE_13C0)
+CPU_HANDLER(MOVE_13D0)
+CPU_HANDLER(MOVE_13D8)
+CPU_HANDLER(MOVE_13E0)
+CPU_HANDLER(MOVE_13E8)
+CPU_HANDLER(MOVE_13F0)
+CPU_HANDLER(MOVE_13F8)
+CPU_HANDLER(MOVE_13F9)
+CPU_HANDLER(MOVE_13FA)
+CPU_HANDLER(MOVE_13FB)
+CPU_HANDLER(MOVE_13FC)
+CPU_HANDLER(MOVE_3000)
+CPU_HANDLER(MOVE_3008)
+CPU_HANDLER(MOVE_3010)
+CPU_HANDLER(MOVE_3018)
+CPU_HANDLER(MOVE_3020)
+CPU_HANDLER(MOVE_3028)
+CPU_HANDLER(MOVE_3030)
+CPU_HANDLER(MOVE_3038)
+CPU_HANDLER(MOVE_3039)
+CPU_HANDLER(MOVE_303A)
+CPU_HANDLER(MOVE_303B)
+CPU_HANDLER(MOVE_303C)
+CPU_HANDLER(MOVE_3080)
+CPU_HANDLER(MOVE_3088)
+CPU_HANDLER(MOVE_3090)
+CPU_HANDLER(MOVE_3098)
+CPU_HANDLER(MOVE_30A0)
+CPU_HANDLER(MOVE_30A8)
+CPU_HANDLER(MOVE_30B0)
+CPU_HANDLER(MOVE_30B8)
+CPU_HANDLER(MOVE_30B9)
+CPU_HANDLER(MOVE_30BA)
+CPU_HANDLER(MOVE_30BB)
+CPU_HANDLER(MOVE_30BC)
+CPU_HANDLER(MOVE_30C0)
+CPU_HANDLER(MOVE_30C8)
+CPU_HANDLER(MOVE_30D0)
+CPU_HANDLER(MOVE_30D8)
+CPU_HANDLER(MOVE_30E0)
+CPU_HANDLER(MOVE_30E8)
+CPU_HANDLER(MOVE_30F0)
+CPU_HANDLER(MOVE_30F8)
+CPU_HANDLER(MOVE_30F9)
+CPU_HANDLER(MOVE_30FA)
+CPU_HANDLER(MOVE_30FB)
+CPU_HANDLER(MOVE_30FC)
+CPU_HANDLER(MOVE_3100)
+CPU_HANDLER(MOVE_3108)
+CPU_HANDLER(MOVE_3110)
+CPU_HANDLER(MOVE_3118)
+CPU_HANDLER(MOVE_3120)
+CPU_HANDLER(MOVE_3128)
+CPU_HANDLER(MOVE_3130)
+CPU_HANDLER(MOVE_3138)
+CPU_HANDLER(MOVE_3139)
+CPU_HANDLER(MOVE_313A)
+CPU_HANDLER(MOVE_313B)
+CPU_HANDLER(MOVE_313C)
+CPU_HANDLER(MOVE_3140)
+CPU_HANDLER(MOVE_3148)
+CPU_HANDLER(MOVE_3150)
+CPU_HANDLER(MOVE_3158)
+CPU_HANDLER(MOVE_3160)
+CPU_HANDLER(MOVE_3168)
+CPU_HANDLER(MOVE_3170)
+CPU_HANDLER(MOVE_3178)
+CPU_HANDLER(MOVE_3179)
+CPU_HANDLER(MOVE_317A)
+CPU_HANDLER(MOVE_317B)
+CPU_HANDLER(MOVE_317C)
+CPU_HANDLER(MOVE_3180)
+CPU_HANDLER(MOVE_3188)
+CPU_HANDLER(MOVE_3190)
+CPU_HANDLER(MOVE_3198)
+CPU_HANDLER(MOVE_31A0)
+CPU_HANDLER(MOVE_31A8)
+CPU_HANDLER(MOVE_31B0)
+CPU_HANDLER(MOVE_31B8)
+CPU_HANDLER(MOVE_31B9)
+CPU_HANDLER(MOVE_31BA)
+CPU_HANDLER(MOVE_31BB)
+CPU_HANDLER(MOVE_31BC)
+CPU_HANDLER(MOVE_31C0)
+CPU_HANDLER(MOVE_31C8)
+CPU_HANDLER(MOVE_31D0)
+CPU_HANDLER(MOVE_31D8)
+CPU_HANDLER(MOVE_31E0)
+CPU_HANDLER(MOVE_31E8)
+CPU_HANDLER(MOVE_31F0)
+CPU_HANDLER(MOVE_31F8)
+CPU_HANDLER(MOVE_31F9)
+CPU_HANDLER(MOVE_31FA)
+CPU_HANDLER(MOVE_31FB)
+CPU_HANDLER(MOVE_31FC)
+CPU_HANDLER(MOVE_33C0)
+CPU_HANDLER(MOVE_33C8)
+CPU_HANDLER(MOVE_33D0)
+CPU_HANDLER(MOVE_33D8)
+CPU_HANDLER(MOVE_33E0)
+CPU_HANDLER(MOVE_33E8)
+CPU_HANDLER(MOVE_33F0)
+CPU_HANDLER(MOVE_33F8)
+CPU_HANDLER(MOVE_33F9)
+CPU_HANDLER(MOVE_33FA)
+CPU_HANDLER(MOVE_33FB)
+CPU_HANDLER(MOVE_33FC)
+CPU_HANDLER(MOVE_2000)
+CPU_HANDLER(MOVE_2008)
+CPU_HANDLER(MOVE_2010)
+CPU_HANDLER(MOVE_2018)
+CPU_HANDLER(MOVE_2020)
+CPU_HANDLER(MOVE_2028)
+CPU_HANDLER(MOVE_2030)
+CPU_HANDLER(MOVE_2038)
+CPU_HANDLER(MOVE_2039)
+CPU_HANDLER(MOVE_203A)
+CPU_HANDLER(MOVE_203B)
+CPU_HANDLER(MOVE_203C)
+CPU_HANDLER(MOVE_2080)
+CPU_HANDLER(MOVE_2088)
+CPU_HANDLER(MOVE_2090)
+CPU_HANDLER(MOVE_2098)
+CPU_HANDLER(MOVE_20A0)
+CPU_HANDLER(MOVE_20A8)
+CPU_HANDLER(MOVE_20B0)
+CPU_HANDLER(MOVE_20B8)
+CPU_HANDLER(MOVE_20B9)
+CPU_HANDLER(MOVE_20BA)
+CPU_HANDLER(MOVE_20BB)
+CPU_HANDLER(MOVE_20BC)
+CPU_HANDLER(MOVE_20C0)
+CPU_HANDLER(MOVE_20C8)
+CPU_HANDLER(MOVE_20D0)
+CPU_HANDLER(MOVE_20D8)
+CPU_HANDLER(MOVE_20E0)
+CPU_HANDLER(MOVE_20E8)
+CPU_HANDLER(MOVE_20F0)
+CPU_HANDLER(MOVE_20F8)
+CPU_HANDLER(MOVE_20F9)
+CPU_HANDLER(MOVE_20FA)
+CPU_HANDLER(MOVE_20FB)
+CPU_HANDLER(MOVE_20FC)
+CPU_HANDLER(MOVE_2100)
+CPU_HANDLER(MOVE_2108)
+CPU_HANDLER(MOVE_2110)
+CPU_HANDLER(MOVE_2118)
+CPU_HANDLER(MOVE_2120)
+CPU_HANDLER(MOVE_2128)
+CPU_HANDLER(MOVE_2130)
+CPU_HANDLER(MOVE_2138)
+CPU_HANDLER(MOVE_2139)
+CPU_HANDLER(MOVE_213A)
+CPU_HANDLER(MOVE_213B)
+CPU_HANDLER(MOVE_213C)
+CPU_HANDLER(MOVE_2140)
+CPU_HANDLER(MOVE_2148)
+CPU_HANDLER(MOVE_2150)
+CPU_HANDLER(MOVE_2158)
+CPU_HANDLER(MOVE_2160)
+CPU_HANDLER(MOVE_2168)
+CPU_HANDLER(MOVE_2170)
+CPU_HANDLER(MOVE_2178)
+CPU_HANDLER(MOVE_2179)
+CPU_HANDLER(MOVE_217A)
+CPU_HANDLER(MOVE_217B)
+CPU_HANDLER(MOVE_217C)
+CPU_HANDLER(MOVE_2180)
+CPU_HANDLER(MOVE_2188)
+CPU_HANDLER(MOVE_2190)
+CPU_HANDLER(MOVE_2198)
+CPU_HANDLER(MOVE_21A0)
+CPU_HANDLER(MOVE_21A8)
+CPU_HANDLER(MOVE_21B0)
+CPU_HANDLER(MOVE_21B8)
+CPU_HANDLER(MOVE_21B9)
+CPU_HANDLER(MOVE_21BA)
+CPU_HANDLER(MOVE_21BB)
+CPU_HANDLER(MOVE_21BC)
+CPU_HANDLER(MOVE_21C0)
+CPU_HANDLER(MOVE_21C8)
+CPU_HANDLER(MOVE_21D0)
+CPU_HANDLER(MOVE_21D8)
+CPU_HANDLER(MOVE_21E0)
+CPU_HANDLER(MOVE_21E8)
+CPU_HANDLER(MOVE_21F0)
+CPU_HANDLER(MOVE_21F8)
+CPU_HANDLER(MOVE_21F9)
+CPU_HANDLER(MOVE_21FA)
+CPU_HANDLER(MOVE_21FB)
+CPU_HANDLER(MOVE_21FC)
+CPU_HANDLER(MOVE_23C0)
+CPU_HANDLER(MOVE_23C8)
+CPU_HANDLER(MOVE_23D0)
+CPU_HANDLER(MOVE_23D8)
+CPU_HANDLER(MOVE_23E0)
+CPU_HANDLER(MOVE_23E8)
+CPU_HANDLER(MOVE_23F0)
+CPU_HANDLER(MOVE_23F8)
+CPU_HANDLER(MOVE_23F9)
+CPU_HANDLER(MOVE_23FA)
+CPU_HANDLER(MOVE_23FB)
+CPU_HANDLER(MOVE_23FC)
+CPU_HANDLER(MOVEA_3040)
+CPU_HANDLER(MOVEA_3048)
+CPU_HANDLER(MOVEA_3050)
+CPU_HANDLER(MOVEA_3058)
+CPU_HANDLER(MOVEA_3060)
+CPU_HANDLER(MOVEA_3068)
+CPU_HANDLER(MOVEA_3070)
+CPU_HANDLER(MOVEA_3078)
+CPU_HANDLER(MOVEA_3079)
+CPU_HANDLER(MOVEA_307A)
+CPU_HANDLER(MOVEA_307B)
+CPU_HANDLER(MOVEA_307C)
+CPU_HANDLER(MOVEA_2040)
+CPU_HANDLER(MOVEA_2048)
+CPU_HANDLER(MOVEA_2050)
+CPU_HANDLER(MOVEA_2058)
+CPU_HANDLER(MOVEA_2060)
+CPU_HANDLER(MOVEA_2068)
+CPU_HANDLER(MOVEA_2070)
+CPU_HANDLER(MOVEA_2078)
+CPU_HANDLER(MOVEA_2079)
+CPU_HANDLER(MOVEA_207A)
+CPU_HANDLER(MOVEA_207B)
+CPU_HANDLER(MOVEA_207C)
+CPU_HANDLER(BCCB_6200)
+CPU_HANDLER(BCCB_6300)
+CPU_HANDLER(BCCB_6400)
+CPU_HANDLER(BCCB_6500)
+CPU_HANDLER(BCCB_6600)
+CPU_HANDLER(BCCB_6700)
+CPU_HANDLER(BCCB_6800)
+CPU_HANDLER(BCCB_6900)
+CPU_HANDLER(BCCB_6A00)
+CPU_HANDLER(BCCB_6B00)
+CPU_HANDLER(BCCB_6C00)
+CPU_HANDLER(BCCB_6D00)
+CPU_HANDLER(BCCB_6E00)
+CPU_HANDLER(BCCB_6F00)
+CPU_HANDLER(BCCW_6200)
+CPU_HANDLER(BCCW_6300)
+CPU_HANDLER(BCCW_6400)
+CPU_HANDLER(BCCW_6500)
+CPU_HANDLER(BCCW_6600)
+CPU_HANDLER(BCCW_6700)
+CPU_HANDLER(BCCW_6800)
+CPU_HANDLER(BCCW_6900)
+CPU_HANDLER(BCCW_6A00)
+CPU_HANDLER(BCCW_6B00)
+CPU_HANDLER(BCCW_6C00)
+CPU_HANDLER(BCCW_6D00)
+CPU_HANDLER(BCCW_6E00)
+CPU_HANDLER(BCCW_6F00)
+CPU_HANDLER(BCCL_62FF)
+CPU_HANDLER(BCCL_63FF)
+CPU_HANDLER(BCCL_64FF)
+CPU_HANDLER(BCCL_65FF)
+CPU_HANDLER(BCCL_66FF)
+CPU_HANDLER(BCCL_67FF)
+CPU_HANDLER(BCCL_68FF)
+CPU_HANDLER(BCCL_69FF)
+CPU_HANDLER(BCCL_6AFF)
+CPU_HANDLER(BCCL_6BFF)
+CPU_HANDLER(BCCL_6CFF)
+CPU_HANDLER(BCCL_6DFF)
+CPU_HANDLER(BCCL_6EFF)
+CPU_HANDLER(BCCL_6FFF)
+CPU_HANDLER(BKPT_4848)
+CPU_HANDLER(EXG_C140)
+CPU_HANDLER(EXG_C148)
+CPU_HANDLER(EXG_C188)
+CPU_HANDLER(EXT_4880)
+CPU_HANDLER(EXT_48C0)
+CPU_HANDLER(EXT_49C0)
+CPU_HANDLER(SWAP_4840)
+CPU_HANDLER(LINK_4E50)
+CPU_HANDLER(LINK_4808)
+CPU_HANDLER(UNLK_4E58)
+CPU_HANDLER(BRAB_6000)
+CPU_HANDLER(BRAW_6000)
+CPU_HANDLER(BRAL_60FF)
+CPU_HANDLER(BSRB_6100)
+CPU_HANDLER(BSRW_6100)
+CPU_HANDLER(BSRL_61FF)
+CPU_HANDLER(DBCC_50C8)
+CPU_HANDLER(DBCC_51C8)
+CPU_HANDLER(DBCC_52C8)
+CPU_HANDLER(DBCC_53C8)
+CPU_HANDLER(DBCC_54C8)
+CPU_HANDLER(DBCC_55C8)
+CPU_HANDLER(DBCC_56C8)
+CPU_HANDLER(DBCC_57C8)
+CPU_HANDLER(DBCC_58C8)
+CPU_HANDLER(DBCC_59C8)
+CPU_HANDLER(DBCC_5AC8)
+CPU_HANDLER(DBCC_5BC8)
+CPU_HANDLER(DBCC_5CC8)
+CPU_HANDLER(DBCC_5DC8)
+CPU_HANDLER(DBCC_5EC8)
+CPU_HANDLER(DBCC_5FC8)
+CPU_HANDLER(TRAPCC_50FC)
+CPU_HANDLER(TRAPCC_51FC)
+CPU_HANDLER(TRAPCC_52FC)
+CPU_HANDLER(TRAPCC_53FC)
+CPU_HANDLER(TRAPCC_54FC)
+CPU_HANDLER(TRAPCC_55FC)
+CPU_HANDLER(TRAPCC_56FC)
+CPU_HANDLER(TRAPCC_57FC)
+CPU_HANDLER(TRAPCC_58FC)
+CPU_HANDLER(TRAPCC_59FC)
+CPU_HANDLER(TRAPCC_5AFC)
+CPU_HANDLER(TRAPCC_5BFC)
+CPU_HANDLER(TRAPCC_5CFC)
+CPU_HANDLER(TRAPCC_5DFC)
+CPU_HANDLER(TRAPCC_5EFC)
+CPU_HANDLER(TRAPCC_5FFC)
+CPU_HANDLER(TRAPCC_50FA)
+CPU_HANDLER(TRAPCC_51FA)
+CPU_HANDLER(TRAPCC_52FA)
+CPU_HANDLER(TRAPCC_53FA)
+CPU_HANDLER(TRAPCC_54FA)
+CPU_HANDLER(TRAPCC_55FA)
+CPU_HANDLER(TRAPCC_56FA)
+CPU_HANDLER(TRAPCC_57FA)
+CPU_HANDLER(TRAPCC_58FA)
+CPU_HANDLER(TRAPCC_59FA)
+CPU_HANDLER(TRAPCC_5AFA)
+CPU_HANDLER(TRAPCC_5BFA)
+CPU_HANDLER(TRAPCC_5CFA)
+CPU_HANDLER(TRAPCC_5DFA)
+CPU_HANDLER(TRAPCC_5EFA)
+CPU_HANDLER(TRAPCC_5FFA)
+CPU_HANDLER(TRAPCC_50FB)
+CPU_HANDLER(TRAPCC_51FB)
+CPU_HANDLER(TRAPCC_52FB)
+CPU_HANDLER(TRAPCC_53FB)
+CPU_HANDLER(TRAPCC_54FB)
+CPU_HANDLER(TRAPCC_55FB)
+CPU_HANDLER(TRAPCC_56FB)
+CPU_HANDLER(TRAPCC_57FB)
+CPU_HANDLER(TRAPCC_58FB)
+CPU_HANDLER(TRAPCC_59FB)
+CPU_HANDLER(TRAPCC_5AFB)
+CPU_HANDLER(TRAPCC_5BFB)
+CPU_HANDLER(TRAPCC_5CFB)
+CPU_HANDLER(TRAPCC_5DFB)
+CPU_HANDLER(TRAPCC_5EFB)
+CPU_HANDLER(TRAPCC_5FFB)
+CPU_HANDLER(RTD_4E74)
+CPU_HANDLER(RTE_4E73)
+CPU_HANDLER(RTS_4E75)
+CPU_HANDLER(RTR_4E77)
+CPU_HANDLER(NOP_4E71)
+CPU_HANDLER(MOVEC_4E7A)
+CPU_HANDLER(MOVEC_4E7B)
+CPU_HANDLER(CAS2_0CFC)
+CPU_HANDLER(CAS2_0EFC)
+CPU_HANDLER(TRAP_4E40)
+CPU_HANDLER(TRAPV_4E76)
+CPU_HANDLER(STOP_4E72)
+CPU_HANDLER(RESET_4E70)
+CPU_HANDLER(MOVEUSP_4E60)
+CPU_HANDLER(MOVEUSP_4E68)
+CPU_HANDLER(CMPM_B108)
+CPU_HANDLER(CMPM_B148)
+CPU_HANDLER(CMPM_B188)
+CPU_HANDLER(RTM_06C0)
+CPU_HANDLER(PFLUSH040_F500)
+CPU_HANDLER(PTEST040_F548)
+CPU_HANDLER(ADDX_D100)
+CPU_HANDLER(ADDX_D140)
+CPU_HANDLER(ADDX_D180)
+CPU_HANDLER(ADDX_D108)
+CPU_HANDLER(ADDX_D148)
+CPU_HANDLER(ADDX_D188)
+CPU_HANDLER(SUBX_9100)
+CPU_HANDLER(SUBX_9140)
+CPU_HANDLER(SUBX_9180)
+CPU_HANDLER(SUBX_9108)
+CPU_HANDLER(SUBX_9148)
+CPU_HANDLER(SUBX_9188)
+CPU_HANDLER(ABCD_C100)
+CPU_HANDLER(ABCD_C108)
+CPU_HANDLER(SBCD_8100)
+CPU_HANDLER(SBCD_8108)
+CPU_HANDLER(LSL_E108)
+CPU_HANDLER(LSL_E148)
+CPU_HANDLER(LSL_E188)
+CPU_HANDLER(LSL_E128)
+CPU_HANDLER(LSL_E168)
+CPU_HANDLER(LSL_E1A8)
+CPU_HANDLER(LSL_E3D0)
+CPU_HANDLER(LSL_E3D8)
+CPU_HANDLER(LSL_E3E0)
+CPU_HANDLER(LSL_E3E8)
+CPU_HANDLER(LSL_E3F0)
+CPU_HANDLER(LSL_E3F8)
+CPU_HANDLER(LSL_E3F9)
+CPU_HANDLER(LSR_E008)
+CPU_HANDLER(LSR_E048)
+CPU_HANDLER(LSR_E088)
+CPU_HANDLER(LSR_E028)
+CPU_HANDLER(LSR_E068)
+CPU_HANDLER(LSR_E0A8)
+CPU_HANDLER(LSR_E2D0)
+CPU_HANDLER(LSR_E2D8)
+CPU_HANDLER(LSR_E2E0)
+CPU_HANDLER(LSR_E2E8)
+CPU_HANDLER(LSR_E2F0)
+CPU_HANDLER(LSR_E2F8)
+CPU_HANDLER(LSR_E2F9)
+CPU_HANDLER(ASL_E100)
+CPU_HANDLER(ASL_E140)
+CPU_HANDLER(ASL_E180)
+CPU_HANDLER(ASL_E120)
+CPU_HANDLER(ASL_E160)
+CPU_HANDLER(ASL_E1A0)
+CPU_HANDLER(ASL_E1D0)
+CPU_HANDLER(ASL_E1D8)
+CPU_HANDLER(ASL_E1E0)
+CPU_HANDLER(ASL_E1E8)
+CPU_HANDLER(ASL_E1F0)
+CPU_HANDLER(ASL_E1F8)
+CPU_HANDLER(ASL_E1F9)
+CPU_HANDLER(ASR_E000)
+CPU_HANDLER(ASR_E040)
+CPU_HANDLER(ASR_E080)
+CPU_HANDLER(ASR_E020)
+CPU_HANDLER(ASR_E060)
+CPU_HANDLER(ASR_E0A0)
+CPU_HANDLER(ASR_E0D0)
+CPU_HANDLER(ASR_E0D8)
+CPU_HANDLER(ASR_E0E0)
+CPU_HANDLER(ASR_E0E8)
+CPU_HANDLER(ASR_E0F0)
+CPU_HANDLER(ASR_E0F8)
+CPU_HANDLER(ASR_E0F9)
+CPU_HANDLER(ROL_E118)
+CPU_HANDLER(ROL_E158)
+CPU_HANDLER(ROL_E198)
+CPU_HANDLER(ROL_E138)
+CPU_HANDLER(ROL_E178)
+CPU_HANDLER(ROL_E1B8)
+CPU_HANDLER(ROL_E7D0)
+CPU_HANDLER(ROL_E7D8)
+CPU_HANDLER(ROL_E7E0)
+CPU_HANDLER(ROL_E7E8)
+CPU_HANDLER(ROL_E7F0)
+CPU_HANDLER(ROL_E7F8)
+CPU_HANDLER(ROL_E7F9)
+CPU_HANDLER(ROR_E018)
+CPU_HANDLER(ROR_E058)
+CPU_HANDLER(ROR_E098)
+CPU_HANDLER(ROR_E038)
+CPU_HANDLER(ROR_E078)
+CPU_HANDLER(ROR_E0B8)
+CPU_HANDLER(ROR_E6D0)
+CPU_HANDLER(ROR_E6D8)
+CPU_HANDLER(ROR_E6E0)
+CPU_HANDLER(ROR_E6E8)
+CPU_HANDLER(ROR_E6F0)
+CPU_HANDLER(ROR_E6F8)
+CPU_HANDLER(ROR_E6F9)
+CPU_HANDLER(ROXL_E110)
+CPU_HANDLER(ROXL_E150)
+CPU_HANDLER(ROXL_E190)
+CPU_HANDLER(ROXL_E130)
+CPU_HANDLER(ROXL_E170)
+CPU_HANDLER(ROXL_E1B0)
+CPU_HANDLER(ROXL_E5D0)
+CPU_HANDLER(ROXL_E5D8)
+CPU_HANDLER(ROXL_E5E0)
+CPU_HANDLER(ROXL_E5E8)
+CPU_HANDLER(ROXL_E5F0)
+CPU_HANDLER(ROXL_E5F8)
+CPU_HANDLER(ROXL_E5F9)
+CPU_HANDLER(ROXR_E010)
+CPU_HANDLER(ROXR_E050)
+CPU_HANDLER(ROXR_E090)
+CPU_HANDLER(ROXR_E030)
+CPU_HANDLER(ROXR_E070)
+CPU_HANDLER(ROXR_E0B0)
+CPU_HANDLER(ROXR_E4D0)
+CPU_HANDLER(ROXR_E4D8)
+CPU_HANDLER(ROXR_E4E0)
+CPU_HANDLER(ROXR_E4E8)
+CPU_HANDLER(ROXR_E4F0)
+CPU_HANDLER(ROXR_E4F8)
+CPU_HANDLER(ROXR_E4F9)
+CPU_HANDLER(MOVEP_0188)
+CPU_HANDLER(MOVEP_01C8)
+CPU_HANDLER(MOVEP_0108)
+CPU_HANDLER(MOVEP_0148)
+CPU_HANDLER(PACK_8140)
+CPU_HANDLER(PACK_8148)
+CPU_HANDLER(UNPK_8180)
+CPU_HANDLER(UNPK_8188)
@@ -22,6 +22,8 @@
 /* Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.          */
 /*=========================================================================*/
 
+#include <stdlib.h>
+
 #include "defs.h"
 #include "CpuModule_Memory.h"
 #include "CpuModule.h"
@@ -176,6 +178,22 @@ static void cpuIllegalInstruction(uint32_t *opcode_data)
   cpuIllegal(); 
 }
 
+/// <summary>
+/// MPW -- A-line opcode (toolbox trap).  The trap word is the opcode.
+/// </summary>
+static void cpuALine(uint32_t *opcode_data)
+{
+  cpuALineTrap(memoryReadWord(cpuGetOriginalPC()));
+}
+
+/// <summary>
+/// MPW -- F-line opcode that isn't an instruction on this model (MPW trap).
+/// </summary>
+static void cpuFLine(uint32_t *opcode_data)
+{
+  cpuFLineTrap(memoryReadWord(cpuGetOriginalPC()));
+}
+
 /// <summary>
 /// BKPT
 /// </summary>
@@ -191,7 +209,7 @@ static void cpuBkpt(uint32_t vector)
 static uint8_t cpuAddB(uint8_t src2, uint8_t src1)
 {
   uint8_t res = src2 + src1;
-  cpuSetFlagsAdd(cpuIsZeroB(res), cpuMsbB(res), cpuMsbB(src2), cpuMsbB(src1));
+  cpuSetFlagsAddB(res, src2, src1);
   return res;
 }
 
@@ -202,7 +220,7 @@ static uint8_t cpuAddB(uint8_t src2, uint8_t src1)
 static uint16_t cpuAddW(uint16_t src2, uint16_t src1)
 {
   uint16_t res = src2 + src1;
-  cpuSetFlagsAdd(cpuIsZeroW(res), cpuMsbW(res), cpuMsbW(src2), cpuMsbW(src1));
+  cpuSetFlagsAddW(res, src2, src1);
   return res;
 }
 
@@ -213,7 +231,7 @@ static uint16_t cpuAddW(uint16_t src2, uint16_t src1)
 static uint32_t cpuAddL(uint32_t src2, uint32_t src1)
 {
   uint32_t res = src2 + src1;
-  cpuSetFlagsAdd(cpuIsZeroL(res), cpuMsbL(res), cpuMsbL(src2), cpuMsbL(src1));
+  cpuSetFlagsAddL(res, src2, src1);
   return res;
 }
 
@@ -242,7 +260,7 @@ static uint32_t cpuAddaL(uint32_t src2, uint32_t src1)
 static uint8_t cpuSubB(uint8_t src2, uint8_t src1)
 {
   uint8_t res = src2 - src1;
-  cpuSetFlagsSub(cpuIsZeroB(res), cpuMsbB(res), cpuMsbB(src2), cpuMsbB(src1));
+  cpuSetFlagsSubB(res, src2, src1);
   return res;
 }
 
@@ -253,7 +271,7 @@ static uint8_t cpuSubB(uint8_t src2, uint8_t src1)
 static uint16_t cpuSubW(uint16_t src2, uint16_t src1)
 {
   uint16_t res = src2 - src1;
-  cpuSetFlagsSub(cpuIsZeroW(res), cpuMsbW(res), cpuMsbW(src2), cpuMsbW(src1));
+  cpuSetFlagsSubW(res, src2, src1);
   return res;
 }
 
@@ -264,7 +282,7 @@ static uint16_t cpuSubW(uint16_t src2, uint16_t src1)
 static uint32_t cpuSubL(uint32_t src2, uint32_t src1)
 {
   uint32_t res = src2 - src1;
-  cpuSetFlagsSub(cpuIsZeroL(res), cpuMsbL(res), cpuMsbL(src2), cpuMsbL(src1));
+  cpuSetFlagsSubL(res, src2, src1);
   return res;
 }
 
@@ -292,7 +310,7 @@ static uint32_t cpuSubaL(uint32_t src2, uint32_t src1)
 static void cpuCmpB(uint8_t src2, uint8_t src1)
 {
   uint8_t res = src2 - src1;
-  cpuSetFlagsCmp(cpuIsZeroB(res), cpuMsbB(res), cpuMsbB(src2), cpuMsbB(src1));
+  cpuSetFlagsCmpB(res, src2, src1);
 }
 
 /// <summary>
@@ -301,7 +319,7 @@ static void cpuCmpB(uint8_t src2, uint8_t src1)
 static void cpuCmpW(uint16_t src2, uint16_t src1)
 {
   uint16_t res = src2 - src1;
-  cpuSetFlagsCmp(cpuIsZeroW(res), cpuMsbW(res), cpuMsbW(src2), cpuMsbW(src1));
+  cpuSetFlagsCmpW(res, src2, src1);
 }
 
 /// <summary>
@@ -310,7 +328,7 @@ static void cpuCmpW(uint16_t src2, uint16_t src1)
 static void cpuCmpL(uint32_t src2, uint32_t src1)
 {
   uint32_t res = src2 - src1;
-  cpuSetFlagsCmp(cpuIsZeroL(res), cpuMsbL(res), cpuMsbL(src2), cpuMsbL(src1));
+  cpuSetFlagsCmpL(res, src2, src1);
 }
 
 /// <summary>
@@ -852,6 +870,132 @@ static void cpuDbcc(BOOLE cc, uint32_t reg)
   }
 }
 
+static CPU_THREAD_LOCAL BOOLE cpu_dbf_idiom = TRUE;
+
+void cpuSetDbfIdiom(BOOLE enable)
+{
+  cpu_dbf_idiom = enable;
+}
+
+/// <summary>
+/// MPW -- DBF closing a one instruction copy or fill loop:
+///   move.x (Ay)+,(Ax)+ / dbf Dn,*-2
+///   move.x Dm,(Ax)+    / dbf Dn,*-2
+///   clr.x (Ax)+        / dbf Dn,*-2
+/// The body has just run for this iteration.  The remaining Dn.w
+/// iterations run as one bulk copy or fill that leaves the registers,
+/// flags and memory as the loop would.  Returns FALSE without changing
+/// anything when the loop doesn't qualify (addresses outside the fast
+/// path, an overlap that repeats a pattern, a loop that writes over
+/// itself, tracing, ...).
+/// </summary>
+static BOOLE cpuDbfIdiom(uint32_t reg)
+{
+#if defined(CPU_CYCLE_ACCOUNTING) || defined(CPU_INSTRUCTION_LOGGING)
+  return FALSE;
+#else
+  uint32_t pc = cpuGetPC(); // the displacement word
+  uint32_t count = cpuGetDRegWord(reg);
+  uint32_t limit = memory_fast_limit[1];
+  uint32_t size, total, reg_dst, dst, src = 0, last, i;
+  uint32_t data = 0;
+  BOOLE copy = FALSE;
+  uint16_t opcode;
+
+  // count == 0 is the last iteration.
+  if (!cpu_dbf_idiom || count == 0 || (cpu_sr & 0xc000)) return FALSE;
+  if (pc < 4 || limit < 2 || pc > limit - 2 || memoryReadWord(pc) != 0xfffc) return FALSE;
+
+  opcode = memoryReadWord(pc - 4);
+  if ((opcode & 0xc1f8) == 0x00d8 || (opcode & 0xc1f8) == 0x00c0)
+  {
+    // move.x (Ay)+,(Ax)+ or move.x Dm,(Ax)+
+    switch (opcode & 0x3000)
+    {
+      case 0x1000: size = 1; break;
+      case 0x3000: size = 2; break;
+      case 0x2000: size = 4; break;
+      default: return FALSE;
+    }
+    if (opcode & 0x0008)
+    {
+      if ((opcode & 7) == 7 || (opcode & 7) == ((opcode >> 9) & 7)) return FALSE;
+      src = cpuGetAReg(opcode & 7);
+      copy = TRUE;
+    }
+    else
+    {
+      if ((opcode & 7) == reg) return FALSE;
+      data = cpuGetDReg(opcode & 7);
+    }
+    dst = (opcode >> 9) & 7;
+  }
+  else if ((opcode & 0xff38) == 0x4218 && (opcode & 0x00c0) != 0x00c0)
+  {
+    // clr.x (Ax)+
+    size = 1 << ((opcode >> 6) & 3);
+    dst = opcode & 7;
+  }
+  else return FALSE;
+
+  // (a7)+ keeps the stack aligned for bytes.
+  if (dst == 7) return FALSE;
+
+  reg_dst = dst;
+  total = count * size;
+  dst = cpuGetAReg(dst);
+
+  if (limit < total || dst > limit - total) return FALSE;
+  if (copy && (src > limit - total || (dst > src && dst < src + total))) return FALSE;
+  if (dst < pc + 2 && dst + total > pc - 4) return FALSE;
+
+  if (copy)
+  {
+    memmove(memory_fast_base + dst, memory_fast_base + src, total);
+    cpuSetAReg(opcode & 7, src + total);
+  }
+  else if (size == 1)
+  {
+    memset(memory_fast_base + dst, (uint8_t)data, total);
+  }
+  else
+  {
+    uint8_t pattern[4];
+    data <<= (4 - size) * 8;
+    pattern[0] = (uint8_t)(data >> 24);
+    pattern[1] = (uint8_t)(data >> 16);
+    pattern[2] = (uint8_t)(data >> 8);
+    pattern[3] = (uint8_t)data;
+    for (i = 0; i < total; i += size)
+      memcpy(memory_fast_base + dst + i, pattern, size);
+  }
+  cpuBlockCacheInvalidate(dst, total);
+  cpuSetAReg(reg_dst, dst + total);
+
+  // the flags are from the last element moved.
+  last = dst + total - size;
+  switch (size)
+  {
+    case 1: cpuSetFlagsNZ00NewB(memoryReadByte(last)); break;
+    case 2: cpuSetFlagsNZ00NewW(memoryReadWord(last)); break;
+    default: cpuSetFlagsNZ00NewL(memoryReadLong(last)); break;
+  }
+
+  cpuSetDRegWord(reg, 0xffff);
+  cpuSkipNextWord();
+  cpuSetInstructionTime(14);
+  return TRUE;
+#endif
+}
+
+/// <summary>
+/// DBF (dbra) word offset.
+/// </summary>
+static void cpuDbf(uint32_t reg)
+{
+  if (!cpuDbfIdiom(reg)) cpuDbcc(FALSE, reg);
+}
+
 /// <summary>
 /// And #imm, ccr 
 /// </summary>
@@ -2107,44 +2251,31 @@ static void cpuMovemwPre(uint16_t regs, uint32_t reg)
 /// </summary>
 static void cpuMovemlPre(uint16_t regs, uint32_t reg)
 {
-  uint32_t cycles = 8;
-  uint32_t dstea = cpuGetAReg(reg);
-  uint32_t index = 1;
-  int32_t j;
+  uint32_t values[16];
+  uint32_t count = 0;
+  uint32_t self = 16;
+  uint32_t dstea;
+  uint32_t r;
 
-  int32_t i = 1;
-  for (j = 7; j >= 0; j--)
+  // MPW -- one bulk write.  The mask is reversed, bit 15 is d0.
+  for (r = 0; r < 16; ++r)
   {
-    if (regs & index)
+    if (regs & (0x8000 >> r))
     {
-      dstea -= 4;
-      if (cpuGetModelMajor() >= 2 && j == reg)
-      {
-	memoryWriteLong(dstea, dstea);
-      }
-      else
-      {
-	memoryWriteLong(cpuGetReg(i, j), dstea);
-      }
-      cycles += 8;
+      if (r == 8 + reg) self = count;
+      values[count++] = cpu_regs[r >> 3][r & 7];
     }
-    index = index << 1;
   }
 
-  i = 0;
-  for (j = 7; j >= 0; j--)
+  dstea = cpuGetAReg(reg) - count * 4;
+  if (cpuGetModelMajor() >= 2 && self < 16)
   {
-    if (regs & index)
-    {
-      dstea -= 4;
-      memoryWriteLong(cpuGetReg(i, j), dstea);
-      cycles += 8;
-    }
-    index = index << 1;
+    values[self] = dstea + self * 4;
   }
 
+  memoryWriteLongs(values, dstea, count);
   cpuSetAReg(reg, dstea);
-  cpuSetInstructionTime(cycles);
+  cpuSetInstructionTime(8 + count * 8);
 }
 
 /// <summary>
@@ -2175,31 +2306,43 @@ static void cpuMovemwPost(uint16_t regs, uint32_t reg)
   cpuSetInstructionTime(cycles);
 }
 
+/// <summary>
+/// MPW -- Movem.l memory to registers with one bulk read.
+/// Order: a7-a0,d7-d0   d0 first
+/// Returns the number of registers loaded.
+/// </summary>
+static uint32_t cpuMovemlLoad(uint16_t regs, uint32_t ea)
+{
+  uint32_t values[16];
+  uint32_t count = 0;
+  uint32_t r;
+
+  for (r = 0; r < 16; ++r)
+  {
+    if (regs & (1 << r)) ++count;
+  }
+
+  memoryReadLongs(values, ea, count);
+
+  count = 0;
+  for (r = 0; r < 16; ++r)
+  {
+    if (regs & (1 << r)) cpu_regs[r >> 3][r & 7] = values[count++];
+  }
+  return count;
+}
+
 /// <summary>
 /// Movem.l (Ax)+, regs
 /// Order: a7-a0,d7-d0   d0 first
 /// </summary>
 static void cpuMovemlPost(uint16_t regs, uint32_t reg)
 {
-  uint32_t cycles = 12;
   uint32_t dstea = cpuGetAReg(reg);
-  uint32_t index = 1;
+  uint32_t count = cpuMovemlLoad(regs, dstea);
 
-  for (uint32_t i = 0; i < 2; ++i)
-  {
-    for (uint32_t j = 0; j < 8; ++j)
-    {
-      if (regs & index)
-      {
-	cpuSetReg(i, j, memoryReadLong(dstea));
-	dstea += 4;
-	cycles += 8;
-      }
-      index = index << 1;
-    }
-  }
-  cpuSetAReg(reg, dstea);
-  cpuSetInstructionTime(cycles);
+  cpuSetAReg(reg, dstea + count * 4);
+  cpuSetInstructionTime(12 + count * 8);
 }
 
 /// <summary>
@@ -2235,24 +2378,9 @@ static void cpuMovemwEa2R(uint16_t regs, uint32_t ea, uint32_t eacycles)
 /// </summary>
 static void cpuMovemlEa2R(uint16_t regs, uint32_t ea, uint32_t eacycles)
 {
-  uint32_t cycles = eacycles;
-  uint32_t dstea = ea;
-  uint32_t index = 1;
+  uint32_t count = cpuMovemlLoad(regs, ea);
 
-  for (uint32_t i = 0; i < 2; ++i)
-  {
-    for (uint32_t j = 0; j < 8; ++j)
-    {
-      if (regs & index)
-      {
-	cpuSetReg(i, j, memoryReadLong(dstea));
-	dstea += 4;
-	cycles += 8;
-      }
-      index = index << 1;
-    }
-  }
-  cpuSetInstructionTime(cycles);
+  cpuSetInstructionTime(eacycles + count * 8);
 }
 
 /// <summary>
@@ -2287,25 +2415,18 @@ static void cpuMovemwR2Ea(uint16_t regs, uint32_t ea, uint32_t eacycles)
 /// </summary>
 static void cpuMovemlR2Ea(uint16_t regs, uint32_t ea, uint32_t eacycles)
 {
-  uint32_t cycles = eacycles;
-  uint32_t dstea = ea;
-  uint32_t index = 1;
-  uint32_t i, j;
+  uint32_t values[16];
+  uint32_t count = 0;
+  uint32_t r;
 
-  for (i = 0; i < 2; ++i)
+  // MPW -- one bulk write.
+  for (r = 0; r < 16; ++r)
   {
-    for (j = 0; j < 8; ++j)
-    {
-      if (regs & index)
-      {
-	memoryWriteLong(cpuGetReg(i, j), dstea);
-	dstea += 4;
-	cycles += 8;
-      }
-      index = index << 1;
-    }
+    if (regs & (1 << r)) values[count++] = cpu_regs[r >> 3][r & 7];
   }
-  cpuSetInstructionTime(cycles);
+
+  memoryWriteLongs(values, ea, count);
+  cpuSetInstructionTime(eacycles + count * 8);
 }
 
 /// <summary>
@@ -2359,7 +2480,7 @@ static void cpuCmpMB(uint32_t regx, uint32_t regy)
   uint8_t src = memoryReadByte(cpuEA03(regy, 1));
   uint8_t dst = memoryReadByte(cpuEA03(regx, 1));
   uint8_t res = dst - src;
-  cpuSetFlagsCmp(cpuIsZeroB(res), cpuMsbB(res), cpuMsbB(dst), cpuMsbB(src));
+  cpuSetFlagsCmpB(res, dst, src);
   cpuSetInstructionTime(12);
 }
 
@@ -2371,7 +2492,7 @@ static void cpuCmpMW(uint32_t regx, uint32_t regy)
   uint16_t src = memoryReadWord(cpuEA03(regy, 2));
   uint16_t dst = memoryReadWord(cpuEA03(regx, 2));
   uint16_t res = dst - src;
-  cpuSetFlagsCmp(cpuIsZeroW(res), cpuMsbW(res), cpuMsbW(dst), cpuMsbW(src));
+  cpuSetFlagsCmpW(res, dst, src);
   cpuSetInstructionTime(12);
 }
 
@@ -2383,7 +2504,7 @@ static void cpuCmpML(uint32_t regx, uint32_t regy)
   uint32_t src = memoryReadLong(cpuEA03(regy, 4));
   uint32_t dst = memoryReadLong(cpuEA03(regx, 4));
   uint32_t res = dst - src;
-  cpuSetFlagsCmp(cpuIsZeroL(res), cpuMsbL(res), cpuMsbL(dst), cpuMsbL(src));
+  cpuSetFlagsCmpL(res, dst, src);
   cpuSetInstructionTime(20);
 }
 
@@ -3332,7 +3453,7 @@ static void cpuCasB(uint32_t ea, uint16_t extension)
   uint32_t cmp_regno = extension & 7;
   uint8_t res = dst - cpuGetDRegByte(cmp_regno);
 
-  cpuSetFlagsCmp(cpuIsZeroB(res), cpuMsbB(res), cpuMsbB(dst), cpuMsbB(cpuGetDRegByte(cmp_regno)));
+  cpuSetFlagsCmpB(res, dst, cpuGetDRegByte(cmp_regno));
 
   if (cpuIsZeroB(res))
   {
@@ -3354,7 +3475,7 @@ static void cpuCasW(uint32_t ea, uint16_t extension)
   uint32_t cmp_regno = extension & 7;
   uint16_t res = dst - cpuGetDRegWord(cmp_regno);
 
-  cpuSetFlagsCmp(cpuIsZeroW(res), cpuMsbW(res), cpuMsbW(dst), cpuMsbW(cpuGetDRegWord(cmp_regno)));
+  cpuSetFlagsCmpW(res, dst, cpuGetDRegWord(cmp_regno));
 
   if (cpuIsZeroW(res))
   {
@@ -3376,7 +3497,7 @@ static void cpuCasL(uint32_t ea, uint16_t extension)
   uint32_t cmp_regno = extension & 7;
   uint32_t res = dst - cpuGetDReg(cmp_regno);
 
-  cpuSetFlagsCmp(cpuIsZeroL(res), cpuMsbL(res), cpuMsbL(dst), cpuMsbL(cpuGetDReg(cmp_regno)));
+  cpuSetFlagsCmpL(res, dst, cpuGetDReg(cmp_regno));
 
   if (cpuIsZeroL(res))
   {
@@ -3407,11 +3528,11 @@ static void cpuCas2W(void)
 
   if (cpuIsZeroW(res1))
   {
-    cpuSetFlagsCmp(cpuIsZeroW(res2), cpuMsbW(res2), cpuMsbW(dst2), cpuMsbW(cpuGetDRegWord(cmp2_regno)));
+    cpuSetFlagsCmpW(res2, dst2, cpuGetDRegWord(cmp2_regno));
   }
   else
   {
-    cpuSetFlagsCmp(cpuIsZeroW(res1), cpuMsbW(res1), cpuMsbW(dst1), cpuMsbW(cpuGetDRegWord(cmp1_regno)));
+    cpuSetFlagsCmpW(res1, dst1, cpuGetDRegWord(cmp1_regno));
   }
 
   if (cpuIsZeroW(res1) && cpuIsZeroW(res2))
@@ -3448,11 +3569,11 @@ static void cpuCas2L(void)
 
   if (cpuIsZeroL(res1))
   {
-    cpuSetFlagsCmp(cpuIsZeroL(res2), cpuMsbL(res2), cpuMsbL(dst2), cpuMsbL(cpuGetDReg(cmp2_regno)));
+    cpuSetFlagsCmpL(res2, dst2, cpuGetDReg(cmp2_regno));
   }
   else
   {
-    cpuSetFlagsCmp(cpuIsZeroL(res1), cpuMsbL(res1), cpuMsbL(dst1), cpuMsbL(cpuGetDReg(cmp1_regno)));
+    cpuSetFlagsCmpL(res1, dst1, cpuGetDReg(cmp1_regno));
   }
 
   if (cpuIsZeroL(res1) && cpuIsZeroL(res2))
@@ -3680,24 +3801,122 @@ static void cpuPtest040(uint32_t rw, uint32_t regno)
 #include "CpuModule_Profile.h"
 #include "CpuModule_Code.h"
 
-cpuOpcodeData cpu_opcode_data_current[65536];
+/*============================================================================*/
+/* MPW -- compact opcode table                                                */
+/*============================================================================*/
+
+const cpuInstructionFunction cpu_opcode_handlers[] =
+{
+#define CPU_HANDLER(name) name,
+#include "CpuModule_Handlers.h"
+#undef CPU_HANDLER
+};
+
+#define CPU_OPCODE_HANDLER_COUNT (sizeof(cpu_opcode_handlers) / sizeof(cpu_opcode_handlers[0]))
+
+cpuOpcodeEntry cpu_opcode_table[65536];
+
+typedef struct cpu_handler_index_struct
+{
+  uintptr_t func;
+  uint16_t index;
+} cpuHandlerIndex;
+
+static int cpuCompareHandlerIndex(const void *a, const void *b)
+{
+  uintptr_t fa = ((const cpuHandlerIndex *)a)->func;
+  uintptr_t fb = ((const cpuHandlerIndex *)b)->func;
+  return (fa > fb) - (fa < fb);
+}
+
+/// <summary>
+/// Returns the index of func in cpu_opcode_handlers.
+/// </summary>
+static uint16_t cpuGetHandlerIndex(cpuInstructionFunction func)
+{
+  static cpuHandlerIndex sorted[CPU_OPCODE_HANDLER_COUNT];
+  static BOOLE initialized = FALSE;
+  cpuHandlerIndex key = {(uintptr_t)func, 0};
+  cpuHandlerIndex *found;
+
+  if (!initialized)
+  {
+    for (uint32_t i = 0; i < CPU_OPCODE_HANDLER_COUNT; i++)
+    {
+      sorted[i].func = (uintptr_t)cpu_opcode_handlers[i];
+      sorted[i].index = (uint16_t)i;
+    }
+    qsort(sorted, CPU_OPCODE_HANDLER_COUNT, sizeof(cpuHandlerIndex), cpuCompareHandlerIndex);
+    initialized = TRUE;
+  }
+
+  found = bsearch(&key, sorted, CPU_OPCODE_HANDLER_COUNT, sizeof(cpuHandlerIndex), cpuCompareHandlerIndex);
+  return found ? found->index : 0; // 0 is cpuIllegalInstruction
+}
+
+uint32_t cpu_opcode_operands[CPU_OPCODE_OPERAND_MAX][3];
+
+/// <summary>
+/// Fills cpu_opcode_operands with every distinct operand triple in
+/// cpu_opcode_data and returns the operand index of each opcode.
+/// data[0] is a register number, data[1] is a sign extended byte and
+/// data[2] is below 256, so 20 bits identify a triple.
+/// </summary>
+static uint16_t *cpuMakeOpcodeOperandTable(void)
+{
+  static uint16_t operand_index[65536];
+  static BOOLE initialized = FALSE;
+  uint16_t *slot;
+  uint32_t count = 0;
+
+  if (initialized) return operand_index;
+
+  slot = calloc(1 << 20, sizeof(uint16_t));
+  for (uint32_t opcode = 0; opcode < 65536; opcode++)
+  {
+    const uint32_t *data = cpu_opcode_data[opcode].data;
+    uint32_t key = (data[0] & 0xf) | ((data[1] & 0xff) << 4) | ((data[2] & 0xff) << 12);
+
+    if (!slot[key])
+    {
+      cpu_opcode_operands[count][0] = data[0];
+      cpu_opcode_operands[count][1] = data[1];
+      cpu_opcode_operands[count][2] = data[2];
+      slot[key] = (uint16_t)++count;
+    }
+    operand_index[opcode] = slot[key] - 1;
+  }
+  free(slot);
+  initialized = TRUE;
+  return operand_index;
+}
 
 void cpuMakeOpcodeTableForModel(void)
 {
+  uint16_t *operand_index = cpuMakeOpcodeOperandTable();
+  uint16_t a_line = cpuGetHandlerIndex(cpuALine);
+  uint16_t f_line = cpuGetHandlerIndex(cpuFLine);
+
   for (uint32_t opcode = 0; opcode < 65536; opcode++)
   {
     if (cpu_opcode_model_mask[opcode] & cpuGetModelMask())
     {
-      cpu_opcode_data_current[opcode] = cpu_opcode_data[opcode];
+      cpu_opcode_table[opcode] = cpuGetHandlerIndex(cpu_opcode_data[opcode].instruction_func)
+        | (operand_index[opcode] << CPU_OPCODE_HANDLER_BITS);
     }
     else
     {
-      cpu_opcode_data_current[opcode].instruction_func = cpuIllegalInstruction;
-      cpu_opcode_data_current[opcode].data[0] = 0;
-      cpu_opcode_data_current[opcode].data[1] = 0;
-      cpu_opcode_data_current[opcode].data[2] = 0;
+      cpu_opcode_table[opcode] = 0; // cpuIllegalInstruction, operands of opcode 0 are all zero
+    }
+
+    // MPW -- traps skip cpuIllegal's decoding.
+    if (cpuOpcodeHandlerIndex(cpu_opcode_table[opcode]) == 0)
+    {
+      if ((opcode & 0xf000) == 0xa000) cpu_opcode_table[opcode] = a_line;
+      if ((opcode & 0xf000) == 0xf000) cpu_opcode_table[opcode] = f_line;
     }
   }
+  cpuBlockCacheFlush(); // MPW - decoded blocks point into the operand table.
 }
 
 uint32_t irq_arrival_time = -1;
@@ -3728,8 +3947,10 @@ uint32_t cpuExecuteInstruction(void)
 #endif
 
     cpuSetInstructionTime(0);
+    cpuCountInstructions(1);
 
-    cpu_opcode_data_current[opcode].instruction_func(cpu_opcode_data_current[opcode].data);
+    cpuOpcodeEntry entry = cpu_opcode_table[opcode];
+    cpuOpcodeFunction(entry)(cpuOpcodeOperands(entry));
 
     if (oldSr & 0xc000 && !cpuGetInstructionAborted())
     {
@@ -3741,3 +3962,59 @@ uint32_t cpuExecuteInstruction(void)
     return cpuGetInstructionTime();
   }
 }
+
+#ifdef CPU_THREADED_DISPATCH
+
+/*============================================================================*/
+/* MPW -- threaded dispatch.                                                  */
+/* Every handler gets a label followed by its own copy of the fetch and      */
+/* dispatch code, so each indirect jump is predicted separately.  Returns     */
+/* after limit instructions, a pc of 0, trace mode, a stop, trap or           */
+/* exception.                                                                 */
+/*============================================================================*/
+
+uint32_t cpuExecuteThreaded(uint32_t limit)
+{
+  static const void *cpu_threaded_labels[] =
+  {
+#define CPU_HANDLER(name) &&threaded_##name,
+#include "CpuModule_Handlers.h"
+#undef CPU_HANDLER
+  };
+
+  uint32_t events = cpu_execute_events;
+  uint32_t count = 0;
+  uint32_t *opc_data;
+  cpuOpcodeEntry entry;
+
+  if (!limit) return 0;
+
+  if (cpuGetRaiseInterrupt() || (cpu_sr & 0xc000))
+  {
+    cpuExecuteInstruction();
+    return 1;
+  }
+
+#define CPU_THREADED_DISPATCH_NEXT() \
+  cpu_instruction_aborted = false; \
+  cpu_original_pc = cpu_pc; \
+  entry = cpu_opcode_table[cpuGetNextWord()]; \
+  cpuSetInstructionTime(0); \
+  opc_data = cpuOpcodeOperands(entry); \
+  ++count; \
+  goto *cpu_threaded_labels[cpuOpcodeHandlerIndex(entry)]
+
+  CPU_THREADED_DISPATCH_NEXT();
+
+#define CPU_HANDLER(name) \
+threaded_##name: \
+  name(opc_data); \
+  if (count == limit || cpu_execute_events != events || cpu_pc == 0 || (cpu_sr & 0xc000)) return count; \
+  CPU_THREADED_DISPATCH_NEXT();
+#include "CpuModule_Handlers.h"
+#undef CPU_HANDLER
+
+#undef CPU_THREADED_DISPATCH_NEXT
+}
+
+#endif
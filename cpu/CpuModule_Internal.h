@@ -1,6 +1,76 @@
 #pragma once
 
 // This header file defines the internal interfaces of the CPU module.
+typedef void (*cpuInstructionFunction)(uint32_t*);
+typedef struct cpu_data_struct
+{
+	cpuInstructionFunction instruction_func;
+	uint32_t data[3];
+} cpuOpcodeData;
+
+// MPW -- the opcode table for the current model, 4 bytes per opcode
+// instead of a cpuOpcodeData (24 bytes on 64-bit hosts).  The operands
+// live in a second table; only a few thousand distinct ones exist.
+//
+// bits  0-11  handler index (CpuModule_Handlers.h)
+// bits 12-23  operand index (cpu_opcode_operands)
+typedef uint32_t cpuOpcodeEntry;
+
+#define CPU_OPCODE_HANDLER_BITS 12
+#define CPU_OPCODE_OPERAND_MAX 4096
+
+extern cpuOpcodeEntry cpu_opcode_table[65536];
+extern const cpuInstructionFunction cpu_opcode_handlers[];
+extern uint32_t cpu_opcode_operands[CPU_OPCODE_OPERAND_MAX][3];
+
+#define cpuOpcodeHandlerIndex(entry) ((entry) & ((1 << CPU_OPCODE_HANDLER_BITS) - 1))
+#define cpuOpcodeFunction(entry) (cpu_opcode_handlers[cpuOpcodeHandlerIndex(entry)])
+#define cpuOpcodeOperands(entry) (cpu_opcode_operands[(entry) >> CPU_OPCODE_HANDLER_BITS])
+
+// Decoded block cache
+#define CPU_BLOCK_MAX_INSTRUCTIONS 16
+
+typedef struct cpu_block_instruction_struct
+{
+	cpuInstructionFunction instruction_func;
+	uint32_t *data;
+	uint32_t pc;
+	uint16_t opcode;
+	uint16_t prefetch;
+} cpuBlockInstruction;
+
+// translated block, returns the number of instructions executed.
+typedef uint32_t (*cpuJitFunction)(void);
+
+typedef struct cpu_block_struct
+{
+	uint32_t pc;
+	uint32_t generation;
+	uint32_t count;
+	uint32_t hits;
+	cpuJitFunction jit;
+	cpuBlockInstruction instructions[CPU_BLOCK_MAX_INSTRUCTIONS];
+} cpuBlock;
+
+extern CPU_THREAD_LOCAL uint32_t cpu_block_cache_generation;
+
+// Bulk execution
+extern CPU_THREAD_LOCAL uint32_t cpu_execute_events; // MPW - not static, the threaded engine checks it per instruction
+extern void cpuSetExecuteEvent(uint32_t event);
+extern void cpuCountInstructions(uint32_t count);
+
+// Threaded dispatch -- needs labels as values (gcc, clang).
+#if defined(CPU_THREADED_DISPATCH) && (!defined(__GNUC__) || defined(CPU_INSTRUCTION_LOGGING))
+#undef CPU_THREADED_DISPATCH
+#endif
+
+extern uint32_t cpuExecuteThreaded(uint32_t limit);
+
+// JIT
+extern BOOLE cpuJitEnabled(void);
+extern cpuJitFunction cpuJitTranslate(cpuBlock *block);
+extern void cpuJitFlush(void);
+
 extern void cpuMakeOpcodeTableForModel(void);
 extern void cpuCreateMulTimeTables(void);
 
@@ -9,7 +79,14 @@ extern void cpuStackFrameGenerate(uint16_t vector_no, uint32_t pc);
 extern void cpuStackFrameInit(void);
 
 // Registers
-extern uint32_t cpu_sr;  // Not static because the flags calculation uses it extensively
+extern CPU_THREAD_LOCAL uint32_t cpu_sr;  // Not static because the flags calculation uses it extensively
+// MPW - not static, the JIT addresses these directly.
+extern CPU_THREAD_LOCAL uint32_t cpu_regs[2][8];
+extern CPU_THREAD_LOCAL uint32_t cpu_pc;
+extern CPU_THREAD_LOCAL uint16_t cpu_prefetch_word;
+extern CPU_THREAD_LOCAL uint32_t cpu_original_pc;
+extern CPU_THREAD_LOCAL bool cpu_instruction_aborted;
+extern CPU_THREAD_LOCAL uint32_t cpu_instruction_time;
 extern BOOLE cpuGetFlagSupervisor(void);
 extern BOOLE cpuGetFlagMaster(void);
 extern void cpuSetUspDirect(uint32_t usp);
@@ -48,6 +125,14 @@ extern void cpuSetSR(uint32_t sr);
 extern uint32_t cpuGetSR(void);
 extern void cpuSetInstructionTime(uint32_t cycles);
 extern uint32_t cpuGetInstructionTime(void);
+
+// MPW -- MPW tools don't depend on instruction timing.  Without
+// CPU_CYCLE_ACCOUNTING the handlers' cycle counts compile to nothing
+// and cpuGetInstructionTime is always 0.  cpuGetInstructionCount
+// is the cheap alternative for statistics.
+#ifndef CPU_CYCLE_ACCOUNTING
+#define cpuSetInstructionTime(cycles) ((void)(cycles))
+#endif
 extern void cpuSetOriginalPC(uint32_t pc);
 extern uint32_t cpuGetOriginalPC(void);
 extern void cpuSetInstructionAborted(bool aborted);
@@ -76,6 +161,9 @@ extern uint16_t cpuGetARegWord(uint32_t regno);
 extern uint8_t cpuGetARegByte(uint32_t regno);
 
 extern uint16_t cpuGetNextWord(void);
+extern uint16_t cpuGetPrefetchWord(void);
+extern void cpuSetPrefetchWord(uint16_t prefetch);
+extern uint32_t cpuGetRedirectCount(void);
 extern uint32_t cpuGetNextWordSignExt(void);
 extern uint32_t cpuGetNextLong(void);
 extern void cpuSkipNextWord(void);
@@ -97,9 +185,20 @@ extern uint32_t cpuEA72(void);
 extern uint32_t cpuEA73(void);
 
 // Flags
+extern void cpuMaterializeFlags(void);
+extern void cpuDiscardFlags(void);
 extern void cpuSetFlagsAdd(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm);
 extern void cpuSetFlagsSub(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm);
 extern void cpuSetFlagsCmp(BOOLE z, BOOLE rm, BOOLE dm, BOOLE sm);
+extern void cpuSetFlagsAddB(uint8_t res, uint8_t dst, uint8_t src);
+extern void cpuSetFlagsAddW(uint16_t res, uint16_t dst, uint16_t src);
+extern void cpuSetFlagsAddL(uint32_t res, uint32_t dst, uint32_t src);
+extern void cpuSetFlagsSubB(uint8_t res, uint8_t dst, uint8_t src);
+extern void cpuSetFlagsSubW(uint16_t res, uint16_t dst, uint16_t src);
+extern void cpuSetFlagsSubL(uint32_t res, uint32_t dst, uint32_t src);
+extern void cpuSetFlagsCmpB(uint8_t res, uint8_t dst, uint8_t src);
+extern void cpuSetFlagsCmpW(uint16_t res, uint16_t dst, uint16_t src);
+extern void cpuSetFlagsCmpL(uint32_t res, uint32_t dst, uint32_t src);
 extern void cpuSetZFlagBitOpsB(uint8_t res);
 extern void cpuSetZFlagBitOpsL(uint32_t res);
 
@@ -173,6 +272,8 @@ extern void cpuThrowIllegalInstructionException(BOOLE executejmp);
 extern void cpuThrowIllegalInstructionExceptionFromBreakpoint(void);
 extern void cpuThrowFLineException(void);
 extern void cpuThrowALineException(void);
+extern void cpuALineTrap(uint16_t opcode);
+extern void cpuFLineTrap(uint16_t opcode);
 extern void cpuThrowTrapVException(void);
 extern void cpuThrowTrapException(uint32_t vector_no);
 extern void cpuThrowDivisionByZeroException(void);
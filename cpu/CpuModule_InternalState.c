@@ -26,47 +26,48 @@
 #include "CpuModule_Internal.h"
 
 /* M68k registers */
-static uint32_t cpu_regs[2][8]; /* 0 - data, 1 - address */
-static uint32_t cpu_pc;
-static uint32_t cpu_usp;
-static uint32_t cpu_ssp;
-static uint32_t cpu_msp;
-static uint32_t cpu_sfc;
-static uint32_t cpu_dfc;
-uint32_t cpu_sr; // Not static because flags calculation use it extensively
-static uint32_t cpu_vbr;
-static uint16_t cpu_prefetch_word;
-static uint32_t cpu_cacr;
-static uint32_t cpu_caar;
+CPU_THREAD_LOCAL uint32_t cpu_regs[2][8]; /* 0 - data, 1 - address */ // MPW - not static, the JIT uses it
+CPU_THREAD_LOCAL uint32_t cpu_pc; // MPW - not static, the JIT uses it
+static CPU_THREAD_LOCAL uint32_t cpu_usp;
+static CPU_THREAD_LOCAL uint32_t cpu_ssp;
+static CPU_THREAD_LOCAL uint32_t cpu_msp;
+static CPU_THREAD_LOCAL uint32_t cpu_sfc;
+static CPU_THREAD_LOCAL uint32_t cpu_dfc;
+CPU_THREAD_LOCAL uint32_t cpu_sr; // Not static because flags calculation use it extensively
+static CPU_THREAD_LOCAL uint32_t cpu_vbr;
+CPU_THREAD_LOCAL uint16_t cpu_prefetch_word; // MPW - not static, the JIT uses it
+static CPU_THREAD_LOCAL uint32_t cpu_redirect_count; // MPW - number of non-sequential pc changes
+static CPU_THREAD_LOCAL uint32_t cpu_cacr;
+static CPU_THREAD_LOCAL uint32_t cpu_caar;
 
 /* Irq management */
-static BOOLE cpu_raise_irq;
-static uint32_t cpu_raise_irq_level;
+static CPU_THREAD_LOCAL BOOLE cpu_raise_irq;
+static CPU_THREAD_LOCAL uint32_t cpu_raise_irq_level;
 
 /* Reset values */
-static uint32_t cpu_initial_pc;
-static uint32_t cpu_initial_sp;
+static CPU_THREAD_LOCAL uint32_t cpu_initial_pc;
+static CPU_THREAD_LOCAL uint32_t cpu_initial_sp;
 
 /* Flag set if CPU is stopped */
-static BOOLE cpu_stop;
+static CPU_THREAD_LOCAL BOOLE cpu_stop;
 
 /* The current CPU model */
-static uint32_t cpu_model_major = -1;
-static uint32_t cpu_model_minor;
-static uint8_t cpu_model_mask;
+static CPU_THREAD_LOCAL uint32_t cpu_model_major = -1;
+static CPU_THREAD_LOCAL uint32_t cpu_model_minor;
+static CPU_THREAD_LOCAL uint8_t cpu_model_mask;
 
 /* For exception handling */
 #ifdef CPU_INSTRUCTION_LOGGING
 
-static uint16_t cpu_current_opcode;
+static CPU_THREAD_LOCAL uint16_t cpu_current_opcode;
 
 #endif
 
-static uint32_t cpu_original_pc;
-static bool cpu_instruction_aborted;
+CPU_THREAD_LOCAL uint32_t cpu_original_pc; // MPW - not static, the JIT uses it
+CPU_THREAD_LOCAL bool cpu_instruction_aborted;
 
 /* Number of cycles taken by the last intstruction */
-static uint32_t cpu_instruction_time;
+CPU_THREAD_LOCAL uint32_t cpu_instruction_time;
 
 /* Getters and setters */
 
@@ -163,7 +164,11 @@ void cpuSetIspAutoMap(uint32_t new_isp)
 void cpuSetPC(uint32_t address) {cpu_pc = address;}
 uint32_t cpuGetPC() {return cpu_pc;}
 
-void cpuSetStop(BOOLE stop) {cpu_stop = stop;}
+void cpuSetStop(BOOLE stop)
+{
+  cpu_stop = stop;
+  if (stop) cpuSetExecuteEvent(CPU_EXECUTE_STOP); // MPW
+}
 BOOLE cpuGetStop() {return cpu_stop;}
 
 void cpuSetVbr(uint32_t vbr) {cpu_vbr = vbr;}
@@ -181,10 +186,10 @@ uint32_t cpuGetCacr() {return cpu_cacr;}
 void cpuSetCaar(uint32_t caar) {cpu_caar = caar;}
 uint32_t cpuGetCaar() {return cpu_caar;}
 
-void cpuSetSR(uint32_t sr) {cpu_sr = sr;}
-uint32_t cpuGetSR() {return cpu_sr;}
+void cpuSetSR(uint32_t sr) {cpuDiscardFlags(); cpu_sr = sr;}
+uint32_t cpuGetSR() {cpuMaterializeFlags(); return cpu_sr;}
 
-void cpuSetInstructionTime(uint32_t cycles) {cpu_instruction_time = cycles;}
+void (cpuSetInstructionTime)(uint32_t cycles) {cpu_instruction_time = cycles;}
 uint32_t cpuGetInstructionTime() {return cpu_instruction_time;}
 
 void cpuSetOriginalPC(uint32_t pc) {cpu_original_pc = pc;}
@@ -246,6 +251,7 @@ void cpuSetModel(uint32_t major, uint32_t minor)
   cpuCalculateModelMask();
   cpuStackFrameInit();
   if (makeOpcodeTable) cpuMakeOpcodeTableForModel();
+  memoryUpdateFastPath(); // MPW - odd addresses fault before the 68020.
 }
 
 #if 0
@@ -271,6 +277,8 @@ uint8_t cpuGetARegByte(uint32_t regno) {return (uint8_t)cpu_regs[1][regno];}
 typedef uint16_t (*cpuGetWordFunc)(void);
 typedef uint32_t (*cpuGetLongFunc)(void);
 
+#ifdef CPU_ACCURATE_PREFETCH
+
 static uint16_t cpuGetNextWordInternal(void)
 {
   uint16_t data = memoryReadWord(cpuGetPC() + 2);
@@ -305,9 +313,69 @@ uint32_t cpuGetNextLong(void)
   return tmp | (data >> 16);
 }
 
+#else
+
+// MPW -- fast fetch.  There is no prefetch word; instruction and
+// extension words are read from memory at the pc when they are used,
+// straight from the host memory when the memory fast path allows it.
+// A write to the next instruction is seen even though a real 68000
+// would already have fetched it, which no MPW tool depends on.
+
+uint16_t cpuGetNextWord(void)
+{
+  uint32_t pc = cpu_pc;
+  cpu_pc = pc + 2;
+
+#ifndef MEMORY_NO_FAST_PATH
+  if (pc < memory_fast_limit[2])
+  {
+    uint16_t data;
+    memcpy(&data, memory_fast_base + pc, sizeof(data));
+    return memoryHostToBig16(data);
+  }
+#endif
+  return memoryReadWord(pc);
+}
+
+uint32_t cpuGetNextWordSignExt(void)
+{
+  return cpuSignExtWordToLong(cpuGetNextWord());
+}
+
+uint32_t cpuGetNextLong(void)
+{
+  uint32_t pc = cpu_pc;
+  cpu_pc = pc + 4;
+
+#ifndef MEMORY_NO_FAST_PATH
+  if (pc < memory_fast_limit[4])
+  {
+    uint32_t data;
+    memcpy(&data, memory_fast_base + pc, sizeof(data));
+    return memoryHostToBig32(data);
+  }
+#endif
+  return memoryReadLong(pc);
+}
+
+#endif
+
+// MPW -- the block cache restores the prefetch word from the decoded block.
+#ifdef CPU_ACCURATE_PREFETCH
+uint16_t cpuGetPrefetchWord(void) {return cpu_prefetch_word;}
+#else
+// what the prefetch word would hold (the JIT uses it for displacements).
+uint16_t cpuGetPrefetchWord(void) {return memoryReadWord(cpu_pc);}
+#endif
+void cpuSetPrefetchWord(uint16_t prefetch) {cpu_prefetch_word = prefetch;}
+
+uint32_t cpuGetRedirectCount(void) {return cpu_redirect_count;}
+
 void cpuInitializePrefetch(void)
 {
+#ifdef CPU_ACCURATE_PREFETCH
   cpu_prefetch_word = memoryReadWord(cpuGetPC());
+#endif
 }
 
 void cpuClearPrefetch(void)
@@ -329,6 +397,7 @@ void cpuSkipNextLong(void)
 
 void cpuInitializeFromNewPC(uint32_t new_pc)
 {
+  cpu_redirect_count++;
   cpuSetPC(new_pc);
   cpuInitializePrefetch();
 }
@@ -339,7 +408,7 @@ void cpuSaveState(FILE *F)
   fwrite(&cpu_model_minor, sizeof(cpu_model_minor), 1, F);
   for (uint32_t i = 0; i < 2; i++)
   {
-    for (uint32_t j = 0; j < 7; j++)
+    for (uint32_t j = 0; j < 8; j++) // MPW -- D7 and A7 as well
     {
       fwrite(&cpu_regs[i][j], sizeof(cpu_regs[i][j]), 1, F);
     }
@@ -350,6 +419,7 @@ void cpuSaveState(FILE *F)
   fwrite(&cpu_msp, sizeof(cpu_msp), 1, F);
   fwrite(&cpu_sfc, sizeof(cpu_sfc), 1, F);
   fwrite(&cpu_dfc, sizeof(cpu_dfc), 1, F);
+  cpuMaterializeFlags();
   fwrite(&cpu_sr, sizeof(cpu_sr), 1, F);
   fwrite(&cpu_prefetch_word, sizeof(cpu_prefetch_word), 1, F);
   fwrite(&cpu_vbr, sizeof(cpu_vbr), 1, F);
@@ -365,7 +435,7 @@ void cpuLoadState(FILE *F)
   fread(&cpu_model_minor, sizeof(cpu_model_minor), 1, F);
   for (uint32_t i = 0; i < 2; i++)
   {
-    for (uint32_t j = 0; j < 7; j++)
+    for (uint32_t j = 0; j < 8; j++) // MPW -- D7 and A7 as well
     {
       fread(&cpu_regs[i][j], sizeof(cpu_regs[i][j]), 1, F);
     }
@@ -376,6 +446,7 @@ void cpuLoadState(FILE *F)
   fread(&cpu_msp, sizeof(cpu_msp), 1, F);
   fread(&cpu_sfc, sizeof(cpu_sfc), 1, F);
   fread(&cpu_dfc, sizeof(cpu_dfc), 1, F);
+  cpuDiscardFlags();
   fread(&cpu_sr, sizeof(cpu_sr), 1, F);
   fread(&cpu_prefetch_word, sizeof(cpu_prefetch_word), 1, F);
   fread(&cpu_vbr, sizeof(cpu_vbr), 1, F);
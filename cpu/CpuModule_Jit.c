@@ -0,0 +1,365 @@
+#include "defs.h"
+#include "fmem.h"
+#include "CpuModule.h"
+#include "CpuModule_Internal.h"
+
+// MPW -- x86-64 translation of hot blocks.
+//
+// A translated block is straight-line host code.  Register-only
+// instructions that cannot fault (moveq, movea, lea, addq/subq to an
+// address register) operate on the register file directly.  Everything
+// else is a call to the interpreter's opcode handler with the pc and
+// prefetch state set up as the interpreter would.
+//
+// After each handler call the block checks that the pc is where the
+// block expects it.  A branch, A-line/F-line trap (toolbox dispatch
+// happens inside the handler) or any other exception changes the pc,
+// so the block returns and the interpreter picks up from there.  A
+// cache flush or trace mode also end the block.
+
+static CPU_THREAD_LOCAL BOOLE cpu_jit_enabled = FALSE;
+
+BOOLE cpuJitEnabled(void)
+{
+  return cpu_jit_enabled;
+}
+
+#if defined(__x86_64__) && !defined(CPU_INSTRUCTION_LOGGING)
+
+#include <sys/mman.h>
+
+#define CPU_JIT_CODE_SIZE (16 * 1024 * 1024)
+
+// worst case is a handler call with all the checks.
+#define CPU_JIT_MAX_INSTRUCTION_SIZE 256
+
+// with CPU_THREAD_LOCAL_STATE every thread translates into its own buffer,
+// so the register addresses baked into the code are that thread's.
+static CPU_THREAD_LOCAL uint8_t *cpu_jit_code = NULL;
+static CPU_THREAD_LOCAL uint32_t cpu_jit_code_used = 0;
+
+BOOLE cpuSetJit(BOOLE enable)
+{
+  if (enable && !cpu_jit_code)
+  {
+    int flags = MAP_PRIVATE | MAP_ANON;
+#ifdef MAP_JIT
+    flags |= MAP_JIT;
+#endif
+    void *p = mmap(NULL, CPU_JIT_CODE_SIZE, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0);
+    if (p == MAP_FAILED) return FALSE;
+    cpu_jit_code = p;
+    cpu_jit_code_used = 0;
+  }
+  cpu_jit_enabled = enable;
+  return TRUE;
+}
+
+void cpuJitFlush(void)
+{
+  // nothing references the old code once the generation changes.
+  cpu_jit_code_used = 0;
+}
+
+/* Code emission */
+
+static uint8_t *cpuJitEmit8(uint8_t *p, uint8_t b) {*p++ = b; return p;}
+
+static uint8_t *cpuJitEmit16(uint8_t *p, uint16_t w)
+{
+  *p++ = w; *p++ = w >> 8;
+  return p;
+}
+
+static uint8_t *cpuJitEmit32(uint8_t *p, uint32_t l)
+{
+  *p++ = l; *p++ = l >> 8; *p++ = l >> 16; *p++ = l >> 24;
+  return p;
+}
+
+static uint8_t *cpuJitEmit64(uint8_t *p, uint64_t q)
+{
+  p = cpuJitEmit32(p, (uint32_t)q);
+  return cpuJitEmit32(p, (uint32_t)(q >> 32));
+}
+
+// mov rax, imm64
+static uint8_t *cpuJitLoadRax(uint8_t *p, const void *address)
+{
+  p = cpuJitEmit8(p, 0x48);
+  p = cpuJitEmit8(p, 0xb8);
+  return cpuJitEmit64(p, (uint64_t)(uintptr_t)address);
+}
+
+// mov dword [address], imm32
+static uint8_t *cpuJitStore32(uint8_t *p, const void *address, uint32_t value)
+{
+  p = cpuJitLoadRax(p, address);
+  p = cpuJitEmit8(p, 0xc7);
+  p = cpuJitEmit8(p, 0x00);
+  return cpuJitEmit32(p, value);
+}
+
+// mov word [address], imm16
+static uint8_t *cpuJitStore16(uint8_t *p, const void *address, uint16_t value)
+{
+  p = cpuJitLoadRax(p, address);
+  p = cpuJitEmit8(p, 0x66);
+  p = cpuJitEmit8(p, 0xc7);
+  p = cpuJitEmit8(p, 0x00);
+  return cpuJitEmit16(p, value);
+}
+
+// mov byte [address], imm8
+static uint8_t *cpuJitStore8(uint8_t *p, const void *address, uint8_t value)
+{
+  p = cpuJitLoadRax(p, address);
+  p = cpuJitEmit8(p, 0xc6);
+  p = cpuJitEmit8(p, 0x00);
+  return cpuJitEmit8(p, value);
+}
+
+// mov eax, count; jmp exit
+static uint8_t *cpuJitExit(uint8_t *p, uint8_t *exit, uint32_t count)
+{
+  p = cpuJitEmit8(p, 0xb8);
+  p = cpuJitEmit32(p, count);
+  p = cpuJitEmit8(p, 0xe9);
+  return cpuJitEmit32(p, (uint32_t)(exit - (p + 4)));
+}
+
+// leave with count if dword [address] != value.
+static uint8_t *cpuJitExitIfNotEqual(uint8_t *p, uint8_t *exit, const void *address, uint32_t value, uint32_t count)
+{
+  p = cpuJitLoadRax(p, address);
+  p = cpuJitEmit8(p, 0x81); // cmp dword [rax], imm32
+  p = cpuJitEmit8(p, 0x38);
+  p = cpuJitEmit32(p, value);
+  p = cpuJitEmit8(p, 0x74); // je +10
+  p = cpuJitEmit8(p, 10);
+  return cpuJitExit(p, exit, count);
+}
+
+// leave with count if dword [address] & mask.
+static uint8_t *cpuJitExitIfSet(uint8_t *p, uint8_t *exit, const void *address, uint32_t mask, uint32_t count)
+{
+  p = cpuJitLoadRax(p, address);
+  p = cpuJitEmit8(p, 0xf7); // test dword [rax], imm32
+  p = cpuJitEmit8(p, 0x00);
+  p = cpuJitEmit32(p, mask);
+  p = cpuJitEmit8(p, 0x74); // je +10
+  p = cpuJitEmit8(p, 10);
+  return cpuJitExit(p, exit, count);
+}
+
+/* Register file access, rbx holds cpu_regs.  Index 0-7 is d0-d7, 8-15 is a0-a7. */
+
+// mov eax, [rbx + reg*4]
+static uint8_t *cpuJitGetReg(uint8_t *p, uint32_t reg)
+{
+  p = cpuJitEmit8(p, 0x8b);
+  p = cpuJitEmit8(p, 0x43);
+  return cpuJitEmit8(p, reg * 4);
+}
+
+// movsx eax, word [rbx + reg*4]
+static uint8_t *cpuJitGetRegWordSignExt(uint8_t *p, uint32_t reg)
+{
+  p = cpuJitEmit8(p, 0x0f);
+  p = cpuJitEmit8(p, 0xbf);
+  p = cpuJitEmit8(p, 0x43);
+  return cpuJitEmit8(p, reg * 4);
+}
+
+// mov [rbx + reg*4], eax
+static uint8_t *cpuJitSetReg(uint8_t *p, uint32_t reg)
+{
+  p = cpuJitEmit8(p, 0x89);
+  p = cpuJitEmit8(p, 0x43);
+  return cpuJitEmit8(p, reg * 4);
+}
+
+/// <summary>
+/// Emits native code for the register-only instructions.
+/// Returns NULL if the instruction needs the handler.
+/// </summary>
+static uint8_t *cpuJitInline(uint8_t *p, cpuBlockInstruction *entry)
+{
+  uint16_t opcode = entry->opcode;
+  uint32_t an = ((opcode >> 9) & 7) + 8;
+
+#ifndef CPU_LAZY_FLAGS
+  // moveq #data,dn -- with lazy flags the handler records them.
+  if ((opcode & 0xf100) == 0x7000)
+  {
+    uint32_t value = cpuSignExtByteToLong((uint8_t)opcode);
+    uint16_t flags = value == 0 ? 0x4 : (value & 0x80000000) ? 0x8 : 0;
+
+    p = cpuJitEmit8(p, 0xc7); // mov dword [rbx + dn*4], imm32
+    p = cpuJitEmit8(p, 0x43);
+    p = cpuJitEmit8(p, ((opcode >> 9) & 7) * 4);
+    p = cpuJitEmit32(p, value);
+
+    p = cpuJitLoadRax(p, &cpu_sr);
+    p = cpuJitEmit8(p, 0x81); // and dword [rax], 0xfff0
+    p = cpuJitEmit8(p, 0x20);
+    p = cpuJitEmit32(p, 0xfff0);
+    if (flags)
+    {
+      p = cpuJitEmit8(p, 0x83); // or dword [rax], imm8
+      p = cpuJitEmit8(p, 0x08);
+      p = cpuJitEmit8(p, flags);
+    }
+    return p;
+  }
+#endif
+
+  // movea.l dn/an,am
+  if ((opcode & 0xf1f0) == 0x2040)
+  {
+    p = cpuJitGetReg(p, opcode & 0xf);
+    return cpuJitSetReg(p, an);
+  }
+
+  // movea.w dn/an,am
+  if ((opcode & 0xf1f0) == 0x3040)
+  {
+    p = cpuJitGetRegWordSignExt(p, opcode & 0xf);
+    return cpuJitSetReg(p, an);
+  }
+
+  // addq/subq #data,an
+  switch (opcode & 0xf1f8)
+  {
+    case 0x5048: case 0x5088: case 0x5148: case 0x5188:
+    {
+      uint32_t data = (opcode >> 9) & 7;
+      if (!data) data = 8;
+
+      p = cpuJitEmit8(p, 0x83); // add/sub dword [rbx + an*4], imm8
+      p = cpuJitEmit8(p, (opcode & 0x0100) ? 0x6b : 0x43);
+      p = cpuJitEmit8(p, ((opcode & 7) + 8) * 4);
+      return cpuJitEmit8(p, data);
+    }
+  }
+
+  // lea (an),am
+  if ((opcode & 0xf1f8) == 0x41d0)
+  {
+    p = cpuJitGetReg(p, (opcode & 7) + 8);
+    return cpuJitSetReg(p, an);
+  }
+
+  // lea d16(an),am -- the displacement is the prefetch word.
+  if ((opcode & 0xf1f8) == 0x41e8)
+  {
+    p = cpuJitGetReg(p, (opcode & 7) + 8);
+    p = cpuJitEmit8(p, 0x05); // add eax, imm32
+    p = cpuJitEmit32(p, cpuSignExtWordToLong(entry->prefetch));
+    return cpuJitSetReg(p, an);
+  }
+
+  return NULL;
+}
+
+/// <summary>
+/// Emits a call to the opcode handler, set up like cpuExecuteInstruction.
+/// </summary>
+static uint8_t *cpuJitCall(uint8_t *p, cpuBlockInstruction *entry)
+{
+  p = cpuJitStore8(p, &cpu_instruction_aborted, 0);
+  p = cpuJitStore32(p, &cpu_original_pc, entry->pc);
+  p = cpuJitStore32(p, &cpu_pc, entry->pc + 2);
+#ifdef CPU_ACCURATE_PREFETCH
+  p = cpuJitStore16(p, &cpu_prefetch_word, entry->prefetch);
+#endif
+#ifdef CPU_CYCLE_ACCOUNTING
+  p = cpuJitStore32(p, &cpu_instruction_time, 0);
+#endif
+
+  p = cpuJitEmit8(p, 0x48); // mov rdi, data
+  p = cpuJitEmit8(p, 0xbf);
+  p = cpuJitEmit64(p, (uint64_t)(uintptr_t)entry->data);
+  p = cpuJitLoadRax(p, (const void *)entry->instruction_func);
+  p = cpuJitEmit8(p, 0xff); // call rax
+  return cpuJitEmit8(p, 0xd0);
+}
+
+/// <summary>
+/// Translates a recorded block.  Returns NULL when the code buffer is full.
+/// </summary>
+cpuJitFunction cpuJitTranslate(cpuBlock *block)
+{
+  uint8_t *start, *exit, *entry_point, *p;
+  BOOLE after_call = FALSE;
+  uint32_t i;
+
+  if (CPU_JIT_CODE_SIZE - cpu_jit_code_used < 32 + block->count * CPU_JIT_MAX_INSTRUCTION_SIZE)
+    return NULL;
+
+  start = p = cpu_jit_code + cpu_jit_code_used;
+
+  // shared exit: pop rbx; ret
+  exit = p;
+  p = cpuJitEmit8(p, 0x5b);
+  p = cpuJitEmit8(p, 0xc3);
+
+  // push rbx (also aligns the stack for calls); mov rbx, cpu_regs
+  entry_point = p;
+  p = cpuJitEmit8(p, 0x53);
+  p = cpuJitEmit8(p, 0x48);
+  p = cpuJitEmit8(p, 0xbb);
+  p = cpuJitEmit64(p, (uint64_t)(uintptr_t)cpu_regs);
+
+  for (i = 0; i < block->count; ++i)
+  {
+    cpuBlockInstruction *entry = &block->instructions[i];
+    uint8_t *q;
+
+    if (after_call)
+    {
+      p = cpuJitExitIfNotEqual(p, exit, &cpu_block_cache_generation, block->generation, i);
+      p = cpuJitExitIfSet(p, exit, &cpu_sr, 0xc000, i);
+      p = cpuJitExitIfNotEqual(p, exit, &cpu_pc, entry->pc, i);
+    }
+
+    // the last instruction always goes through the handler so the
+    // pc and prefetch word are left in order.
+    q = i + 1 < block->count ? cpuJitInline(p, entry) : NULL;
+    if (q)
+    {
+      p = q;
+      after_call = FALSE;
+    }
+    else
+    {
+      p = cpuJitCall(p, entry);
+      after_call = TRUE;
+    }
+  }
+
+  p = cpuJitExit(p, exit, block->count);
+
+  cpu_jit_code_used += (uint32_t)(p - start);
+  cpu_jit_code_used = (cpu_jit_code_used + 15) & ~15;
+
+  return (cpuJitFunction)(void *)entry_point;
+}
+
+#else
+
+BOOLE cpuSetJit(BOOLE enable)
+{
+  return !enable;
+}
+
+void cpuJitFlush(void)
+{
+}
+
+cpuJitFunction cpuJitTranslate(cpuBlock *block)
+{
+  return NULL;
+}
+
+#endif
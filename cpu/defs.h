@@ -18,6 +18,15 @@ typedef int BOOLE;
 #define FALSE 0
 #define TRUE  1
 
+// MPW -- with CPU_THREAD_LOCAL_STATE each host thread runs its own cpu:
+// registers, flags, block cache, JIT and the memory layer are thread
+// local.  __thread (not thread_local) so C and C++ agree on the symbols.
+#ifdef CPU_THREAD_LOCAL_STATE
+#define CPU_THREAD_LOCAL __thread
+#else
+#define CPU_THREAD_LOCAL
+#endif
+
 /*
 #ifndef X64
 #define PTR_TO_INT(i) ((uint32_t)i)
@@ -8,6 +8,31 @@ extern "C" {
 extern void memorySetMemory(uint8_t *memory, uint32_t size);
 extern void memorySetGlobalLog(uint32_t globalLog);
 extern uint8_t *memoryPointer(uint32_t address);
+extern uint32_t memoryGetSize(void);
+extern void memoryMarkCode(uint32_t address, uint32_t size);
+extern BOOLE memoryIsCode(uint32_t address, uint32_t size);
+extern void memoryClearCode(void);
+extern void memoryUpdateFastPath(void);
+extern BOOLE memorySetAddress32Bit(BOOLE address32bit); // FALSE - 24-bit addresses.
+extern BOOLE memoryGetAddress32Bit(void);
+extern uint32_t memoryStripAddress(uint32_t address);
+
+// fast path -- an access of size bytes at address is a plain host access
+// of memory_fast_base + address when address < memory_fast_limit[size].
+extern CPU_THREAD_LOCAL uint8_t *memory_fast_base;
+extern CPU_THREAD_LOCAL uint32_t memory_fast_limit[9];
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define memoryHostToBig16(x) __builtin_bswap16(x)
+#define memoryHostToBig32(x) __builtin_bswap32(x)
+#define memoryHostToBig64(x) __builtin_bswap64(x)
+#elif defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define memoryHostToBig16(x) (x)
+#define memoryHostToBig32(x) (x)
+#define memoryHostToBig64(x) (x)
+#else
+#define MEMORY_NO_FAST_PATH
+#endif
 
 
 /* Access for chipset emulation that already have validated addresses */
@@ -29,6 +54,11 @@ extern void memoryWriteWord(uint16_t data, uint32_t address);
 extern void memoryWriteLong(uint32_t data, uint32_t address);
 extern void memoryWriteLongLong(uint64_t data, uint32_t address);
 
+// MPW -- bulk access.
+extern void memoryReadLongs(uint32_t *dest, uint32_t address, uint32_t count);
+extern void memoryWriteLongs(const uint32_t *src, uint32_t address, uint32_t count);
+extern void memoryMove(uint32_t dest, uint32_t source, uint32_t size);
+
 extern uint16_t memoryChipReadWord(uint32_t address);
 extern void memoryChipWriteWord(uint16_t data, uint32_t address);
 
@@ -128,8 +158,6 @@ extern BOOLE memorySetSlowSize(uint32_t bogosize);
 extern uint32_t memoryGetSlowSize(void);
 extern bool memorySetUseAutoconfig(bool useautoconfig);
 extern bool memoryGetUseAutoconfig(void);
-extern BOOLE memorySetAddress32Bit(BOOLE address32bit);
-extern BOOLE memoryGetAddress32Bit(void);
 extern BOOLE memorySetKickImage(char *kickimage);
 extern BOOLE memorySetKickImageExtended(char *kickimageext);
 extern char *memoryGetKickImage(void);
@@ -171,8 +199,8 @@ extern uint8_t memory_emem[];
 
 extern uint32_t potgor;
 
-extern uint32_t memory_fault_address;
-extern BOOLE memory_fault_read;
+extern CPU_THREAD_LOCAL uint32_t memory_fault_address;
+extern CPU_THREAD_LOCAL BOOLE memory_fault_read;
 
 
 #ifdef __cplusplus
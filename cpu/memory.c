@@ -1,3 +1,6 @@
+#include <stdlib.h>
+#include <string.h>
+
 #include "defs.h"
 #include "fmem.h"
 #include "CpuModule.h"
@@ -7,8 +10,8 @@
 /* Illegal read / write fault information                                     */
 /*============================================================================*/
 
-BOOLE memory_fault_read = FALSE;                       /* TRUE - read / FALSE - write */
-uint32_t memory_fault_address = 0;
+CPU_THREAD_LOCAL BOOLE memory_fault_read = FALSE;                       /* TRUE - read / FALSE - write */
+CPU_THREAD_LOCAL uint32_t memory_fault_address = 0;
 
 /*==============================================================================
 Raises exception 3 when a word or long is accessing an odd address
@@ -44,15 +47,26 @@ static void memoryOddWrite(uint32_t address)
 
 // new memory functions.
 
-static uint8_t *Memory = NULL;
-static uint32_t MemorySize = 0;
-static uint32_t MemoryGlobalLog = 0;
+static CPU_THREAD_LOCAL uint8_t *Memory = NULL;
+static CPU_THREAD_LOCAL uint32_t MemorySize = 0;
+static CPU_THREAD_LOCAL uint32_t MemoryGlobalLog = 0;
+
+static CPU_THREAD_LOCAL memoryLoggingFunc MemoryLoggingFunc = NULL;
 
-static memoryLoggingFunc MemoryLoggingFunc = NULL;
+// MPW -- 0x00ffffff in 24-bit mode.  Only the slow path masks; see below.
+static CPU_THREAD_LOCAL uint32_t MemoryAddressMask = 0xffffffff;
+
+// MPW -- one byte per 32-byte line, set when the line holds code
+// in the block cache.  Writes to a marked line flush the cache.
+#define MEMORY_CODE_SHIFT 5
+static CPU_THREAD_LOCAL uint8_t *MemoryCodeMap = NULL;
+static CPU_THREAD_LOCAL uint32_t MemoryCodeLow = 0xffffffff;
+static CPU_THREAD_LOCAL uint32_t MemoryCodeHigh = 0;
 
 void memorySetLoggingFunc(memoryLoggingFunc func)
 {
 	MemoryLoggingFunc = func;
+	memoryUpdateFastPath();
 }
 
 
@@ -60,6 +74,16 @@ void memorySetMemory(uint8_t *memory, uint32_t size)
 {
 	Memory = memory;
 	MemorySize = size;
+
+	free(MemoryCodeMap);
+	MemoryCodeMap = NULL;
+	MemoryCodeLow = 0xffffffff;
+	MemoryCodeHigh = 0;
+	if (size)
+		MemoryCodeMap = calloc((size >> MEMORY_CODE_SHIFT) + 1, 1);
+
+	memoryUpdateFastPath();
+	cpuBlockCacheFlush();
 }
 
 void memorySetGlobalLog(uint32_t globalLog)
@@ -70,13 +94,192 @@ void memorySetGlobalLog(uint32_t globalLog)
 
 uint8_t *memoryPointer(uint32_t address)
 {
-	return Memory + address;
+	return Memory + (address & MemoryAddressMask);
+}
+
+/*
+ * MPW -- 24-bit addressing (--24), for code that keeps flags in the high
+ * byte of pointers.  The fast path is the same in both modes: memory is
+ * at most 16M in 24-bit mode, so an address with the high byte set is
+ * never fast and the slow path masks it.  32-bit mode pays nothing on
+ * the fast path.  Returns TRUE if the mode changed.
+ */
+BOOLE memorySetAddress32Bit(BOOLE address32bit)
+{
+	uint32_t mask = address32bit ? 0xffffffff : 0x00ffffff;
+	BOOLE changed = mask != MemoryAddressMask;
+
+	MemoryAddressMask = mask;
+	if (changed) cpuBlockCacheFlush();
+	return changed;
+}
+
+BOOLE memoryGetAddress32Bit(void)
+{
+	return MemoryAddressMask == 0xffffffff;
+}
+
+// the address the memory layer uses -- the high byte is dropped in 24-bit mode.
+uint32_t memoryStripAddress(uint32_t address)
+{
+	return address & MemoryAddressMask;
+}
+
+uint32_t memoryGetSize(void)
+{
+	return MemorySize;
+}
+
+void memoryMarkCode(uint32_t address, uint32_t size)
+{
+	uint32_t first, last;
+
+	address &= MemoryAddressMask;
+	if (!MemoryCodeMap || !size || address >= MemorySize) return;
+	if (size > MemorySize - address) size = MemorySize - address;
+
+	first = address >> MEMORY_CODE_SHIFT;
+	last = (address + size - 1) >> MEMORY_CODE_SHIFT;
+
+	if (first < MemoryCodeLow) MemoryCodeLow = first;
+	if (last > MemoryCodeHigh) MemoryCodeHigh = last;
+
+	for ( ; first <= last; ++first)
+		MemoryCodeMap[first] = 1;
+}
+
+BOOLE memoryIsCode(uint32_t address, uint32_t size)
+{
+	uint32_t first, last;
+
+	address &= MemoryAddressMask;
+	if (!MemoryCodeMap || !size || address >= MemorySize) return FALSE;
+	if (size > MemorySize - address) size = MemorySize - address;
+
+	first = address >> MEMORY_CODE_SHIFT;
+	last = (address + size - 1) >> MEMORY_CODE_SHIFT;
+
+	if (first < MemoryCodeLow) first = MemoryCodeLow;
+	if (last > MemoryCodeHigh) last = MemoryCodeHigh;
+
+	for ( ; first <= last; ++first)
+		if (MemoryCodeMap[first]) return TRUE;
+
+	return FALSE;
+}
+
+void memoryClearCode(void)
+{
+	if (MemoryCodeMap && MemoryCodeLow <= MemoryCodeHigh)
+		memset(MemoryCodeMap + MemoryCodeLow, 0, MemoryCodeHigh - MemoryCodeLow + 1);
+
+	MemoryCodeLow = 0xffffffff;
+	MemoryCodeHigh = 0;
+}
+
+// a guest write hit a line of cached code.
+static void memoryCodeWrite(uint32_t first, uint32_t last)
+{
+	if (MemoryCodeMap[first >> MEMORY_CODE_SHIFT] | MemoryCodeMap[last >> MEMORY_CODE_SHIFT])
+		cpuBlockCacheFlush();
+}
+
+/*============================================================================*/
+/* MPW -- fast path                                                           */
+/*                                                                            */
+/* An access takes the fast path when the address is below the limit for its */
+/* size.  The limits are recalculated when the memory, the logging function   */
+/* or the cpu model changes, and are 0 (nothing is fast) while logging is on  */
+/* or when odd addresses must fault (68000/68010).  The slow path keeps the   */
+/* original checks.                                                           */
+/*============================================================================*/
+
+CPU_THREAD_LOCAL uint8_t *memory_fast_base = NULL;
+CPU_THREAD_LOCAL uint32_t memory_fast_limit[9]; // by access size
+
+void memoryUpdateFastPath(void)
+{
+	BOOLE fast = Memory && !MemoryLoggingFunc && cpuGetModelMajor() >= 2;
+
+#ifdef MEMORY_NO_FAST_PATH
+	fast = FALSE;
+#endif
+
+	memory_fast_base = Memory;
+	for (uint32_t size = 1; size <= 8; size <<= 1)
+		memory_fast_limit[size] = (fast && MemorySize >= size) ? MemorySize - size + 1 : 0;
+}
+
+#ifndef MEMORY_NO_FAST_PATH
+
+static uint16_t memoryLoad16(uint32_t address)
+{
+	uint16_t value;
+	memcpy(&value, Memory + address, sizeof(value));
+	return memoryHostToBig16(value);
+}
+
+static uint32_t memoryLoad32(uint32_t address)
+{
+	uint32_t value;
+	memcpy(&value, Memory + address, sizeof(value));
+	return memoryHostToBig32(value);
+}
+
+static uint64_t memoryLoad64(uint32_t address)
+{
+	uint64_t value;
+	memcpy(&value, Memory + address, sizeof(value));
+	return memoryHostToBig64(value);
+}
+
+static void memoryStore16(uint32_t address, uint16_t value)
+{
+	value = memoryHostToBig16(value);
+	memcpy(Memory + address, &value, sizeof(value));
+}
+
+static void memoryStore32(uint32_t address, uint32_t value)
+{
+	value = memoryHostToBig32(value);
+	memcpy(Memory + address, &value, sizeof(value));
+}
+
+static void memoryStore64(uint32_t address, uint64_t value)
+{
+	value = memoryHostToBig64(value);
+	memcpy(Memory + address, &value, sizeof(value));
+}
+
+#define memoryIsFast(address, size) ((address) < memory_fast_limit[size])
+#define memoryIsFastRange(address, size) ((size) <= memory_fast_limit[1] && (address) <= memory_fast_limit[1] - (size))
+
+#else
+
+#define memoryIsFast(address, size) FALSE
+#define memoryIsFastRange(address, size) FALSE
+#define memoryLoad16(address) 0
+#define memoryLoad32(address) 0
+#define memoryLoad64(address) 0
+#define memoryStore16(address, value)
+#define memoryStore32(address, value)
+#define memoryStore64(address, value)
+
+#endif
+
+// written as address <= MemorySize - size so that an address near
+// 0xffffffff doesn't wrap around (address + 1 < MemorySize did).
+static BOOLE memoryInRange(uint32_t address, uint32_t size)
+{
+	return MemorySize >= size && address <= MemorySize - size;
 }
 
-// memory read of 0xffffffff not handled correctly
-// since the unsigned compare overflows.
 uint8_t memoryReadByte(uint32_t address)
 {
+	if (memoryIsFast(address, 1))
+		return Memory[address];
+
+	address &= MemoryAddressMask;
 
 	if (MemoryLoggingFunc)
 		MemoryLoggingFunc(address, 1, 0, 0);
@@ -90,13 +293,17 @@ uint8_t memoryReadByte(uint32_t address)
 
 uint16_t memoryReadWord(uint32_t address)
 {
+	if (memoryIsFast(address, 2))
+		return memoryLoad16(address);
+
+	address &= MemoryAddressMask;
 
 	if (MemoryLoggingFunc)
 		MemoryLoggingFunc(address, 2, 0, 0);
 
 	if (address & 0x01) memoryOddRead(address);
 
-	if (address + 1 < MemorySize)
+	if (memoryInRange(address, 2))
 		return (Memory[address + 0] << 8) 
 			| (Memory[address + 1] << 0); 
 
@@ -105,13 +312,17 @@ uint16_t memoryReadWord(uint32_t address)
 
 uint32_t memoryReadLong(uint32_t address)
 {
+	if (memoryIsFast(address, 4))
+		return memoryLoad32(address);
+
+	address &= MemoryAddressMask;
 
 	if (MemoryLoggingFunc)
 		MemoryLoggingFunc(address, 4, 0, 0);
 
 	if (address & 0x01) memoryOddRead(address);
 
-	if (address + 3 < MemorySize)
+	if (memoryInRange(address, 4))
 		return (Memory[address + 0] << 24) 
 			| (Memory[address + 1] << 16)
 			| (Memory[address + 2] << 8)
@@ -125,6 +336,9 @@ uint64_t memoryReadLongLong(uint32_t address)
 {
 	uint64_t tmp;
 
+	if (memoryIsFast(address, 8))
+		return memoryLoad64(address);
+
 	tmp = memoryReadLong(address);
 	tmp <<= 32;
 	tmp |= memoryReadLong(address + 4);
@@ -134,26 +348,44 @@ uint64_t memoryReadLongLong(uint32_t address)
 
 void memoryWriteByte(uint8_t data, uint32_t address)
 {
+	if (memoryIsFast(address, 1))
+	{
+		memoryCodeWrite(address, address);
+		Memory[address] = data;
+		return;
+	}
+
+	address &= MemoryAddressMask;
 
 	if (MemoryLoggingFunc)
 		MemoryLoggingFunc(address, 1, 1, data);
 
 	if (address < MemorySize)
 	{
+		memoryCodeWrite(address, address);
 		Memory[address] = data;
 	}
 }
 
 void memoryWriteWord(uint16_t data, uint32_t address)
 {
+	if (memoryIsFast(address, 2))
+	{
+		memoryCodeWrite(address, address + 1);
+		memoryStore16(address, data);
+		return;
+	}
+
+	address &= MemoryAddressMask;
 
 	if (MemoryLoggingFunc)
 		MemoryLoggingFunc(address, 2, 1, data);
 
 	if (address & 0x01) memoryOddWrite(address);
 
-	if (address + 1 < MemorySize)
+	if (memoryInRange(address, 2))
 	{
+		memoryCodeWrite(address, address + 1);
 		Memory[address++] = data >> 8;
 		Memory[address++] = data >> 0;
 	}
@@ -161,6 +393,14 @@ void memoryWriteWord(uint16_t data, uint32_t address)
 
 void memoryWriteLong(uint32_t data, uint32_t address)
 {
+	if (memoryIsFast(address, 4))
+	{
+		memoryCodeWrite(address, address + 3);
+		memoryStore32(address, data);
+		return;
+	}
+
+	address &= MemoryAddressMask;
 
 	if (MemoryLoggingFunc)
 		MemoryLoggingFunc(address, 4, 1, data);
@@ -168,8 +408,9 @@ void memoryWriteLong(uint32_t data, uint32_t address)
 
 	if (address & 0x01) memoryOddWrite(address);
 
-	if (address + 3 < MemorySize)
+	if (memoryInRange(address, 4))
 	{
+		memoryCodeWrite(address, address + 3);
 		Memory[address++] = data >> 24;
 		Memory[address++] = data >> 16;
 		Memory[address++] = data >> 8;
@@ -180,11 +421,20 @@ void memoryWriteLong(uint32_t data, uint32_t address)
 
 void memoryWriteLongLong(uint64_t data, uint32_t address)
 {
+	if (memoryIsFast(address, 8))
+	{
+		memoryCodeWrite(address, address + 7);
+		memoryStore64(address, data);
+		return;
+	}
+
+	address &= MemoryAddressMask;
 
 	if (address & 0x01) memoryOddWrite(address);
 
-	if (address + 7 < MemorySize)
+	if (memoryInRange(address, 8))
 	{
+		memoryCodeWrite(address, address + 7);
 		Memory[address++] = data >> 56;
 		Memory[address++] = data >> 48;
 		Memory[address++] = data >> 40;
@@ -197,3 +447,75 @@ void memoryWriteLongLong(uint64_t data, uint32_t address)
 
 }
 
+
+/*============================================================================*/
+/* MPW -- bulk access                                                         */
+/*                                                                            */
+/* One range check for the whole transfer, then a byte-swapping copy.  Out   */
+/* of the fast path every long goes through memoryReadLong/memoryWriteLong,  */
+/* lowest address first.                                                      */
+/*============================================================================*/
+
+void memoryReadLongs(uint32_t *dest, uint32_t address, uint32_t count)
+{
+	uint32_t i;
+
+	if (count <= 0x3fffffff && memoryIsFastRange(address, count * 4))
+	{
+		for (i = 0; i < count; ++i)
+			dest[i] = memoryLoad32(address + i * 4);
+		return;
+	}
+
+	for (i = 0; i < count; ++i)
+		dest[i] = memoryReadLong(address + i * 4);
+}
+
+void memoryWriteLongs(const uint32_t *src, uint32_t address, uint32_t count)
+{
+	uint32_t i;
+
+	if (count && count <= 0x3fffffff && memoryIsFastRange(address, count * 4))
+	{
+		if (memoryIsCode(address, count * 4)) cpuBlockCacheFlush();
+		for (i = 0; i < count; ++i)
+			memoryStore32(address + i * 4, src[i]);
+		return;
+	}
+
+	for (i = 0; i < count; ++i)
+		memoryWriteLong(src[i], address + i * 4);
+}
+
+/*
+ * memmove within emulated memory (BlockMove, HandToHand, ...).  This is a
+ * host side copy so it isn't logged.  Bytes past the end of memory read as
+ * 0 and writes there are dropped.
+ */
+void memoryMove(uint32_t dest, uint32_t source, uint32_t size)
+{
+	uint32_t i;
+
+	if (!size) return;
+
+	dest &= MemoryAddressMask;
+	source &= MemoryAddressMask;
+
+	if (memoryInRange(dest, size) && memoryInRange(source, size))
+	{
+		memmove(Memory + dest, Memory + source, size);
+		cpuBlockCacheInvalidate(dest, size);
+		return;
+	}
+
+	if (dest <= source)
+	{
+		for (i = 0; i < size; ++i)
+			memoryWriteByte(memoryReadByte(source + i), dest + i);
+	}
+	else
+	{
+		for (i = size; i-- > 0; )
+			memoryWriteByte(memoryReadByte(source + i), dest + i);
+	}
+}
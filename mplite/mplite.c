@@ -50,6 +50,8 @@ static int mplite_size(const mplite_t *handle, const void *p);
 static void mplite_link(mplite_t *handle, const int i, const int iLogsize);
 static void mplite_unlink(mplite_t *handle, const int i, const int iLogsize);
 static void *mplite_malloc_unsafe(mplite_t *handle, const int nByte);
+static void *mplite_carve(mplite_t *handle, int i, int iBin,
+                          const int iLogsize, const int nByte);
 static void mplite_free_unsafe(mplite_t *handle, const void *pOld);
 
 MPLITE_API int mplite_init(mplite_t *handle, const void *buf,
@@ -235,6 +237,61 @@ MPLITE_API int mplite_freemem(mplite_t *handle)
     //return handle->szAtom * handle->nBlock - handle->currentOut;
 }
 
+MPLITE_API int mplite_blocksize(const mplite_t *handle, const void *p)
+{
+    if (NULL == handle || NULL == p) return 0;
+    return mplite_size(handle, p);
+}
+
+
+MPLITE_API void *mplite_malloc_at(mplite_t *handle, const void *p,
+                                  const int nBytes)
+{
+    int i, iBin, iLogsize, iFullSz;
+    void *rv;
+
+    /* Check the parameters */
+    if ((NULL == handle) || (NULL == p) || (nBytes <= 0) ||
+        (nBytes > MPLITE_MAX_ALLOC_SIZE)) {
+        return NULL;
+    }
+
+    i = (int)((uint8_t *) p - handle->zPool) / handle->szAtom;
+    if (i < 0 || i >= handle->nBlock ||
+        ((uint8_t *) p - handle->zPool) % handle->szAtom) {
+        return NULL;
+    }
+
+    for (iFullSz = handle->szAtom, iLogsize = 0; iFullSz < nBytes;
+        iFullSz *= 2, iLogsize++) {
+    }
+
+    mplite_enter(handle);
+    rv = NULL;
+    iBin = handle->aCtrl[i] & MPLITE_CTRL_LOGSIZE;
+    if ((handle->aCtrl[i] & MPLITE_CTRL_FREE) && iBin >= iLogsize) {
+        mplite_unlink(handle, i, iBin);
+        rv = mplite_carve(handle, i, iBin, iLogsize, nBytes);
+    }
+    mplite_leave(handle);
+
+    return rv;
+}
+
+MPLITE_API void mplite_walk(const mplite_t *handle,
+                            const mplite_walkfunc_t walkfunc, void *context)
+{
+    int i, iLogsize;
+
+    if ((NULL == handle) || (NULL == walkfunc)) return;
+
+    for (i = 0; i < handle->nBlock; i += (1 << iLogsize)) {
+        iLogsize = handle->aCtrl[i] & MPLITE_CTRL_LOGSIZE;
+        walkfunc(context, &handle->zPool[i * handle->szAtom],
+                 handle->szAtom << iLogsize,
+                 (handle->aCtrl[i] & MPLITE_CTRL_FREE) != 0);
+    }
+}
 
 MPLITE_API int mplite_roundup(mplite_t *handle, const int n)
 {
@@ -414,6 +471,18 @@ static void *mplite_malloc_unsafe(mplite_t *handle, const int nByte)
     i = handle->aiFreelist[iBin];
     mplite_unlink(handle, i, iBin);
 
+    return mplite_carve(handle, i, iBin, iLogsize, nByte);
+}
+
+/*
+ ** Check out the first iLogsize block of the (unlinked) free block i,
+ ** returning the rest to the free lists.
+ */
+static void *mplite_carve(mplite_t *handle, int i, int iBin,
+                          const int iLogsize, const int nByte)
+{
+    int iFullSz = handle->szAtom << iLogsize;
+
     while (iBin > iLogsize) {
         int newSize;
 
@@ -128,6 +128,13 @@ typedef struct mplite {
  */
 typedef int (*mplite_putsfunc_t)(const char* stats);
 
+/**
+ * @brief Block function pointer to be passed to @ref mplite_walk function.
+ *        It's called with each block, allocated or free, in address order.
+ */
+typedef void (*mplite_walkfunc_t)(void *context, const void *p, int size,
+                                  int free);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -226,6 +233,17 @@ MPLITE_API int mplite_maxmem(mplite_t *handle);
 /* return the total available memory */
 MPLITE_API int mplite_freemem(mplite_t *handle);
 
+/* return the size of an allocated block, including internal fragmentation */
+MPLITE_API int mplite_blocksize(const mplite_t *handle, const void *p);
+
+/* allocate nBytes at the start of the free block p (for compaction) */
+MPLITE_API void *mplite_malloc_at(mplite_t *handle, const void *p,
+                                  const int nBytes);
+
+/* call walkfunc with every block, in address order */
+MPLITE_API void mplite_walk(const mplite_t *handle,
+                            const mplite_walkfunc_t walkfunc, void *context);
+
 #ifdef __cplusplus
 }
 #endif
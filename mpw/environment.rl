@@ -115,7 +115,7 @@ namespace _env_rl {
 
 namespace MPW
 {
-	extern std::unordered_map<std::string, std::string> Environment;
+	std::unordered_map<std::string, std::string> &Environment();
 
 	std::string ExpandVariables(const std::string &s, bool pathname = false);
 }
@@ -184,8 +184,8 @@ namespace {
 			'{' [A-Za-z0-9_]+ '}' {
 
 				std::string name(ts + 1, te - 1);
-				auto iter = Environment.find(name);
-				if (iter != Environment.end())
+				auto iter = Environment().find(name);
+				if (iter != Environment().end())
 					rv.append(iter->second);
 
 				fgoto coalesce_colon;
@@ -198,8 +198,8 @@ namespace {
 					rv.append(ts, te);
 				} else {
 					std::string name(ts + 2, te - 1);
-					auto iter = Environment.find(name);
-					if (iter != Environment.end())
+					auto iter = Environment().find(name);
+					if (iter != Environment().end())
 						rv.append(iter->second);
 
 					fgoto coalesce_colon;
@@ -214,8 +214,8 @@ namespace {
 					rv.append(ts, te);
 				} else {
 					std::string name(ts + 1, te);
-					auto iter = Environment.find(name);
-					if (iter != Environment.end())
+					auto iter = Environment().find(name);
+					if (iter != Environment().end())
 						rv.append(iter->second);
 
 					fgoto coalesce_colon;
@@ -293,10 +293,10 @@ namespace {
 		std::string value(p, pe);
 		value = MPW::ExpandVariables(value);
 
-		auto iter = MPW::Environment.find(name);
-		if (iter == MPW::Environment.end())
+		auto iter = MPW::Environment().find(name);
+		if (iter == MPW::Environment().end())
 		{
-			MPW::Environment.emplace(std::move(name), std::move(value));
+			MPW::Environment().emplace(std::move(name), std::move(value));
 		}
 		else
 		{
@@ -323,8 +323,8 @@ namespace MPW {
 
 	std::string GetEnv(const std::string &key)
 	{
-		auto iter = Environment.find(key);
-		if (iter == Environment.end()) return "";
+		auto iter = Environment().find(key);
+		if (iter == Environment().end()) return "";
 		return iter->second;
 	}
 
@@ -376,9 +376,9 @@ namespace MPW {
 			auto pos = s.find('=');
 			if (pos == 0) continue;
 			if (pos == s.npos) {
-				MPW::Environment.emplace(std::move(s), "");
+				MPW::Environment().emplace(std::move(s), "");
 			} else {
-				MPW::Environment.emplace(s.substr(0, pos), s.substr(pos+1));
+				MPW::Environment().emplace(s.substr(0, pos), s.substr(pos+1));
 			}
 
 		}
@@ -451,7 +451,11 @@ namespace MPW {
 
 namespace MPW
 {
-	std::unordered_map<std::string, std::string> Environment;
+	std::unordered_map<std::string, std::string> &Environment()
+	{
+		static std::unordered_map<std::string, std::string> env;
+		return env;
+	}
 }
 
 
@@ -472,7 +476,7 @@ int main(int argc, char **argv)
 
 	MPW::EnvLoadFile("/Users/kelvin/mpw/Environment.text");	
 
-	for (auto kv : MPW::Environment)
+	for (auto kv : MPW::Environment())
 	{
 		printf("%s --> %s\n", kv.first.c_str(), kv.second.c_str());
 	}
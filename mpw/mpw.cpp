@@ -51,6 +51,7 @@
 #include <toolbox/toolbox.h>
 #include <toolbox/mm.h>
 #include <toolbox/os_internal.h>
+#include <toolbox/context.h>
 
 #include <macos/sysequ.h>
 
@@ -62,9 +63,11 @@ namespace MPW {
 	// for dup counts, etc.
 	//std::vector<int> FDTable;
 
-	uint32_t MacProgramInfo = 0;
-
-	std::unordered_map<std::string, std::string> Environment;
+	// the current EmulatorContext's environment.
+	std::unordered_map<std::string, std::string> &Environment()
+	{
+		return ToolBox::Context().Environment;
+	}
 
 }
 
@@ -190,7 +193,7 @@ namespace MPW
 			std::string mm = ToolBox::UnixToMac(m);
 			if (mm.back() != ':') mm.push_back(':');
 
-			Environment.emplace(std::string("MPW"), mm);
+			Environment().emplace(std::string("MPW"), mm);
 		}
 
 		EnvLoadEnv(); // should do this first since it could set MPW??
@@ -307,11 +310,11 @@ namespace MPW
 
 		// environment
 		{
-			Environment.emplace(std::string("Command"), command);
+			Environment().emplace(std::string("Command"), command);
 
 			std::deque<std::string> e;
 
-			for (const auto &iter : Environment)
+			for (const auto &iter : Environment())
 			{
 				std::string tmp;
 				tmp.append(iter.first);
@@ -455,7 +458,7 @@ namespace MPW
 		error = MM::Native::NewPtr(8 + 0x30, true, mpi);
 		if (error) return error;
 
-		MacProgramInfo = mpi + 8;
+		ToolBox::Context().MacProgramInfo = mpi + 8;
 
 		memoryWriteLong(0x4d50474d, mpi); // 'MPGM' - magic
 		memoryWriteLong(mpi + 8, mpi + 4);
@@ -486,9 +489,9 @@ namespace MPW
 
 	uint32_t ExitStatus()
 	{
-		if (!MacProgramInfo) return -1;
+		if (!ToolBox::Context().MacProgramInfo) return -1;
 
-		return memoryReadLong(MacProgramInfo + 0x0e);
+		return memoryReadLong(ToolBox::Context().MacProgramInfo + 0x0e);
 	}
 
 
@@ -0,0 +1,126 @@
+#include <MacMemory.h>
+#include <stdio.h>
+
+/*
+ * fills the heap with 16K handles, locks every 8th and disposes every
+ * other one.  No free block is larger than 16K, so a 48K NewHandle,
+ * MaxBlock and growing a handle to 40K only work if the unlocked
+ * handles are moved together.
+ */
+
+enum {
+	kBlockSize = 16 * 1024,
+	kMaxHandles = 4096
+};
+
+Handle handles[kMaxHandles];
+Ptr locked[kMaxHandles];
+unsigned count;
+
+void fill(Handle h, unsigned key, long size)
+{
+	long i;
+	for (i = 0; i < size; ++i) (*h)[i] = (char)(key * 7 + i);
+}
+
+int check(Handle h, unsigned key, long size)
+{
+	long i;
+	for (i = 0; i < size; ++i)
+		if ((*h)[i] != (char)(key * 7 + i)) return 0;
+	return 1;
+}
+
+unsigned check_all(void)
+{
+	unsigned i;
+	unsigned errors = 0;
+
+	for (i = 0; i < count; ++i)
+	{
+		Handle h = handles[i];
+		if (!h) continue;
+
+		if (locked[i] && *h != locked[i])
+		{
+			fprintf(stdout, "locked handle %u moved\n", i);
+			errors++;
+		}
+		if (!check(h, i, kBlockSize))
+		{
+			fprintf(stdout, "handle %u contents changed\n", i);
+			errors++;
+		}
+	}
+	return errors;
+}
+
+int main(void)
+{
+	unsigned i;
+	unsigned errors = 0;
+	long max;
+	Handle big;
+
+	for (count = 0; count < kMaxHandles; ++count)
+	{
+		Handle h = NewHandle(kBlockSize);
+		if (!h) break;
+
+		fill(h, count, kBlockSize);
+		handles[count] = h;
+		locked[count] = 0;
+
+		if ((count & 7) == 0)
+		{
+			HLock(h);
+			locked[count] = *h;
+		}
+	}
+
+	for (i = 1; i < count; i += 2)
+	{
+		DisposeHandle(handles[i]);
+		handles[i] = 0;
+	}
+
+	fprintf(stdout, "%u handles\n", count);
+
+	max = MaxBlock();
+	if (max < 3 * kBlockSize)
+	{
+		fprintf(stdout, "MaxBlock: %ld\n", max);
+		errors++;
+	}
+
+	big = NewHandle(3 * kBlockSize);
+	if (!big)
+	{
+		fprintf(stdout, "NewHandle failed: %d\n", MemError());
+		errors++;
+	}
+	errors += check_all();
+
+	/* an unlocked handle that has to move to grow. */
+	for (i = 2; i < count; i += 2)
+	{
+		if (locked[i]) continue;
+
+		SetHandleSize(handles[i], kBlockSize * 5 / 2);
+		if (MemError())
+		{
+			fprintf(stdout, "SetHandleSize failed: %d\n", MemError());
+			errors++;
+		}
+		else if (GetHandleSize(handles[i]) != kBlockSize * 5 / 2)
+		{
+			fprintf(stdout, "SetHandleSize: wrong size\n");
+			errors++;
+		}
+		break;
+	}
+	errors += check_all();
+
+	fprintf(stdout, "%u errors\n", errors);
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,75 @@
+#include <string.h>
+#include <stdio.h>
+
+/*
+ * StdCLib string and memory routines on pointers with flags in the
+ * high byte, as 24-bit code passes them.  Run with
+ *
+ *   mpw --24 --native-lib=verify test_stdclib_24
+ *
+ * (--native-lib=verify also reports any difference between the native
+ * routines and StdCLib on stderr.)
+ */
+
+#define TAG(p) ((char *)((unsigned long)(p) | 0x80000000))
+#define STRIP(p) ((unsigned long)(p) & 0x00ffffff)
+
+char source[64] = "hello, world";
+char dest[64];
+
+unsigned errors;
+
+void check(int ok, const char *what)
+{
+	if (!ok)
+	{
+		fprintf(stdout, "%s failed\n", what);
+		errors++;
+	}
+}
+
+int main(void)
+{
+	char *s = TAG(source);
+	char *d = TAG(dest);
+	char *p;
+
+	check(strlen(s) == 12, "strlen");
+
+	memset(dest, 'x', sizeof(dest));
+	p = strcpy(d, s);
+	check(p == d, "strcpy result");
+	check(memcmp(dest, "hello, world", 13) == 0, "strcpy");
+
+	memset(dest, 'x', sizeof(dest));
+	strncpy(d, s, 20);
+	check(memcmp(dest, "hello, world\0\0\0\0\0\0\0\0x", 21) == 0, "strncpy");
+
+	strcpy(dest, "say ");
+	strcat(d, s);
+	check(strcmp(dest, "say hello, world") == 0, "strcat");
+
+	check(strcmp(s, TAG("hello, world")) == 0, "strcmp equal");
+	check(strcmp(s, TAG("hello")) > 0, "strcmp greater");
+	check(strncmp(s, TAG("help"), 3) == 0, "strncmp");
+
+	p = strchr(s, 'o');
+	check(p && STRIP(p) == STRIP(source + 4), "strchr");
+	p = strrchr(s, 'o');
+	check(p && STRIP(p) == STRIP(source + 8), "strrchr");
+	p = strchr(s, 0);
+	check(p && STRIP(p) == STRIP(source + 12), "strchr nul");
+
+	memset(d, 'z', 8);
+	check(memcmp(dest, "zzzzzzzz", 8) == 0, "memset");
+	memcpy(d, s, 5);
+	check(memcmp(dest, "hellozzz", 8) == 0, "memcpy");
+	memmove(d + 1, d, 5);
+	check(memcmp(dest, "hhellozz", 8) == 0, "memmove");
+	check(memcmp(d, TAG("hhellozz"), 8) == 0, "memcmp");
+	p = memchr(d, 'o', 8);
+	check(p && STRIP(p) == STRIP(dest + 5), "memchr");
+
+	fprintf(stdout, "%u errors\n", errors);
+	return errors ? 1 : 0;
+}
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef __mpw_toolbox_context_h__
+#define __mpw_toolbox_context_h__
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "loader.h"
+#include "mm.h"
+#include "mm_allocator.h"
+#include "mm_index.h"
+#include "os_internal.h"
+
+/*
+ * per-emulator state for the toolbox and MPW layers.
+ *
+ * Each thread that runs a tool installs its own context with
+ * SetContext before calling into the toolbox.  The cpu and memory
+ * layer keep their state in thread-local storage when built with
+ * CPU_THREAD_LOCAL_STATE, so one context per thread gives a complete,
+ * independent emulator, except for what is still process-wide:
+ *
+ * - the Resource Manager (rm.cpp), which sits on the host's Carbon
+ *   Resource Manager: its open files, current file and ResLoad.
+ * - the File Manager's directory IDs (FSSpecManager) and the host's
+ *   current directory, which relative paths resolve against.
+ * - the trap table and selector tables (dispatch.cpp).  Handlers are
+ *   registered once and the counters are atomic, so these are safe.
+ * - options set from the command line before any tool runs: ToolBox::Trace,
+ *   TrapStats, StdCLib::Mode, MPW::Trace.
+ *
+ * The first two are blockers for running tools on more than one thread.
+ */
+namespace ToolBox {
+
+	struct EmulatorContext
+	{
+		EmulatorContext() = default;
+		EmulatorContext(const EmulatorContext &) = delete;
+		EmulatorContext &operator=(const EmulatorContext &) = delete;
+
+		// emulated memory.
+		uint8_t *Memory = nullptr;
+		uint32_t MemorySize = 0;
+		// freed blocks this large are given back to the host (madvise).
+		// 0 if the memory isn't mmap()ed.
+		uint32_t ReleaseSize = 0;
+
+		// Memory Manager.
+		uint32_t HeapSize = 0;
+		std::unique_ptr<MM::Allocator> Heap;
+		std::deque<uint32_t> HandleQueue; // free handles
+		MM::HandleTable HandleMap; // handle -> info
+		MM::BlockIndex Blocks; // pointers and handle blocks, by address
+		MM::HeapStats HeapStats;
+		uint32_t HandleClock = 0; // HandleInfo::lastUse
+
+		// Trap Manager.  Patched trap addresses (0 if not patched) and
+		// the glue code GetTrapAddress returns for the native traps.
+		uint32_t ToolTrapAddress[1024] = {};
+		uint32_t OSTrapAddress[256] = {};
+		uint32_t ToolGlue = 0;
+		uint32_t OSGlue = 0;
+
+		// Segment Loader.
+		std::string ToolPath;
+		std::vector<Loader::SegmentInfo> Segments;
+
+		// StdCLib patches.
+		unsigned StdCLibMode = 0; // StdCLib::Mode when the tool was loaded
+		std::unordered_map<uint32_t, uint32_t> StdCLibOriginal; // entry -> original code (verify mode)
+		uint32_t StdCLibSentinel = 0;
+		bool StdCLibReturned = false;
+
+		// Time Manager.
+		std::deque<OS::Internal::TimerEntry> TimerQueue;
+
+		// File Manager / MPW file descriptors.
+		std::deque<OS::Internal::FDEntry> FDTable;
+
+		// MPW
+		std::unordered_map<std::string, std::string> Environment;
+		uint32_t MacProgramInfo = 0;
+	};
+
+	extern thread_local EmulatorContext *CurrentContext;
+
+	inline EmulatorContext &Context()
+	{
+		return *CurrentContext;
+	}
+
+	inline void SetContext(EmulatorContext *context)
+	{
+		CurrentContext = context;
+	}
+
+}
+
+#endif
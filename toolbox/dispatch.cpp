@@ -28,8 +28,12 @@
 #include <cstdio>
 #include <cstdint>
 #include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <stdlib.h>
 
@@ -47,9 +51,13 @@
 #include "rm.h"
 #include "sane.h"
 #include "stackframe.h"
+#include "stdclib.h"
 #include "toolbox.h"
 #include "utility.h"
 #include "debug.h"
+#include "dispatch.h"
+#include "context.h"
+#include "state.h"
 
 #include <macos/sysequ.h>
 #include <macos/errors.h>
@@ -61,11 +69,19 @@ extern "C" void cpuSetFlagsNZ00NewW(uint16_t res);
 
 namespace {
 
-	uint32_t trap_address[1024];
-	uint32_t os_address[256];
+	struct TrapEntry {
+		ToolBox::TrapHandler handler = nullptr;
+		const char *name = nullptr;
+		unsigned flags = 0;
+		ToolBox::TrapCounters counters;
+	};
 
-	uint32_t ToolGlue;
-	uint32_t OSGlue;
+	// indexed by trap & 0x0fff.  Shared by every context -- the native
+	// handlers are registered once, before any tool runs.
+	TrapEntry trap_table[0x1000];
+
+	std::mutex selector_mutex;
+	std::vector<ToolBox::SelectorTable *> selector_tables;
 
 
 	inline constexpr bool is_tool_trap(uint16_t trap)
@@ -119,6 +135,7 @@ namespace {
 namespace OS {
 
 	using ToolBox::Log;
+	using ToolBox::Context;
 
 #pragma mark - Trap Manager
 
@@ -140,13 +157,14 @@ namespace OS {
 
 		trapNumber &= 0x03ff;
 
-		if (trap_address[trapNumber])
+		auto &ctx = Context();
+		if (ctx.ToolTrapAddress[trapNumber])
 		{
-			cpuSetAReg(0, trap_address[trapNumber]);
+			cpuSetAReg(0, ctx.ToolTrapAddress[trapNumber]);
 			return 0;
 		}
 
-		cpuSetAReg(0, ToolGlue + trapNumber * 4);
+		cpuSetAReg(0, ctx.ToolGlue + trapNumber * 4);
 		return 0; //MacOS::dsCoreErr;
 	}
 
@@ -176,7 +194,7 @@ namespace OS {
 
 
 		trapNumber &= 0x03ff;
-		trap_address[trapNumber] = trapAddress;
+		Context().ToolTrapAddress[trapNumber] = trapAddress;
 
 		return 0;
 	}
@@ -199,13 +217,14 @@ namespace OS {
 
 		trapNumber &= 0x00ff;
 
-		if (os_address[trapNumber])
+		auto &ctx = Context();
+		if (ctx.OSTrapAddress[trapNumber])
 		{
-			cpuSetAReg(0, os_address[trapNumber]);
+			cpuSetAReg(0, ctx.OSTrapAddress[trapNumber]);
 			return 0;
 		}
 
-		cpuSetAReg(0, OSGlue + trapNumber * 4);
+		cpuSetAReg(0, ctx.OSGlue + trapNumber * 4);
 		return 0; // MacOS::dsCoreErr;
 	}
 
@@ -235,7 +254,7 @@ namespace OS {
 
 
 		trapNumber &= 0x00ff;
-		os_address[trapNumber] = trapAddress;
+		Context().OSTrapAddress[trapNumber] = trapAddress;
 
 		return 0;
 	}
@@ -273,28 +292,29 @@ namespace OS {
 		if (trapNumber >= 0x00 && trapNumber <= 0x4f) os = true;
 		if (trapNumber >= 0x54 && trapNumber <= 0x57) os = true;
 
+		auto &ctx = Context();
 		if (os)
 		{
 
-			if (os_address[trapNumber])
+			if (ctx.OSTrapAddress[trapNumber])
 			{
-				cpuSetAReg(0, os_address[trapNumber]);
+				cpuSetAReg(0, ctx.OSTrapAddress[trapNumber]);
 				return 0;
 			}
 
-			cpuSetAReg(0, OSGlue + trapNumber * 4);
+			cpuSetAReg(0, ctx.OSGlue + trapNumber * 4);
 			return 0;
 
 		}
 		else
 		{
-			if (trap_address[trapNumber])
+			if (ctx.ToolTrapAddress[trapNumber])
 			{
-				cpuSetAReg(0, trap_address[trapNumber]);
+				cpuSetAReg(0, ctx.ToolTrapAddress[trapNumber]);
 				return 0;
 			}
 
-			cpuSetAReg(0, ToolGlue + trapNumber * 4);
+			cpuSetAReg(0, ctx.ToolGlue + trapNumber * 4);
 			return 0;			
 		}
 
@@ -304,44 +324,24 @@ namespace OS {
 
 	uint16_t OSDispatch(uint16_t trap)
 	{
+		static ToolBox::SelectorTable table("OSDispatch", {
+			{ 0x0015, "TempMaxMem", MM::TempMaxMem },
+			{ 0x0018, "TempFreeMem", MM::TempFreeMem },
+			{ 0x001d, "TempNewHandle", MM::TempNewHandle },
+			{ 0x001e, "TempHLock", MM::TempHLock },
+			{ 0x001f, "TempHUnlock", MM::TempHUnlock },
+			{ 0x0020, "TempDisposeHandle", MM::TempDisposeHandle },
+			{ 0x0037, "GetCurrentProcess", Process::GetCurrentProcess },
+			{ 0x003a, "GetProcessInformation", Process::GetProcessInformation },
+		});
+
 		uint16_t selector;
 
 
 		StackFrame<2>(selector);
 		Log("%04x OSDispatch(%04x)\n", trap, selector);
 
-		switch(selector)
-		{
-			case 0x0015:
-				return MM::TempMaxMem();
-
-			case 0x0018:
-				return MM::TempFreeMem();
-
-			case 0x001d:
-				return MM::TempNewHandle();
-
-			case 0x001e:
-				return MM::TempHLock();
-
-			case 0x001f:
-				return MM::TempHUnlock();
-
-			case 0x0020:
-				return MM::TempDisposeHandle();
-
-			case 0x0037:
-				return Process::GetCurrentProcess();
-
-			case 0x003a:
-				return Process::GetProcessInformation();
-
-			default:
-				fprintf(stderr, "OSDispatch: selector %04x not implemented\n",
-					selector);
-				exit(1);
-		}
-
+		return table.dispatch(selector);
 	}
 
 
@@ -349,17 +349,22 @@ namespace OS {
 
 namespace ToolBox {
 
+	bool TrapStats = false;
+
+	void RegisterNativeTraps();
+
 	bool Init() {
 		//
-		std::fill(std::begin(trap_address), std::end(trap_address), 0);
-		std::fill(std::begin(os_address), std::end(os_address), 0);
+		auto &ctx = Context();
+		std::fill(std::begin(ctx.ToolTrapAddress), std::end(ctx.ToolTrapAddress), 0);
+		std::fill(std::begin(ctx.OSTrapAddress), std::end(ctx.OSTrapAddress), 0);
 
 
 		// alternate entry code
-		MM::Native::NewPtr(1024 * 4 + 256 * 4, false, ToolGlue);
-		OSGlue = ToolGlue + 1024 * 4;
+		MM::Native::NewPtr(1024 * 4 + 256 * 4, false, ctx.ToolGlue);
+		ctx.OSGlue = ctx.ToolGlue + 1024 * 4;
 
-		uint16_t *code = (uint16_t *)memoryPointer(ToolGlue);
+		uint16_t *code = (uint16_t *)memoryPointer(ctx.ToolGlue);
 
 		for (unsigned i = 0; i < 1024; ++i) {
 			*code++ = host_to_big_endian_16(0xafff);
@@ -371,10 +376,35 @@ namespace ToolBox {
 			*code++ = host_to_big_endian_16(0xa000 | i);
 		}
 
+		RegisterNativeTraps();
+
 		// os return code... pull registers, TST.W d0, etc.
 		return true;
 	}
 
+	void SaveState(FILE *f)
+	{
+		auto &ctx = Context();
+
+		State::Write(f, ctx.ToolTrapAddress);
+		State::Write(f, ctx.OSTrapAddress);
+		State::Write(f, ctx.ToolGlue);
+		State::Write(f, ctx.OSGlue);
+	}
+
+	void LoadState(FILE *f)
+	{
+		// the glue code is in the saved memory.
+		auto &ctx = Context();
+
+		State::Read(f, ctx.ToolTrapAddress);
+		State::Read(f, ctx.OSTrapAddress);
+		State::Read(f, ctx.ToolGlue);
+		State::Read(f, ctx.OSGlue);
+
+		RegisterNativeTraps();
+	}
+
 	void native_dispatch(uint16_t trap);
 	void dispatch(uint16_t trap)
 	{
@@ -490,7 +520,7 @@ namespace ToolBox {
 		if (is_tool_trap(trap))
 		{
 			uint16_t tt = trap & 0x03ff;
-			uint32_t address = trap_address[tt];
+			uint32_t address = Context().ToolTrapAddress[tt];
 			if (address)
 			{
 				/*
@@ -525,7 +555,7 @@ namespace ToolBox {
 			}
 			uint16_t tt = trap & 0x00ff;
 
-			uint32_t address = os_address[tt];
+			uint32_t address = Context().OSTrapAddress[tt];
 
 			if (address) {
 				assert("OS trap overrides are not yet supported.");
@@ -541,604 +571,321 @@ namespace ToolBox {
 
 	void native_dispatch(uint16_t trap)
 	{
+		TrapEntry &e = trap_table[trap & 0x0fff];
+		uint32_t d0;
 
-		uint32_t d0 = 0;
-		switch (trap)
+		if (!e.handler)
 		{
-			case 0xa000: // Open
-			case 0xa200: // HOpen
-				d0 = OS::Open(trap);
-				break;
-
-			case 0xa00a: // OpenRF
-			case 0xa20a: // HOpenRF
-				d0 = OS::OpenRF(trap);
-				break;
-
-
-			case 0xa001:
-				d0 = OS::Close(trap);
-				break;
-
-			case 0xa002:
-				d0 = OS::Read(trap);
-				break;
-
-			case 0xa003:
-				d0 = OS::Write(trap);
-				break;
-
-			case 0xa207:
-				d0 = OS::HGetVInfo(trap);
-				break;
-
-			case 0xa008: // Create
-			case 0xa208: // HCreate
-				d0 = OS::Create(trap);
-				break;
-
-			case 0xa009: // Delete
-			case 0xa209: // HDelete
-				d0 = OS::Delete(trap);
-				break;
-
-			case 0xa00c: // GetFInfo
-			case 0xa20c: // HGetFInfo
-				d0 = OS::GetFileInfo(trap);
-				break;
-
-
-			case 0xa00d: // SetFileInfo
-			case 0xa20d: // HSetFileInfo
-				d0 = OS::SetFileInfo(trap);
-				break;
-
-			case 0xa011:
-				d0 = OS::GetEOF(trap);
-				break;
-
-			case 0xa012:
-				d0 = OS::SetEOF(trap);
-				break;
-			case 0xa013:
-				d0 = OS::FlushVol(trap);
-				break;
-
-			case 0xa014:
-				d0 = OS::GetVol(trap);
-				break;
-
-			case 0xa214:
-				d0 = OS::HGetVol(trap);
-				break;
-
-
-			case 0xa015: // SetVol
-				d0 = OS::SetVol(trap);
-				break;
-
-			case 0xa215: // HSetVol
-				d0 = OS::HSetVol(trap);
-				break;
-
-
-			case 0xa018:
-				d0 = OS::GetFPos(trap);
-				break;
-
-			case 0xa044:
-				d0 = OS::SetFPos(trap);
-				break;
-
-			case 0xa051:
-				d0 = OS::ReadXPRam(trap);
-				break;
-
-			case 0xa060:
-				d0 = OS::FSDispatch(trap);
-				break;
-
-			case 0xa260:
-				d0 = OS::HFSDispatch(trap);
-				break;
-
-			case 0xaa52:
-				d0 = OS::HighLevelHFSDispatch(trap);
-				break;
-
-
-			case 0xa146:
-				d0 = OS::GetTrapAddress(trap);
-				break;
-
-			case 0xA746:
-				d0 = OS::GetToolTrapAddress(trap);
-				break;
-
-			case 0xa647:
-				d0 = OS::SetToolTrapAddress(trap);
-				break;
-
-			case 0xA346:
-				d0 = OS::GetOSTrapAddress(trap);
-				break;
-
-			case 0xa247:
-				d0 = OS::SetOSTrapAddress(trap);
-				break;
-
-			case 0xA823:
-				d0 = OS::AliasDispatch(trap);
-				break;
-
-			case 0xA1AD:
-				d0 = OS::Gestalt(trap);
-				break;
-
-			case 0xa090:
-				d0 = OS::SysEnvirons(trap);
-				break;
-
-			// SetPtrSize (p: Ptr; newSize: Size);
-			case 0xa020:
-				d0 = MM::SetPtrSize(trap);
-				break;
-
-			// GetPtrSize (p: Ptr) : Size
-			case 0xa021:
-				d0 = MM::GetPtrSize(trap);
-				break;
-
-			case 0xA023:
-				d0 = MM::DisposeHandle(trap);
-				break;
-
-			case 0xa024:
-				d0 = MM::SetHandleSize(trap);
-				break;
-
-			case 0xa025:
-				d0 = MM::GetHandleSize(trap);
-				break;
-
-			case 0xa029:
-				d0 = MM::HLock(trap);
-				break;
-
-			case 0xa02a:
-				d0 = MM::HUnlock(trap);
-				break;
-
-			case 0xa02d:
-				d0 = MM::SetApplLimit(trap);
-				break;
-
-			// BlockMove (sourcePtr,destPtr: Ptr; byteCount: Size);
-			case 0xa02e: // BlockMove
-			case 0xa22e: // BlockMoveData
-				d0 = MM::BlockMove(trap);
-				break;
-
-			case 0xa049:
-				d0 = MM::HPurge(trap);
-				break;
-
-			case 0xa04a:
-				d0 = MM::HNoPurge(trap);
-				break;
-
-
-			case 0xA11D:
-				d0 = MM::MaxMem(trap);
-				break;
-
-			case 0xA01C:
-				d0 = MM::FreeMem(trap);
-				break;
-
-			// CompactMem (cbNeeded: Size) : Size;
-			case 0xa04c:
-				d0 = MM::CompactMem(trap);
-				break;
-
-			case 0xa040:
-				d0 = MM::ReserveMem(trap);
-				break;
-
-			case 0xa055:
-				d0 = MM::StripAddress(trap);
-				break;
-
-			case 0xa061:
-				d0 = MM::MaxBlock(trap);
-				break;
-
-			case 0xa069:
-				d0 = MM::HGetState(trap);
-				break;
-
-			case 0xa06a:
-				d0 = MM::HSetState(trap);
-				break;
-
-
-			// MoveHHi (h: Handle);
-			case 0xa064:
-				d0 = MM::MoveHHi(trap);
-				break;
-
-			case 0xa9e1:
-				d0 = MM::HandToHand(trap);
-				break;
-
-			case 0xa9e3:
-				d0 = MM::PtrToHand(trap);
-				break;
-			case 0xa9ef:
-				d0 = MM::PtrAndHand(trap);
-				break;
-
-			case 0xa11a:
-				d0 = MM::GetZone(trap);
-				break;
-
-			case 0xa01b:
-				d0 = MM::SetZone(trap);
-				break;
-
-			case 0xa126:
-				d0 = MM::HandleZone(trap);
-				break;
-
-			case 0xa128:
-				d0 = MM::RecoverHandle(trap);
-				break;
-
-			// MaxApplZone
-			case 0xa063:
-				d0 = MM::MaxApplZone(trap);
-				break;
-
-			case 0xa162:
-				d0 = MM::PurgeSpace(trap);
-				break;
-
-			// ReadDateTime (VAR sees: LONGINT) : OSErr;
-			case 0xa039:
-				d0 = OS::ReadDateTime(trap);
-				break;
-
-			// SecondsToDate (s: LongInt; VAR d: DateTimeRec);
-			case 0xa9c6:
-				d0 = OS::SecondsToDate(trap);
-				break;
-
-			// TickCount : LONGINT;
-			case 0xa975:
-				d0 = OS::TickCount(trap);
-				break;
-
-			case 0xa193:
-				d0 = OS::Microseconds(trap);
-				break;
-
-
-			case 0xa9ed:
-				d0 = Packages::Pack6(trap);
-				break;
-
-			//_CmpString [MARKS,CASE]
-			case 0xa03c:
-			case 0xa23c:
-			case 0xa43c:
-			case 0xa63c:
-				d0 = OS::CmpString(trap);
-				break;
-
-			//_RelString [MARKS,CASE]
-			case 0xa050:
-			case 0xa250:
-			case 0xa450:
-			case 0xa650:
-				d0 = OS::RelString(trap);
-				break;
-
-
-			// NewPtr [Sys, Clear] (logicalSize: Size): Ptr;
-			case 0xa11e:
-			case 0xa31e:
-			case 0xa51e:
-			case 0xa71e:
-				// clear = bit 9, sys = bit 10
-				d0 = MM::NewPtr(trap);
-				break;
-
-			// DisposPtr (p: Ptr);
-			case 0xa01f:
-				d0 = MM::DisposePtr(trap);
-				break;
-
-			case 0xa065:
-				d0 = MM::StackSpace(trap);
-				break;
-
-			// NewHandle (logicalSize: Size) : Handle;
-			case 0xA122:
-			case 0xa322:
-				d0 = MM::NewHandle(trap);
-				break;
-
-			case 0xA027:
-				d0 = MM::ReallocHandle(trap);
-				break;
-
-			case 0xA02B:
-				d0 = MM::EmptyHandle(trap);
-				break;
-
-
-			case 0xa058:
-				d0 = OS::InsTime(trap);
-				break;
-
-			case 0xa059:
-				d0 = OS::RmvTime(trap);
-				break;
-
-			case 0xa05a:
-				d0 = OS::PrimeTime(trap);
-				break;
-
-
-			case 0xA0BD:
-				d0 = OS::FlushCodeCache(trap);
-				break;
-
-			case 0xA098:
-			case 0xA198: // don't save a0
-				d0 = OS::HWPriv(trap);
-				break;
-
-			// resource manager stuff.
-
-			// Count1Resources (theType: ResType): Integer;
-			case 0xa80d:
-				d0 = RM::Count1Resources(trap);
-				break;
-
-			case 0xa80e:
-				d0 = RM::Get1IndResource(trap);
-				break;
-
-			case 0xa80f:
-				d0 = RM::Get1IndType(trap);
-				break;
-
-			case 0xa81a:
-				d0 = RM::HOpenResFile(trap);
-				break;
-
-			case 0xa81b:
-				d0 = RM::HCreateResFile(trap);
-				break;
-
-			case 0xa81c:
-				d0 = RM::Count1Types(trap);
-				break;
-
-			// Get1Resource (theType: ResType; thelD: INTEGER) : Handle;
-			case 0xa81f:
-				d0 = RM::Get1Resource(trap);
-				break;
-
-			// Get1NamedResource (theType: ResType; name: Str255) : Handle;
-			case 0xa820:
-				d0 = RM::Get1NamedResource(trap);
-				break;
-
-
-			case 0xa992:
-				d0 = RM::DetachResource(trap);
-				break;
-
-			case 0xa994:
-				d0 = RM::CurResFile(trap);
-				break;
-
-			case 0xA997:
-				d0 = RM::OpenResFile(trap);
-				break;
-
-			case 0xA998:
-				d0 = RM::UseResFile(trap);
-				break;
-
-			case 0xa999:
-				d0 = RM::UpdateResFile(trap);
-				break;
-
-			case 0xa99a:
-				d0 = RM::CloseResFile(trap);
-				break;
-
-			case 0xa99b:
-				d0 = RM::SetResLoad(trap);
-				break;
-
-			// GetResource (theType: ResType; thelD: INTEGER) : Handle;
-			case 0xa9a0:
-				d0 = RM::GetResource(trap);
-				break;
-
-			case 0xa9a1:
-				d0 = RM::GetNamedResource(trap);
-				break;
-
-			case 0xa9a2:
-				d0 = RM::LoadResource(trap);
-				break;
-
-			// ReleaseResource (theResource: Handle);
-			case 0xa9a3:
-				d0 = RM::ReleaseResource(trap);
-				break;
-
-			case 0xa9a4:
-				d0 = RM::HomeResFile(trap);
-				break;
-
-			case 0xa9a5:
-				d0 = RM::GetResourceSizeOnDisk(trap);
-				break;
-
-			case 0xa9a6:
-				d0 = RM::GetResAttrs(trap);
-				break;
-
-			case 0xa9a7:
-				d0 = RM::SetResAttrs(trap);
-				break;
-
-			case 0xa9a8:
-				d0 = RM::GetResInfo(trap);
-				break;
-
-			case 0xa9ab:
-				d0 = RM::AddResource(trap);
-				break;
-
-			case 0xa9aa:
-				d0 = RM::ChangedResource(trap);
-				break;
-
-			case 0xa9ad:
-				d0 = RM::RemoveResource(trap);
-				break;
-
-			// ResError : INTEGER;
-			case 0xa9af:
-				d0 = RM::ResError(trap);
-				break;
-
-			case 0xa9b0:
-				d0 = RM::WriteResource(trap);
-				break;
-
-			// CreateResFile(fileName: Str255);
-			case 0xa9b1:
-				d0 = RM::CreateResFile(trap);
-				break;
-
-			// OpenRFPerm (fileName: Str255; vRefNum: Integer;
-            //       permission: SignedByte): Integer;
-			case 0xa9c4:
-				d0 = RM::OpenRFPerm(trap);
-				break;
-
-			case 0xa9f6:
-				d0 = RM::GetResFileAttrs(trap);
-				break;
+			fprintf(stderr, "Unsupported tool trap: %04x (%s)\n",
+					trap, TrapName(trap));
+			fprintf(stderr, "pc: %08x\n", cpuGetPC());
+			exit(255);
+		}
 
-			case 0xa9f7:
-				d0 = RM::SetResFileAttrs(trap);
-				break;
+		if (TrapStats)
+		{
+			auto begin = std::chrono::steady_clock::now();
+			d0 = e.handler(trap);
+			e.counters.add(begin);
+		}
+		else d0 = e.handler(trap);
 
+		if (e.flags & kTrapSetsFlags)
+		{
+			cpuSetDReg(0, d0);
+			return;
+		}
 
-			// UnloadSeg (routineAddr: Ptr);
-			case 0xa9f1:
-				d0 = Loader::UnloadSeg(trap);
-				break;
+		// n.b. - os calls return via d0 and tst.w d0.
+		// toolcalls return any error info as the return
+		// value on the stack.
+		if (d0)
+		{
+			int16_t v = (int16_t)d0;
+			Log("     -> %d\n", v);
+		}
 
 
-			// quickdraw (AsmIIgs ... )
+		cpuSetDReg(0, d0);
+		cpuSetFlagsNZ00NewW(d0);
 
-			// _ShowCursor();
-			case 0xA853:
-				d0 = QD::ShowCursor(trap);
-				break;
+	}
 
-			// GetCursor (cursorlD: INTEGER) : CursHandle;
-			case 0xA9B9:
-				d0 = QD::GetCursor(trap);
-				break;
+	void RegisterTrap(uint16_t trap, const char *name, TrapHandler handler, unsigned flags)
+	{
+		TrapEntry &e = trap_table[trap & 0x0fff];
 
+		e.handler = handler;
+		e.name = name;
+		e.flags = flags;
+	}
 
-			case 0xa834:
-				d0 = QD::SetFScaleDisable(trap);
-				break;
+	void RegisterNativeTraps()
+	{
+		// handlers return a 16 or 32-bit d0.
+		#define TRAP(trap, name, handler) { trap, name, [](uint16_t t) -> uint32_t { return handler(t); } }
+
+		static const struct {
+			uint16_t trap;
+			const char *name;
+			TrapHandler handler;
+		} traps[] = {
+			TRAP(0xa000, "Open", OS::Open),
+			TRAP(0xa200, "HOpen", OS::Open),
+			TRAP(0xa00a, "OpenRF", OS::OpenRF),
+			TRAP(0xa20a, "HOpenRF", OS::OpenRF),
+			TRAP(0xa001, "Close", OS::Close),
+			TRAP(0xa002, "Read", OS::Read),
+			TRAP(0xa003, "Write", OS::Write),
+			TRAP(0xa207, "HGetVInfo", OS::HGetVInfo),
+			TRAP(0xa008, "Create", OS::Create),
+			TRAP(0xa208, "HCreate", OS::Create),
+			TRAP(0xa009, "Delete", OS::Delete),
+			TRAP(0xa209, "HDelete", OS::Delete),
+			TRAP(0xa00c, "GetFileInfo", OS::GetFileInfo),
+			TRAP(0xa20c, "HGetFileInfo", OS::GetFileInfo),
+			TRAP(0xa00d, "SetFileInfo", OS::SetFileInfo),
+			TRAP(0xa20d, "HSetFileInfo", OS::SetFileInfo),
+			TRAP(0xa011, "GetEOF", OS::GetEOF),
+			TRAP(0xa012, "SetEOF", OS::SetEOF),
+			TRAP(0xa013, "FlushVol", OS::FlushVol),
+			TRAP(0xa014, "GetVol", OS::GetVol),
+			TRAP(0xa214, "HGetVol", OS::HGetVol),
+			TRAP(0xa015, "SetVol", OS::SetVol),
+			TRAP(0xa215, "HSetVol", OS::HSetVol),
+			TRAP(0xa018, "GetFPos", OS::GetFPos),
+			TRAP(0xa044, "SetFPos", OS::SetFPos),
+			TRAP(0xa051, "ReadXPRam", OS::ReadXPRam),
+			TRAP(0xa060, "FSDispatch", OS::FSDispatch),
+			TRAP(0xa260, "HFSDispatch", OS::HFSDispatch),
+			TRAP(0xaa52, "HighLevelHFSDispatch", OS::HighLevelHFSDispatch),
+			TRAP(0xa146, "GetTrapAddress", OS::GetTrapAddress),
+			TRAP(0xa746, "GetToolTrapAddress", OS::GetToolTrapAddress),
+			TRAP(0xa647, "SetToolTrapAddress", OS::SetToolTrapAddress),
+			TRAP(0xa346, "GetOSTrapAddress", OS::GetOSTrapAddress),
+			TRAP(0xa247, "SetOSTrapAddress", OS::SetOSTrapAddress),
+			TRAP(0xa823, "AliasDispatch", OS::AliasDispatch),
+			TRAP(0xa1ad, "Gestalt", OS::Gestalt),
+			TRAP(0xa090, "SysEnvirons", OS::SysEnvirons),
+
+			TRAP(0xa020, "SetPtrSize", MM::SetPtrSize),
+			TRAP(0xa021, "GetPtrSize", MM::GetPtrSize),
+			TRAP(0xa023, "DisposeHandle", MM::DisposeHandle),
+			TRAP(0xa024, "SetHandleSize", MM::SetHandleSize),
+			TRAP(0xa025, "GetHandleSize", MM::GetHandleSize),
+			TRAP(0xa029, "HLock", MM::HLock),
+			TRAP(0xa02a, "HUnlock", MM::HUnlock),
+			TRAP(0xa02d, "SetApplLimit", MM::SetApplLimit),
+			TRAP(0xa02e, "BlockMove", MM::BlockMove),
+			TRAP(0xa22e, "BlockMoveData", MM::BlockMove),
+			TRAP(0xa049, "HPurge", MM::HPurge),
+			TRAP(0xa04a, "HNoPurge", MM::HNoPurge),
+			TRAP(0xa11d, "MaxMem", MM::MaxMem),
+			TRAP(0xa01c, "FreeMem", MM::FreeMem),
+			TRAP(0xa04c, "CompactMem", MM::CompactMem),
+			TRAP(0xa040, "ResrvMem", MM::ReserveMem),
+			TRAP(0xa055, "StripAddress", MM::StripAddress),
+			TRAP(0xa061, "MaxBlock", MM::MaxBlock),
+			TRAP(0xa069, "HGetState", MM::HGetState),
+			TRAP(0xa06a, "HSetState", MM::HSetState),
+			TRAP(0xa064, "MoveHHi", MM::MoveHHi),
+			TRAP(0xa9e1, "HandToHand", MM::HandToHand),
+			TRAP(0xa9e3, "PtrToHand", MM::PtrToHand),
+			TRAP(0xa9ef, "PtrAndHand", MM::PtrAndHand),
+			TRAP(0xa11a, "GetZone", MM::GetZone),
+			TRAP(0xa01b, "SetZone", MM::SetZone),
+			TRAP(0xa126, "HandleZone", MM::HandleZone),
+			TRAP(0xa128, "RecoverHandle", MM::RecoverHandle),
+			TRAP(0xa063, "MaxApplZone", MM::MaxApplZone),
+			TRAP(0xa162, "PurgeSpace", MM::PurgeSpace),
+
+			TRAP(0xa039, "ReadDateTime", OS::ReadDateTime),
+			TRAP(0xa9c6, "SecondsToDate", OS::SecondsToDate),
+			TRAP(0xa975, "TickCount", OS::TickCount),
+			TRAP(0xa193, "Microseconds", OS::Microseconds),
+
+			TRAP(0xa9ed, "Pack6", Packages::Pack6),
+
+			TRAP(0xa03c, "CmpString", OS::CmpString),
+			TRAP(0xa23c, "CmpString", OS::CmpString),
+			TRAP(0xa43c, "CmpString", OS::CmpString),
+			TRAP(0xa63c, "CmpString", OS::CmpString),
+			TRAP(0xa050, "RelString", OS::RelString),
+			TRAP(0xa250, "RelString", OS::RelString),
+			TRAP(0xa450, "RelString", OS::RelString),
+			TRAP(0xa650, "RelString", OS::RelString),
+
+			TRAP(0xa11e, "NewPtr", MM::NewPtr),
+			TRAP(0xa31e, "NewPtrClear", MM::NewPtr),
+			TRAP(0xa51e, "NewPtrSys", MM::NewPtr),
+			TRAP(0xa71e, "NewPtrSysClear", MM::NewPtr),
+			TRAP(0xa01f, "DisposePtr", MM::DisposePtr),
+			TRAP(0xa065, "StackSpace", MM::StackSpace),
+			TRAP(0xa122, "NewHandle", MM::NewHandle),
+			TRAP(0xa322, "NewHandleClear", MM::NewHandle),
+			TRAP(0xa027, "ReallocHandle", MM::ReallocHandle),
+			TRAP(0xa02b, "EmptyHandle", MM::EmptyHandle),
+
+			TRAP(0xa058, "InsTime", OS::InsTime),
+			TRAP(0xa059, "RmvTime", OS::RmvTime),
+			TRAP(0xa05a, "PrimeTime", OS::PrimeTime),
+			TRAP(0xa0bd, "FlushCodeCache", OS::FlushCodeCache),
+			TRAP(0xa098, "HWPriv", OS::HWPriv),
+			TRAP(0xa198, "HWPriv", OS::HWPriv),
+
+			TRAP(0xa80d, "Count1Resources", RM::Count1Resources),
+			TRAP(0xa80e, "Get1IxResource", RM::Get1IndResource),
+			TRAP(0xa80f, "Get1IxType", RM::Get1IndType),
+			TRAP(0xa81a, "HOpenResFile", RM::HOpenResFile),
+			TRAP(0xa81b, "HCreateResFile", RM::HCreateResFile),
+			TRAP(0xa81c, "Count1Types", RM::Count1Types),
+			TRAP(0xa81f, "Get1Resource", RM::Get1Resource),
+			TRAP(0xa820, "Get1NamedResource", RM::Get1NamedResource),
+			TRAP(0xa992, "DetachResource", RM::DetachResource),
+			TRAP(0xa994, "CurResFile", RM::CurResFile),
+			TRAP(0xa997, "OpenResFile", RM::OpenResFile),
+			TRAP(0xa998, "UseResFile", RM::UseResFile),
+			TRAP(0xa999, "UpdateResFile", RM::UpdateResFile),
+			TRAP(0xa99a, "CloseResFile", RM::CloseResFile),
+			TRAP(0xa99b, "SetResLoad", RM::SetResLoad),
+			TRAP(0xa9a0, "GetResource", RM::GetResource),
+			TRAP(0xa9a1, "GetNamedResource", RM::GetNamedResource),
+			TRAP(0xa9a2, "LoadResource", RM::LoadResource),
+			TRAP(0xa9a3, "ReleaseResource", RM::ReleaseResource),
+			TRAP(0xa9a4, "HomeResFile", RM::HomeResFile),
+			TRAP(0xa9a5, "SizeRsrc", RM::GetResourceSizeOnDisk),
+			TRAP(0xa9a6, "GetResAttrs", RM::GetResAttrs),
+			TRAP(0xa9a7, "SetResAttrs", RM::SetResAttrs),
+			TRAP(0xa9a8, "GetResInfo", RM::GetResInfo),
+			TRAP(0xa9ab, "AddResource", RM::AddResource),
+			TRAP(0xa9aa, "ChangedResource", RM::ChangedResource),
+			TRAP(0xa9ad, "RmveResource", RM::RemoveResource),
+			TRAP(0xa9af, "ResError", RM::ResError),
+			TRAP(0xa9b0, "WriteResource", RM::WriteResource),
+			TRAP(0xa9b1, "CreateResFile", RM::CreateResFile),
+			TRAP(0xa9c4, "OpenRFPerm", RM::OpenRFPerm),
+			TRAP(0xa9f6, "GetResFileAttrs", RM::GetResFileAttrs),
+			TRAP(0xa9f7, "SetResFileAttrs", RM::SetResFileAttrs),
+
+			TRAP(0xa9f1, "UnLoadSeg", Loader::UnloadSeg),
+
+			TRAP(0xa853, "ShowCursor", QD::ShowCursor),
+			TRAP(0xa9b9, "GetCursor", QD::GetCursor),
+			TRAP(0xa834, "SetFScaleDisable", QD::SetFScaleDisable),
+			TRAP(0xa851, "SetCursor", QD::SetCursor),
+			TRAP(0xa86e, "InitGraf", QD::InitGraf),
+			TRAP(0xa900, "GetFNum", QD::GetFNum),
+
+			TRAP(0xa9ee, "DECSTR68K", SANE::decstr68k),
+
+			TRAP(0xa906, "NewString", Utility::NewString),
+			TRAP(0xa9ba, "GetString", Utility::GetString),
+			TRAP(0xa85d, "BitTst", Utility::BitTst),
+
+			TRAP(0xa88f, "OSDispatch", OS::OSDispatch),
+
+			TRAP(0xa8b5, "ScriptUtil", Packages::ScriptUtil),
+
+			TRAP(0xabff, "DebugStr", Debug::DebugStr),
+		};
+
+		// the table is shared, so only the first context registers.
+		static std::once_flag once;
+		std::call_once(once, [](){
+			for (const auto &t : traps)
+				RegisterTrap(t.trap, t.name, t.handler);
+
+			RegisterTrap(0xa9eb, "FP68K", [](uint16_t t) -> uint32_t { return SANE::fp68k(t); }, kTrapSetsFlags);
+			RegisterTrap(StdCLib::kTrap, "StdCLib", StdCLib::Dispatch, kTrapSetsFlags);
+		});
+
+		#undef TRAP
+	}
 
-			//SetCursor (crsr: Cursor)
-			case 0xA851:
-				d0 = QD::SetCursor(trap);
-				break;
 
-			case 0xa86e:
-				d0 = QD::InitGraf(trap);
-				break;
+#pragma mark - Selector tables
 
-			// GetFNum (fontName: Str255; VAR theNum: INTEGER);
-			case 0xa900:
-				d0 = QD::GetFNum(trap);
-				break;
+	SelectorTable::SelectorTable(const char *name, std::initializer_list<Entry> entries) :
+		_name(name), _entries(entries)
+	{
+		std::sort(_entries.begin(), _entries.end(), [](const Entry &a, const Entry &b){
+			return a.selector < b.selector;
+		});
 
+		std::lock_guard<std::mutex> lock(selector_mutex);
+		selector_tables.push_back(this);
+	}
 
-			// sane
-			case 0xa9Eb:
-				d0 = SANE::fp68k(trap);
-				cpuSetDReg(0, d0);
-				return; // SANE sets the flags.
-				break;
+	uint16_t SelectorTable::dispatch(uint32_t selector)
+	{
+		auto iter = std::lower_bound(_entries.begin(), _entries.end(), selector, [](const Entry &e, uint32_t selector){
+			return e.selector < selector;
+		});
 
-			case 0x0a9ee:
-				d0 = SANE::decstr68k(trap);
-				break;
+		if (iter == _entries.end() || iter->selector != selector)
+		{
+			fprintf(stderr, "%s: selector %0*x not implemented\n",
+				_name, selector > 0xffff ? 8 : 4, selector);
+			exit(1);
+		}
 
-			// utility
+		if (!TrapStats) return iter->handler();
 
-			case 0xa906:
-				d0 = Utility::NewString(trap);
-				break;
-			case 0xa9ba:
-				d0 = Utility::GetString(trap);
-				break;
+		auto begin = std::chrono::steady_clock::now();
+		uint16_t d0 = iter->handler();
+		iter->counters.add(begin);
+		return d0;
+	}
 
-			case 0xa85d:
-				d0 = Utility::BitTst(trap);
-				break;
 
-			case 0xa88f:
-				d0 = OS::OSDispatch(trap);
-				break;
+#pragma mark - Statistics
 
-			case 0xa8b5:
-				d0 = Packages::ScriptUtil(trap);
-				break;
+	void PrintTrapStats()
+	{
+		struct Row {
+			std::string name;
+			const TrapCounters *counters;
+		};
 
-			case 0xABFF:
-				d0 = Debug::DebugStr(trap);
-				break;
+		std::vector<Row> rows;
+		char buffer[64];
 
+		for (unsigned i = 0; i < 0x1000; ++i)
+		{
+			const TrapEntry &e = trap_table[i];
+			if (!e.counters.calls) continue;
 
-			default:
-				fprintf(stderr, "Unsupported tool trap: %04x (%s)\n",
-						trap, TrapName(trap));
-				fprintf(stderr, "pc: %08x\n", cpuGetPC());
-				exit(255);
+			snprintf(buffer, sizeof(buffer), "%04x %s", 0xa000 | i, e.name);
+			rows.push_back({buffer, &e.counters});
 		}
 
-		// n.b. - os calls return via d0 and tst.w d0.
-		// toolcalls return any error info as the return
-		// value on the stack.
-		if (d0)
+		std::lock_guard<std::mutex> lock(selector_mutex);
+		for (const SelectorTable *table : selector_tables)
 		{
-			int16_t v = (int16_t)d0;
-			Log("     -> %d\n", v);
-		}
+			for (const auto &e : table->entries())
+			{
+				if (!e.counters.calls) continue;
 
+				snprintf(buffer, sizeof(buffer), "     %s.%s", table->name(), e.name);
+				rows.push_back({buffer, &e.counters});
+			}
+		}
 
-		cpuSetDReg(0, d0);
-		cpuSetFlagsNZ00NewW(d0);
+		std::sort(rows.begin(), rows.end(), [](const Row &a, const Row &b){
+			return a.counters->ns > b.counters->ns;
+		});
 
+		fprintf(stderr, "%-40s %10s %12s %10s %10s\n", "Trap", "Calls", "Total ms", "Avg us", "Max us");
+		for (const Row &r : rows)
+		{
+			const TrapCounters &c = *r.counters;
+			fprintf(stderr, "%-40s %10llu %12.3f %10.3f %10.3f\n",
+				r.name.c_str(),
+				(unsigned long long)c.calls,
+				c.ns / 1e6,
+				c.ns / 1e3 / c.calls,
+				c.max / 1e3);
+		}
 	}
 
 }
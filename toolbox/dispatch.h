@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __mpw_toolbox_dispatch_h__
+#define __mpw_toolbox_dispatch_h__
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <initializer_list>
+#include <vector>
+
+namespace ToolBox {
+
+	// --trap-stats
+	extern bool TrapStats;
+
+	// shared by every thread running a tool, hence atomic.
+	struct TrapCounters {
+		std::atomic<uint64_t> calls{0};
+		std::atomic<uint64_t> ns{0}; // total time in the handler
+		std::atomic<uint64_t> max{0}; // longest call
+
+		TrapCounters() = default;
+		TrapCounters(const TrapCounters &other) :
+			calls(other.calls.load()), ns(other.ns.load()), max(other.max.load())
+		{}
+
+		TrapCounters &operator=(const TrapCounters &other)
+		{
+			calls = other.calls.load();
+			ns = other.ns.load();
+			max = other.max.load();
+			return *this;
+		}
+
+		void add(std::chrono::steady_clock::time_point begin)
+		{
+			uint64_t t = std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - begin).count();
+
+			calls.fetch_add(1, std::memory_order_relaxed);
+			ns.fetch_add(t, std::memory_order_relaxed);
+
+			uint64_t m = max.load(std::memory_order_relaxed);
+			while (t > m && !max.compare_exchange_weak(m, t, std::memory_order_relaxed))
+				;
+		}
+	};
+
+
+	// returns d0.
+	typedef uint32_t (*TrapHandler)(uint16_t trap);
+
+	enum {
+		kTrapSetsFlags = 1, // the handler sets d0 and the flags itself (SANE).
+	};
+
+	/*
+	 * registers the native handler for a trap word.  OS traps are
+	 * registered per flag combination ($a11e NewPtr, $a31e NewPtrClear, ...),
+	 * tool traps without the auto-pop bit.
+	 *
+	 * The table is process-wide; handlers are registered by the first
+	 * ToolBox::Init, before any tool runs.
+	 */
+	void RegisterTrap(uint16_t trap, const char *name, TrapHandler handler, unsigned flags = 0);
+
+
+	/*
+	 * selector table for a trap that dispatches again on a selector
+	 * (OSDispatch, Pack6, ...).
+	 */
+	class SelectorTable {
+	public:
+
+		typedef uint16_t (*Handler)();
+
+		struct Entry {
+			uint32_t selector;
+			const char *name;
+			Handler handler;
+			TrapCounters counters;
+
+			Entry(uint32_t s, const char *n, Handler h) : selector(s), name(n), handler(h)
+			{}
+		};
+
+		SelectorTable(const char *name, std::initializer_list<Entry> entries);
+
+		// calls the handler for selector.  An unknown selector is fatal.
+		uint16_t dispatch(uint32_t selector);
+
+		const char *name() const { return _name; }
+		const std::vector<Entry> &entries() const { return _entries; }
+
+	private:
+		const char *_name;
+		std::vector<Entry> _entries; // sorted by selector.
+	};
+
+
+	void PrintTrapStats();
+
+}
+
+#endif
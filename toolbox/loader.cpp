@@ -37,15 +37,19 @@
 #include <cpu/fmem.h>
 
 #include "loader.h"
+#include "context.h"
 #include "toolbox.h"
 #include "stackframe.h"
 
 #include "rm.h"
 #include "mm.h"
+#include "stdclib.h"
+#include "state.h"
 
 #include <macos/sysequ.h>
 
 using ToolBox::Log;
+using ToolBox::Context;
 
 namespace Loader {
 
@@ -53,22 +57,6 @@ namespace Loader {
 
 		const uint32_t kCODE = 0x434f4445;
 
-		struct SegmentInfo
-		{
-			SegmentInfo()
-			{}
-
-			SegmentInfo(uint32_t h, uint32_t a, uint32_t s, bool fm = false):
-				handle(h), address(a), size(s), farModel(fm)
-			{}
-
-			uint32_t handle = 0;
-			uint32_t address = 0;
-			uint32_t size = 0;
-			bool farModel = false;
-			// todo -- also add std::string segmentName?
-		};
-
 		struct Segment0Info
 		{
 			Segment0Info()
@@ -80,7 +68,33 @@ namespace Loader {
 			uint32_t jtEnd = 0;
 		};
 
-		std::vector<SegmentInfo> Segments;
+
+		OSErr OpenResourceFork(const std::string &path)
+		{
+			HFSUniStr255 fork = {0,{0}};
+			ResFileRefNum refNum;
+			FSRef ref;
+			OSErr err;
+
+			// TODO -- call RM::Native::OpenResourceFile(...);
+
+			err = FSPathMakeRef( (const UInt8 *)path.c_str(), &ref, NULL);
+			if (err) return err;
+
+
+			::FSGetResourceForkName(&fork);
+
+			err = ::FSOpenResourceFile(&ref,
+				fork.length,
+				fork.unicode,
+				fsRdPerm,
+				&refNum);
+
+			if (err) return err;
+
+			Context().ToolPath = path;
+			return 0;
+		}
 
 		void reloc1(const uint8_t *r, uint32_t address, uint32_t offset)
 		{
@@ -184,9 +198,10 @@ namespace Loader {
 			// to the new handle.
 			std::memcpy(memoryPointer(rv.a5 + rv.jtOffset), memoryPointer(address + 16), rv.jtSize);
 
-			if (Segments.size() <= 0)
-				Segments.resize(0 + 1);
-			Segments[0] = si;
+			auto &segments = Context().Segments;
+			if (segments.size() <= 0)
+				segments.resize(0 + 1);
+			segments[0] = si;
 
 			rv.jtStart = rv.a5 + rv.jtOffset;
 			rv.jtEnd = rv.jtStart + rv.jtSize;
@@ -213,10 +228,11 @@ namespace Loader {
 			if (memoryReadWord(si.address) == 0xffff)
 				si.farModel = true;
 
-			if (Segments.size() <= segment)
-				Segments.resize(segment + 1);
+			auto &segments = Context().Segments;
+			if (segments.size() <= segment)
+				segments.resize(segment + 1);
 
-			Segments[segment] = si;
+			segments[segment] = si;
 
 			return 0;
 		}
@@ -230,35 +246,18 @@ namespace Loader {
 		uint16_t LoadFile(const std::string &path)
 		{
 
-			HFSUniStr255 fork = {0,{0}};
-			ResFileRefNum refNum;
-			FSRef ref;
 			OSErr err;
 
 			// open the file
 			// load code seg 0
 			// iterate and load other segments
 
-
-			// TODO -- call RM::Native::OpenResourceFile(...);
-
-			err = FSPathMakeRef( (const UInt8 *)path.c_str(), &ref, NULL);
-			if (err) return err;
-
-
-			::FSGetResourceForkName(&fork);
-
-			err = ::FSOpenResourceFile(&ref,
-				fork.length,
-				fork.unicode,
-				fsRdPerm,
-				&refNum);
-
+			err = OpenResourceFork(path);
 			if (err) return err;
 
-
 			// in case of restart?
-			Segments.clear();
+			auto &segments = Context().Segments;
+			segments.clear();
 
 			RM::Native::SetResLoad(true);
 
@@ -299,19 +298,19 @@ namespace Loader {
 				// load, if necessary.
 				assert(seg);
 
-				if (seg >= Segments.size() || Segments[seg].address == 0)
+				if (seg >= segments.size() || segments[seg].address == 0)
 				{
 					err = LoadCode(seg);
 					if (err) return err;
 
-					const auto &p = Segments[seg];
+					const auto &p = segments[seg];
 					if (p.farModel)
 					{
 						relocate(p.address, p.size, seg0.a5);
 					}
 				}
 
-				const auto &p = Segments[seg];
+				const auto &p = segments[seg];
 
 				assert(p.address); // missing segment?!
 				assert(offset < p.size);
@@ -356,8 +355,33 @@ namespace Loader {
 				ToolBox::WritePString(MacOS::CurApName, s);
 			}
 
+			// all segments are loaded -- patch StdCLib routines.
+			StdCLib::Install();
+
+
+			return 0;
+		}
+
 
+		void SaveState(FILE *f)
+		{
+			State::Write(f, Context().ToolPath);
+			State::Write(f, Context().Segments);
+		}
+
+		uint16_t LoadState(FILE *f)
+		{
+			std::string path;
 
+			State::Read(f, path);
+			State::Read(f, Context().Segments);
+
+			// the segments are in the saved memory but the native resource
+			// handles aren't, so the resource fork is opened again.
+			OSErr err = OpenResourceFork(path);
+			if (err) return err;
+
+			RM::Native::SetResLoad(true);
 			return 0;
 		}
 
@@ -367,14 +391,15 @@ namespace Loader {
 		void LoadDebugNames(DebugNameTable &table)
 		{
 
-			if (Segments.empty()) return;
+			const auto &segments = Context().Segments;
+			if (segments.empty()) return;
 
 
 			// skip segment 0 since that's the dispatch table.
-			for (unsigned seg = 1; seg < Segments.size(); ++seg)
+			for (unsigned seg = 1; seg < segments.size(); ++seg)
 			{
 
-				const auto &si = Segments[seg];
+				const auto &si = segments[seg];
 				const uint8_t *memory = memoryPointer(si.address);
 				unsigned size = si.size;
 
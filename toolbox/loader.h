@@ -5,10 +5,29 @@
 #include <map>
 
 #include <cstdint>
+#include <cstdio>
 
 namespace Loader {
 
 	typedef std::map<std::string, std::pair<uint32_t, uint32_t>> DebugNameTable;
+
+	// a loaded CODE segment.  Segment 0 is the a5 world.
+	struct SegmentInfo
+	{
+		SegmentInfo()
+		{}
+
+		SegmentInfo(uint32_t h, uint32_t a, uint32_t s, bool fm = false):
+			handle(h), address(a), size(s), farModel(fm)
+		{}
+
+		uint32_t handle = 0;
+		uint32_t address = 0;
+		uint32_t size = 0;
+		bool farModel = false;
+		// todo -- also add std::string segmentName?
+	};
+
 	namespace Native {
 
 		/*
@@ -20,6 +39,11 @@ namespace Loader {
 		 */
 		uint16_t LoadFile(const std::string &path);
 
+		// --snapshot / --restore.  LoadState replaces LoadFile; the
+		// segments must already be in memory.
+		void SaveState(FILE *f);
+		uint16_t LoadState(FILE *f);
+
 		// scans segments for MacsBug debug names.
 		// associates them with the start of the segment.
 		void LoadDebugNames(DebugNameTable &table);
@@ -36,34 +36,28 @@
 #include <deque>
 #include <vector>
 #include <map>
+#include <algorithm>
+
+#include <sys/mman.h>
+#include <unistd.h>
 
-#include <mplite/mplite.h>
 #include <macos/sysequ.h>
 #include <macos/errors.h>
 
 #include "stackframe.h"
+#include "context.h"
+#include "mm_allocator.h"
+#include "mm_index.h"
+#include "state.h"
 
 using ToolBox::Log;
+using ToolBox::Context;
 
 
 namespace
 {
-	mplite_t pool;
-
-	uint8_t *Memory;
-	uint32_t MemorySize;
-	uint32_t HeapSize;
-
-	// queue of free Handles
-	std::deque<uint32_t> HandleQueue;
-
-	// map of ptr -> size
-	std::map<uint32_t, uint32_t> PtrMap;
-
-
-
-	// map of handle -> size [? just use Ptr map?]
-	std::map<uint32_t, MM::HandleInfo> HandleMap;
+	// Memory, MemorySize, HeapSize, Heap, HandleQueue, HandleMap and
+	// Blocks live in the current EmulatorContext.
 
 	inline MacOS::macos_error SetMemError(MacOS::macos_error error)
 	{
@@ -77,32 +71,229 @@ namespace
 	}
 
 
+	// tells the host it can drop the pages of a large free block.  The
+	// first page is kept -- the allocators link free blocks through
+	// their first bytes.
+	void release_pages(uint32_t address, uint32_t size)
+	{
+		auto &ctx = Context();
+		if (!ctx.ReleaseSize || size < ctx.ReleaseSize) return;
+
+		static const uintptr_t page = sysconf(_SC_PAGESIZE);
+
+		uintptr_t start = ((uintptr_t)(ctx.Memory + address) + page) & ~(page - 1);
+		uintptr_t end = ((uintptr_t)(ctx.Memory + address + size)) & ~(page - 1);
+		if (start < end) madvise((void *)start, end - start, MADV_DONTNEED);
+	}
+
+
 	bool alloc_handle_block()
 	{
 		const unsigned HandleCount = 128; // 512 bytes of handle blocks.
 
-		uint8_t *block = (uint8_t *)mplite_malloc(&pool,
-			sizeof(uint32_t) * HandleCount);
+		uint32_t hh = Context().Heap->Allocate(sizeof(uint32_t) * HandleCount);
 
-		if (!block) return false;
+		if (!hh) return false;
 
-		uint32_t hh = block - Memory;
 		uint32_t end = hh + 128 * sizeof(uint32_t);
 
+		Context().HandleMap.AddBlock(hh, HandleCount);
+
 		for ( ; hh < end; hh += sizeof(uint32_t))
 		{
-			HandleQueue.push_back(hh);
+			Context().HandleQueue.push_back(hh);
 		}
 
 		return true;
 	}
 
 
+	// points handle at a new block (or none), keeping the block index in
+	// step.
+	void set_handle_block(uint32_t handle, MM::HandleInfo &info, uint32_t address, uint32_t size)
+	{
+		auto &blocks = Context().Blocks;
+
+		if (info.address) blocks.Erase(info.address);
+		if (address) blocks.Insert(address, size, handle);
+
+		if (address && info.purged)
+		{
+			info.purged = false;
+			Context().HeapStats.reloads++;
+		}
+
+		info.address = address;
+		info.size = size;
+	}
+
+
+	// unlocked handle blocks, by address.
+	MM::Allocator::Movable movable_blocks()
+	{
+		MM::Allocator::Movable movable;
+		auto &ctx = Context();
+
+		for (const auto &block : ctx.Blocks)
+		{
+			if (!block.handle) continue;
+			auto iter = ctx.HandleMap.find(block.handle);
+			if (iter != ctx.HandleMap.end() && !iter->second.locked)
+				movable.push_back(block.address);
+		}
+		return movable;
+	}
+
+	// moves unlocked handle blocks together and updates their master
+	// pointers.  Returns how much MaxBlock grew.
+	uint32_t compact_heap()
+	{
+		auto &ctx = Context();
+
+		uint32_t before = ctx.Heap->MaxBlock();
+
+		std::map<uint32_t, uint32_t> moves;
+		ctx.Heap->Compact(movable_blocks(), [&](uint32_t from, uint32_t to) {
+			moves.emplace(from, to);
+		});
+
+		ctx.HeapStats.compactions++;
+
+		if (!moves.empty())
+		{
+			std::vector<MM::BlockIndex::Block> blocks = ctx.Blocks.Blocks();
+			for (auto &block : blocks)
+			{
+				auto m = moves.find(block.address);
+				if (m == moves.end()) continue;
+
+				block.address = m->second;
+
+				auto &info = ctx.HandleMap.find(block.handle)->second;
+				info.address = block.address;
+				memoryWriteLong(block.address, block.handle);
+
+				ctx.HeapStats.blocksMoved++;
+				ctx.HeapStats.bytesMoved += block.size;
+			}
+			ctx.Blocks.Assign(std::move(blocks));
+
+			// code may have been moved.
+			cpuBlockCacheFlush();
+		}
+
+		uint32_t after = ctx.Heap->MaxBlock();
+		uint32_t reclaimed = after > before ? after - before : 0;
+		ctx.HeapStats.bytesReclaimed += reclaimed;
+
+		Log("     compacted heap: %u blocks moved, %u bytes reclaimed\n", (unsigned)moves.size(), reclaimed);
+		return reclaimed;
+	}
+
+	void purge_handle(uint32_t handle, MM::HandleInfo &info)
+	{
+		auto &ctx = Context();
+
+		cpuBlockCacheInvalidate(info.address, info.size);
+		ctx.Heap->Free(info.address);
+		release_pages(info.address, info.size);
+		set_handle_block(handle, info, 0, 0);
+		memoryWriteLong(0, handle);
+
+		info.purged = true;
+		ctx.HeapStats.purges++;
+	}
+
+	// compacting the whole heap is expensive, so a purge loop shouldn't
+	// do it after every handle.  Once it has been tried, only try again
+	// when enough has been purged to make up the last shortfall or when
+	// there's nothing left to purge.
+	class compactor
+	{
+	public:
+		compactor(uint32_t need) : _need(need)
+		{}
+
+		bool operator()(bool last)
+		{
+			auto &heap = Context().Heap;
+
+			uint32_t free = heap->FreeBytes();
+			if (free < _need) return false;
+
+			if (_tried)
+			{
+				if (free <= _free) return false;
+				if (!last && free < _free + _shortfall) return false;
+			}
+
+			compact_heap();
+
+			uint32_t max = heap->MaxBlock();
+			_tried = true;
+			_free = heap->FreeBytes();
+			_shortfall = max < _need ? _need - max : 0;
+			return true;
+		}
+
+	private:
+		uint32_t _need;
+		uint32_t _free = 0;
+		uint32_t _shortfall = 0;
+		bool _tried = false;
+	};
+
+	// purges unlocked, purgeable handles (other than keep), least recently
+	// used first, until fits(last) is satisfied.
+	template<class Fx>
+	bool purge_until(uint32_t keep, Fx fits)
+	{
+		auto &ctx = Context();
+		std::vector<std::pair<uint32_t, uint32_t>> lru; // last use, handle
+
+		for (const auto &kv : ctx.HandleMap)
+		{
+			const auto &info = kv.second;
+			if (kv.first != keep && info.address && info.purgeable && !info.locked)
+				lru.emplace_back(info.lastUse, kv.first);
+		}
+		std::sort(lru.begin(), lru.end());
+
+		for (size_t i = 0; i < lru.size(); ++i)
+		{
+			uint32_t handle = lru[i].second;
+			purge_handle(handle, ctx.HandleMap.find(handle)->second);
+			if (fits(i + 1 == lru.size())) return true;
+		}
+		return false;
+	}
+
+	// allocates, compacting if the heap is too fragmented (rather than
+	// too full) and purging if it's too full.
+	uint32_t allocate(uint32_t size, uint32_t keep = 0)
+	{
+		auto &heap = Context().Heap;
+		compactor compact(size);
+
+		auto fits = [&](bool last) {
+			uint32_t address = heap->Allocate(size);
+			if (!address && compact(last))
+				address = heap->Allocate(size);
+			return address;
+		};
+
+		uint32_t address = fits(false);
+		if (!address)
+			purge_until(keep, [&](bool last) { return (address = fits(last)) != 0; });
+		return address;
+	}
+
+
 	template<class Fx>
 	int16_t with_handle(uint32_t handle, Fx fx)
 	{
-		auto iter = HandleMap.find(handle);
-		if (iter == HandleMap.end()) return MacOS::memWZErr;
+		auto iter = Context().HandleMap.find(handle);
+		if (iter == Context().HandleMap.end()) return MacOS::memWZErr;
 		return fx(iter->second);
 	}
 }
@@ -110,21 +301,21 @@ namespace
 namespace MM
 {
 
-	bool Init(uint8_t *memory, uint32_t memorySize, uint32_t globals, uint32_t stack)
+	bool Init(uint8_t *memory, uint32_t memorySize, uint32_t globals, uint32_t stack, const std::string &allocator, FILE *trace)
 	{
-		int ok;
+		Context().Memory = memory;
+		Context().MemorySize = memorySize;
+		Context().HeapSize = memorySize - stack;
 
-		Memory = memory;
-		MemorySize = memorySize;
-		HeapSize = memorySize - stack;
+		std::unique_ptr<Allocator> heap = CreateAllocator(allocator);
+		if (!heap) return false;
 
-		ok = mplite_init(&pool,
-			memory + globals,
-			memorySize - globals - stack,
-			32,
-			NULL);
+		if (trace) heap.reset(new TraceAllocator(std::move(heap), trace));
 
-		if (ok != MPLITE_OK) return false;
+		if (!heap->Init(memory, globals, memorySize - globals - stack))
+			return false;
+
+		Context().Heap = std::move(heap);
 
 		// allocate a handle master block...
 
@@ -143,80 +334,56 @@ namespace MM
 		// print info on an address.
 		void MemoryInfo(uint32_t address)
 		{
-			// 1. check if it's a pointer.
+			auto print_handle = [](uint32_t handle, const HandleInfo &info)
 			{
-				auto iter = PtrMap.find(address);
-				if (iter != PtrMap.end())
-				{
-					printf("Pointer $%08x Size: $%08x\n", iter->first, iter->second);
-					return;
-				}
-			}
-
-			// 2. check if it's contained in a pointer
-			for (const auto &kv : PtrMap)
-			{
-				if (address < kv.first) continue;
-				if (address >= kv.first + kv.second) continue;
-
-				printf("Pointer $%08x Size: $%08x\n", kv.first, kv.second);
-
-				return;
-			}
+				printf("Handle $%08x Pointer: $%08x Size: $%08x Flags: %c %c %c\n",
+					handle,
+					info.address,
+					info.size,
+					info.locked ? 'L' : ' ',
+					info.purgeable ? 'P' : ' ',
+					info.resource ? 'R' : ' '
+				);
+			};
 
-			// 2. check if it's a handle.
+			// 1. check if it's a handle.
 			{
-				auto iter = HandleMap.find(address);
-				if (iter != HandleMap.end())
+				auto iter = Context().HandleMap.find(address);
+				if (iter != Context().HandleMap.end())
 				{
-					const HandleInfo &info = iter->second;
-					printf("Handle $%08x Pointer: $%08x Size: $%08x Flags: %c %c %c\n",
-						iter->first,
-						info.address,
-						info.size,
-						info.locked ? 'L' : ' ',
-						info.purgeable ? 'P' : ' ',
-						info.resource ? 'R' : ' '
-					);
+					print_handle(iter->first, iter->second);
 					return;
 				}
 			}
 
-			// 3. check if the address is within a handle.
+			// 2. check if it's in a pointer or a handle's block.
+			if (auto block = Context().Blocks.Lookup(address))
 			{
-				for (const auto &kv : HandleMap)
+				if (!block->handle)
 				{
-					const HandleInfo &info = kv.second;
-
-					if (!info.address) continue;
-
-					uint32_t begin = info.address;
-					uint32_t end = info.address + info.size;
-					if (!info.size) end++;
-					if (address >= begin && address < end)
-					{
-						printf("Handle $%08x Pointer: $%08x Size: $%08x Flags: %c %c %c\n",
-							kv.first,
-							info.address,
-							info.size,
-							info.locked ? 'L' : ' ',
-							info.purgeable ? 'P' : ' ',
-							info.resource ? 'R' : ' '
-						);
-						return;
-					}
+					printf("Pointer $%08x Size: $%08x\n", block->address, block->size);
+					return;
 				}
 
-
+				auto iter = Context().HandleMap.find(block->handle);
+				if (iter != Context().HandleMap.end())
+					print_handle(iter->first, iter->second);
 			}
-
 		}
 
 		void PrintMemoryStats()
 		{
-			mplite_print_stats(&pool,  std::puts);
+			const auto &ctx = Context();
+			const auto &stats = ctx.HeapStats;
+
+			ctx.Heap->PrintStats(ctx.Blocks);
 
-			for (const auto & kv : HandleMap)
+			fprintf(stdout, "Compactions: %u (%u blocks, %llu bytes moved, %llu bytes reclaimed)\n",
+				stats.compactions, stats.blocksMoved,
+				(unsigned long long)stats.bytesMoved, (unsigned long long)stats.bytesReclaimed);
+			fprintf(stdout, "Purged handles: %u reloaded: %u\n", stats.purges, stats.reloads);
+
+			for (const auto & kv : Context().HandleMap)
 			{
 				const auto h = kv.first;
 				const auto & info = kv.second;
@@ -233,6 +400,71 @@ namespace MM
 		}
 
 
+		void SaveState(FILE *f)
+		{
+			auto &ctx = Context();
+
+			State::Write(f, ctx.HeapSize);
+			State::Write(f, std::string(ctx.Heap->Name()));
+			ctx.Heap->SaveState(f);
+
+			State::Write(f, ctx.HandleQueue);
+			State::Write(f, ctx.HandleMap.MasterBlocks());
+			State::Write(f, (uint32_t)ctx.HandleMap.size());
+			for (const auto &kv : ctx.HandleMap)
+			{
+				State::Write(f, kv.first);
+				State::Write(f, kv.second);
+			}
+			State::Write(f, ctx.Blocks.Blocks());
+			State::Write(f, ctx.HandleClock);
+		}
+
+		void LoadState(FILE *f)
+		{
+			auto &ctx = Context();
+			std::string allocator;
+
+			State::Read(f, ctx.HeapSize);
+			State::Read(f, allocator);
+
+			ctx.Heap = CreateAllocator(allocator);
+			if (!ctx.Heap)
+			{
+				// not ours -- make sure the caller notices.
+				fseek(f, 0, SEEK_END);
+				fgetc(f);
+				return;
+			}
+			ctx.Heap->LoadState(ctx.Memory, f);
+
+			std::vector<HandleTable::MasterBlock> masterBlocks;
+			std::vector<BlockIndex::Block> blocks;
+			uint32_t count = 0;
+
+			State::Read(f, ctx.HandleQueue);
+			State::Read(f, masterBlocks);
+			State::Read(f, count);
+
+			ctx.HandleMap.clear();
+			for (const auto &mb : masterBlocks)
+				ctx.HandleMap.AddBlock(mb.address, mb.count);
+
+			while (count-- && !feof(f))
+			{
+				uint32_t handle = 0;
+				HandleInfo info;
+				State::Read(f, handle);
+				State::Read(f, info);
+				ctx.HandleMap.emplace(handle, info);
+			}
+
+			State::Read(f, blocks);
+			ctx.Blocks.Assign(std::move(blocks));
+			State::Read(f, ctx.HandleClock);
+		}
+
+
 		uint16_t NewPtr(uint32_t size, bool clear, uint32_t &mcptr)
 		{
 			// native pointers.
@@ -240,18 +472,16 @@ namespace MM
 			mcptr = 0;
 			//if (size == 0) return 0;
 
-			uint8_t *ptr = nullptr;
-			ptr = (uint8_t *)mplite_malloc(&pool, size ? size : 1);
-			if (!ptr)
+			mcptr = allocate(size);
+			if (!mcptr)
 			{
 				return SetMemError(MacOS::memFullErr);
 			}
 
 			if (clear)
-				std::memset(ptr, 0, size);
+				std::memset(Context().Memory + mcptr, 0, size);
 
-			mcptr = ptr - Memory;
-			PtrMap.emplace(std::make_pair(mcptr, size));
+			Context().Blocks.Insert(mcptr, size);
 
 			return SetMemError(0);
 		}
@@ -259,14 +489,16 @@ namespace MM
 		uint16_t DisposePtr(uint32_t mcptr)
 		{
 
-			auto iter = PtrMap.find(mcptr);
+			auto block = Context().Blocks.Find(mcptr);
 
-			if (iter == PtrMap.end()) return SetMemError(MacOS::memWZErr);
-			PtrMap.erase(iter);
+			if (!block || block->handle) return SetMemError(MacOS::memWZErr);
 
-			uint8_t *ptr = mcptr + Memory;
+			uint32_t size = block->size;
 
-			mplite_free(&pool, ptr);
+			Context().Blocks.Erase(mcptr);
+			cpuBlockCacheInvalidate(mcptr, size);
+			Context().Heap->Free(mcptr);
+			release_pages(mcptr, size);
 
 			return SetMemError(0);
 		}
@@ -279,7 +511,7 @@ namespace MM
 			handle = 0;
 			mcptr = 0;
 
-			if (!HandleQueue.size())
+			if (!Context().HandleQueue.size())
 			{
 				if (!alloc_handle_block())
 				{
@@ -287,8 +519,8 @@ namespace MM
 				}
 			}
 
-			hh = HandleQueue.front();
-			HandleQueue.pop_front();
+			hh = Context().HandleQueue.front();
+			Context().HandleQueue.pop_front();
 
 			ptr = nullptr;
 
@@ -299,20 +531,23 @@ namespace MM
 			// Assertion failed: *fHandle != NULL
 			//if (size)
 			//{
-				ptr = (uint8_t *)mplite_malloc(&pool, size ? size : 1);
-				if (!ptr)
+				mcptr = allocate(size);
+				if (!mcptr)
 				{
-					HandleQueue.push_back(hh);
+					Context().HandleQueue.push_back(hh);
 					return SetMemError(MacOS::memFullErr);
 				}
-				mcptr = ptr - Memory;
+				ptr = mcptr + Context().Memory;
 
 				if (clear)
 					std::memset(ptr, 0, size);
 			//}
 
 			// need a handle -> ptr map?
-			HandleMap.emplace(std::make_pair(hh, HandleInfo(mcptr, size)));
+			HandleInfo info(mcptr, size);
+			info.lastUse = ++Context().HandleClock;
+			Context().HandleMap.emplace(std::make_pair(hh, info));
+			Context().Blocks.Insert(mcptr, size, hh);
 
 			memoryWriteLong(mcptr, hh);
 			handle = hh;
@@ -329,21 +564,22 @@ namespace MM
 
 		uint16_t DisposeHandle(uint32_t handle)
 		{
-			auto iter = HandleMap.find(handle);
+			auto iter = Context().HandleMap.find(handle);
 
-			if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+			if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 			HandleInfo info = iter->second;
 
-			HandleMap.erase(iter);
+			Context().HandleMap.erase(iter);
 
 			if (info.address)
 			{
-				uint8_t *ptr = info.address + Memory;
-
-				mplite_free(&pool, ptr);
+				Context().Blocks.Erase(info.address);
+				cpuBlockCacheInvalidate(info.address, info.size);
+				Context().Heap->Free(info.address);
+				release_pages(info.address, info.size);
 			}
-			HandleQueue.push_back(handle);
+			Context().HandleQueue.push_back(handle);
 
 			return SetMemError(0);
 		}
@@ -353,9 +589,9 @@ namespace MM
 		{
 			handleSize = 0;
 
-			const auto iter = HandleMap.find(handle);
+			const auto iter = Context().HandleMap.find(handle);
 
-			if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+			if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 			handleSize = iter->second.size;
 			return SetMemError(0);
 		}
@@ -364,9 +600,9 @@ namespace MM
 		uint16_t ReallocHandle(uint32_t handle, uint32_t logicalSize)
 		{
 
-			auto iter = HandleMap.find(handle);
+			auto iter = Context().HandleMap.find(handle);
 
-			if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+			if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 			auto& info = iter->second;
 
@@ -377,28 +613,24 @@ namespace MM
 
 			if (logicalSize)
 			{
-				// todo -- purge & retry on failure.
-
-				void *address = mplite_malloc(&pool, logicalSize);
-				if (!address) return SetMemError(MacOS::memFullErr);
-
-				mcptr = (uint8_t *)address - Memory;
+				mcptr = allocate(logicalSize, handle);
+				if (!mcptr) return SetMemError(MacOS::memFullErr);
 			}
 
 			// the handle is not altered in the event of an error.
 			if (info.address)
 			{
-				void *address = Memory + info.address;
-
-				mplite_free(&pool, address);
+				cpuBlockCacheInvalidate(info.address, info.size);
+				Context().Heap->Free(info.address);
 			}
 
-			info.address = mcptr;
-			info.size = logicalSize;
+			set_handle_block(handle, info, mcptr, logicalSize);
 
 			memoryWriteLong(mcptr, handle);
 
-			// lock?  clear purged flag?
+			info.lastUse = ++Context().HandleClock;
+
+			// lock?
 
 			return 0;
 
@@ -409,9 +641,9 @@ namespace MM
 		{
 			if (handle == 0) return SetMemError(MacOS::nilHandleErr);
 
-			const auto iter = HandleMap.find(handle);
+			const auto iter = Context().HandleMap.find(handle);
 
-			if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+			if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 			auto &info = iter->second;
 
@@ -419,7 +651,6 @@ namespace MM
 			if (info.size == newSize) return SetMemError(0);
 
 			uint32_t mcptr = info.address;
-			uint8_t *ptr = mcptr + Memory;
 
 			// 1. - resizing to 0.
 			if (!newSize)
@@ -429,16 +660,17 @@ namespace MM
 					//return SetMemError(MacOS::memLockedErr);
 
 					// ppclink resizes locked handles.
-					info.size = 0;
+					set_handle_block(handle, info, info.address, 0);
 					return SetMemError(0);
 				}
 
 				// todo -- size 0 should have a ptr to differentiate
 				// from purged.
 
-				mplite_free(&pool, ptr);
-				info.address = 0;
-				info.size = 0;
+				cpuBlockCacheInvalidate(mcptr, info.size);
+				Context().Heap->Free(mcptr);
+				release_pages(mcptr, info.size);
+				set_handle_block(handle, info, 0, 0);
 
 				memoryWriteLong(info.address, handle);
 				return SetMemError(0);
@@ -450,71 +682,58 @@ namespace MM
 			{
 				if (info.locked) return SetMemError(MacOS::memLockedErr);
 
-				ptr = (uint8_t *)mplite_malloc(&pool, newSize);
-				if (!ptr) return SetMemError(MacOS::memFullErr);
+				mcptr = allocate(newSize);
+				if (!mcptr) return SetMemError(MacOS::memFullErr);
 
-				mcptr = ptr - Memory;
-				info.address = mcptr;
-				info.size = newSize;
+				set_handle_block(handle, info, mcptr, newSize);
 
 				memoryWriteLong(info.address, handle);
 				return SetMemError(0);
 			}
 
-			for (unsigned i = 0; i < 2; ++i)
-			{
+			auto resize = [&]() {
 
 				// 3. - locked
 				if (info.locked)
 				{
-					if (mplite_resize(&pool, ptr, mplite_roundup(&pool, newSize)) == MPLITE_OK)
-					{
-						info.size = newSize;
-						return SetMemError(0);
-					}
-				}
-				else
-				{
+					if (!Context().Heap->Resize(mcptr, newSize)) return false;
 
-					// 4. - resize.
-
-					ptr = (uint8_t *)mplite_realloc(&pool, ptr, mplite_roundup(&pool, newSize));
+					set_handle_block(handle, info, info.address, newSize);
+					return true;
+				}
 
-					if (ptr)
-					{
-						mcptr = ptr - Memory;
-						info.address = mcptr;
-						info.size = newSize;
+				// 4. - resize.
 
-						memoryWriteLong(info.address, handle);
-						return SetMemError(0);
-					}
+				// the block may move.
+				cpuBlockCacheInvalidate(mcptr, info.size);
+				uint32_t address = Context().Heap->Reallocate(mcptr, newSize);
+				if (!address) return false;
 
-				}
+				mcptr = address;
+				set_handle_block(handle, info, mcptr, newSize);
 
-				fprintf(stderr, "mplite_realloc failed.\n");
-				Native::PrintMemoryStats();
+				memoryWriteLong(info.address, handle);
+				return true;
+			};
+
+			// a locked block can't move, but the one after it can.
+			compactor grow(newSize - info.size);
+			auto compact = [&](bool last) {
+				if (!grow(last)) return false;
+
+				mcptr = info.address;
+				return true;
+			};
+
+			// try, compact and try, purge until it fits.
+			if (resize()) return SetMemError(0);
+			if (compact(false) && resize()) return SetMemError(0);
+			if (purge_until(handle, [&](bool last) { return resize() || (compact(last) && resize()); }))
+				return SetMemError(0);
 
-				if (i > 0) return SetMemError(MacOS::memFullErr);
+			fprintf(stderr, "SetHandleSize failed.\n");
+			Native::PrintMemoryStats();
 
-				// purge...
-				for (auto & kv : HandleMap)
-				{
-					uint32_t ph = kv.first;
-					auto &info = kv.second;
-
-					if (ph == handle) continue;
-					if (info.size && info.purgeable && !info.locked)
-					{
-						mplite_free(&pool, Memory + info.address);
-						info.size = 0;
-						info.address = 0;
-
-						// also need to update memory
-						memoryWriteLong(0, ph);
-					}
-				}
-			}
 			return SetMemError(MacOS::memFullErr);
 
 		}
@@ -523,9 +742,9 @@ namespace MM
 		template<class FX>
 		uint16_t HandleIt(uint32_t handle, FX fx)
 		{
-			const auto iter = HandleMap.find(handle);
+			const auto iter = Context().HandleMap.find(handle);
 
-			if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+			if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 			auto &info = iter->second;
 			fx(info);
@@ -534,9 +753,9 @@ namespace MM
 
 		uint16_t HSetRBit(uint32_t handle)
 		{
-			const auto iter = HandleMap.find(handle);
+			const auto iter = Context().HandleMap.find(handle);
 
-			if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+			if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 			auto &info = iter->second;
 			info.resource = true;
@@ -545,9 +764,9 @@ namespace MM
 
 		uint16_t HClrRBit(uint32_t handle)
 		{
-			const auto iter = HandleMap.find(handle);
+			const auto iter = Context().HandleMap.find(handle);
 
-			if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+			if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 			auto &info = iter->second;
 			info.resource = false;
@@ -556,20 +775,28 @@ namespace MM
 
 		uint16_t HLock(uint32_t handle)
 		{
-			const auto iter = HandleMap.find(handle);
+			const auto iter = Context().HandleMap.find(handle);
 
-			if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+			if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 			auto &info = iter->second;
 			info.locked = true;
+			info.lastUse = ++Context().HandleClock;
 			return SetMemError(0);
 		}
 
+		void TouchHandle(uint32_t handle)
+		{
+			auto iter = Context().HandleMap.find(handle);
+			if (iter != Context().HandleMap.end())
+				iter->second.lastUse = ++Context().HandleClock;
+		}
+
 		uint16_t HUnlock(uint32_t handle)
 		{
-			const auto iter = HandleMap.find(handle);
+			const auto iter = Context().HandleMap.find(handle);
 
-			if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+			if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 			auto &info = iter->second;
 			info.locked = false;
@@ -586,9 +813,9 @@ namespace MM
 	tool_return<uint32_t> GetHandleSize(uint32_t handle)
 	{
 
-		const auto iter = HandleMap.find(handle);
+		const auto iter = Context().HandleMap.find(handle);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 		SetMemError(0);
 		return iter->second.size;
@@ -596,9 +823,9 @@ namespace MM
 
 	tool_return<HandleInfo> GetHandleInfo(uint32_t handle)
 	{
-		const auto iter = HandleMap.find(handle);
+		const auto iter = Context().HandleMap.find(handle);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 		SetMemError(0);
 		return iter->second;
 	}
@@ -610,7 +837,8 @@ namespace MM
 	uint16_t BlockMove(uint16_t trap)
 	{
 		// also implements BlockMoveData.
-		// BlockMove will flush caches, BlockMoveData will not.
+		// BlockMove will flush caches, BlockMoveData will not
+		// (but the block cache still sees code being overwritten).
 
 		/*
 		 * on entry:
@@ -632,14 +860,13 @@ namespace MM
 			trap, source, dest, count);
 
 		// TODO -- 32-bit clean?
-		// TODO -- verify within MemorySize?
 
 		#if 0
 		if (source == 0 || dest == 0 || count == 0)
 			return 0;
 		#endif
 
-		std::memmove(Memory + dest, Memory + source, count);
+		memoryMove(dest, source, count);
 
 		return 0;
 	}
@@ -647,8 +874,6 @@ namespace MM
 
 	uint32_t CompactMem(uint16_t trap)
 	{
-		// todo -- add function to check pool for largest block?
-
 		/*
 		 * on entry:
 		 * D0: cbNeeded (long word)
@@ -661,9 +886,12 @@ namespace MM
 
 		 Log("%04x CompactMem(%08x)\n", trap, cbNeeded);
 
+		 // the whole heap is compacted; there's no point stopping early.
+		 if (Context().Heap->MaxBlock() < cbNeeded)
+			compact_heap();
 
 		 SetMemError(0);
-		 return mplite_maxmem(&pool);
+		 return Context().Heap->MaxBlock();
 	}
 
 	uint32_t MaxMem(uint16_t trap)
@@ -681,7 +909,7 @@ namespace MM
 		Log("%04x MaxMem()\n", trap);
 
 		SetMemError(0);
-		return mplite_maxmem(&pool);
+		return Context().Heap->MaxBlock();
 	}
 
 	uint32_t MaxBlock(uint16_t trap)
@@ -704,7 +932,7 @@ namespace MM
 		Log("%04x MaxBlock()\n", trap);
 
 		SetMemError(0);
-		return mplite_maxmem(&pool);
+		return Context().Heap->CompactedMaxBlock(movable_blocks());
 	}
 
 	uint32_t FreeMem(uint16_t trap)
@@ -722,7 +950,7 @@ namespace MM
 		Log("%04x FreeMem()\n", trap);
 
 		SetMemError(0);
-		return mplite_freemem(&pool);
+		return Context().Heap->FreeBytes();
 	}
 
 
@@ -744,9 +972,16 @@ namespace MM
 
 		Log("%04x ReserveMem($%08x)\n", trap, cbNeeded);
 
-		available = mplite_maxmem(&pool);
-		// TODO -- if available < cbNeeded, purge handle and retry?
-		if (available < cbNeeded) return SetMemError(MacOS::memFullErr);
+		auto &heap = Context().Heap;
+		compactor compact(cbNeeded);
+		auto fits = [&](bool last) {
+			if (heap->MaxBlock() < cbNeeded) compact(last);
+			return heap->MaxBlock() >= cbNeeded;
+		};
+
+		available = heap->MaxBlock();
+		if (available < cbNeeded && !fits(false) && !purge_until(0, fits))
+			return SetMemError(MacOS::memFullErr);
 
 		return SetMemError(0);
 	}
@@ -769,8 +1004,31 @@ namespace MM
 
 		// check if it's valid.
 
-		auto iter = HandleMap.find(theHandle);
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		auto &ctx = Context();
+		auto iter = ctx.HandleMap.find(theHandle);
+		if (iter == ctx.HandleMap.end()) return SetMemError(MacOS::memWZErr);
+
+		auto &info = iter->second;
+		if (info.locked) return SetMemError(MacOS::memLockedErr);
+		if (!info.address) return SetMemError(0);
+
+		// move it if there's room above it, otherwise leave it be.
+		uint32_t from = info.address;
+		uint32_t to = ctx.Heap->AllocateHigh(info.size);
+		if (!to) return SetMemError(0);
+		if (to < from)
+		{
+			ctx.Heap->Free(to);
+			return SetMemError(0);
+		}
+
+		std::memcpy(ctx.Memory + to, ctx.Memory + from, info.size);
+		cpuBlockCacheInvalidate(from, info.size);
+		ctx.Heap->Free(from);
+		release_pages(from, info.size);
+
+		set_handle_block(theHandle, info, to, info.size);
+		memoryWriteLong(to, theHandle);
 
 		return SetMemError(0);
 	}
@@ -796,7 +1054,7 @@ namespace MM
 
 		// MemorySize is the top of the heap. stack is after it.
 
-		return sp - HeapSize;
+		return sp - Context().HeapSize;
 	}
 
 
@@ -873,11 +1131,11 @@ namespace MM
 
 		Log("%08x GetPtrSize(%08x)\n", trap, mcptr);
 
-		auto iter = PtrMap.find(mcptr);
+		auto block = Context().Blocks.Find(mcptr);
 
-		if (iter == PtrMap.end()) return SetMemError(MacOS::memWZErr);
+		if (!block || block->handle) return SetMemError(MacOS::memWZErr);
 
-		return iter->second;
+		return block->size;
 	}
 
 	uint16_t SetPtrSize(uint16_t trap)
@@ -897,19 +1155,17 @@ namespace MM
 
 		Log("%08x SetPtrSize(%08x, %08x)\n", trap, mcptr, newSize);
 
-		auto iter = PtrMap.find(mcptr);
-
-		if (iter == PtrMap.end()) return SetMemError(MacOS::memWZErr);
+		auto block = Context().Blocks.Find(mcptr);
 
-		uint8_t *ptr = mcptr + Memory;
+		if (!block || block->handle) return SetMemError(MacOS::memWZErr);
 
-		if (mplite_resize(&pool, ptr, mplite_roundup(&pool, newSize)) < 0)
+		if (!Context().Heap->Resize(mcptr, newSize))
 		{
 			return SetMemError(MacOS::memFullErr);
 		}
 
 		// update the size.
-		iter->second = newSize;
+		Context().Blocks.Resize(mcptr, newSize);
 
 		return SetMemError(0);
 	}
@@ -976,20 +1232,19 @@ namespace MM
 		uint32_t hh = cpuGetAReg(0);
 		Log("%04x EmptyHandle(%08x)\n", trap, hh);
 
-		auto iter = HandleMap.find(hh);
+		auto iter = Context().HandleMap.find(hh);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 		auto &info = iter->second;
 		if (info.address == 0) return SetMemError(0);
 		if (info.locked) return SetMemError(MacOS::memLockedErr); // ?
 
-		void *address = Memory + info.address;
+		cpuBlockCacheInvalidate(info.address, info.size);
+		Context().Heap->Free(info.address);
+		release_pages(info.address, info.size);
 
-		mplite_free(&pool, address);
-
-		info.address = 0;
-		info.size = 0;
+		set_handle_block(hh, info, 0, 0);
 
 		memoryWriteLong(0, hh);
 		return 0;
@@ -1029,9 +1284,9 @@ namespace MM
 		return Native::ReallocHandle(hh, logicalSize);
 
 #if 0
-		auto iter = HandleMap.find(hh);
+		auto iter = Context().HandleMap.find(hh);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 		auto& info = iter->second;
 
@@ -1039,9 +1294,9 @@ namespace MM
 
 		if (info.address)
 		{
-			void *address = Memory + info.address;
+			void *address = Context().Memory + info.address;
 
-			mplite_free(&pool, address);
+			mplite_free(&Context().Pool, address);
 
 			info.address = 0;
 			info.size = 0;
@@ -1051,10 +1306,10 @@ namespace MM
 		// allocate a new block...
 		if (logicalSize == 0) return SetMemError(0);
 
-		void *address = mplite_malloc(&pool, logicalSize);
+		void *address = mplite_malloc(&Context().Pool, logicalSize);
 		if (!address) return SetMemError(MacOS::memFullErr);
 
-		uint32_t mcptr = (uint8_t *)address - Memory;
+		uint32_t mcptr = (uint8_t *)address - Context().Memory;
 
 		info.size = logicalSize;
 		info.address = mcptr;
@@ -1095,9 +1350,9 @@ namespace MM
 
 		if (hh == 0) return SetMemError(MacOS::nilHandleErr); // ????
 
-		auto iter = HandleMap.find(hh);
+		auto iter = Context().HandleMap.find(hh);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 		return iter->second.size;
 	}
@@ -1145,21 +1400,11 @@ namespace MM
 		Log("%04x RecoverHandle(%08x)\n", trap, p);
 
 		uint16_t error = MacOS::memBCErr;
-		for (const auto &kv : HandleMap)
+		auto block = Context().Blocks.Lookup(p);
+		if (block && block->handle)
 		{
-			const HandleInfo &info = kv.second;
-
-			if (!info.address) continue;
-
-			uint32_t begin = info.address;
-			uint32_t end = info.address + info.size;
-			if (!info.size) end++;
-			if (p >= begin && p < end)
-			{
-				hh = kv.first;
-				error = MacOS::noErr;
-				break;
-			}
+			hh = block->handle;
+			error = MacOS::noErr;
 		}
 
 		SetMemError(error);
@@ -1189,9 +1434,9 @@ namespace MM
 		Log("%04x HGetState(%08x)\n", trap, hh);
 
 
-		auto iter = HandleMap.find(hh);
+		auto iter = Context().HandleMap.find(hh);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 		/*
 		 * flag bits:
@@ -1232,9 +1477,9 @@ namespace MM
 
 		Log("%04x HSetState(%08x, %04x)\n", trap, hh, flags);
 
-		auto iter = HandleMap.find(hh);
+		auto iter = Context().HandleMap.find(hh);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 		auto &info = iter->second;
 
@@ -1262,9 +1507,9 @@ namespace MM
 
 		Log("%04x HPurge(%08x)\n", trap, hh);
 
-		auto iter = HandleMap.find(hh);
+		auto iter = Context().HandleMap.find(hh);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 		iter->second.purgeable = true;
 
 		return SetMemError(0);
@@ -1287,9 +1532,9 @@ namespace MM
 
 		Log("%04x HNoPurge(%08x)\n", trap, hh);
 
-		auto iter = HandleMap.find(hh);
+		auto iter = Context().HandleMap.find(hh);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 		iter->second.purgeable = false;
 
 		return SetMemError(0);
@@ -1310,11 +1555,12 @@ namespace MM
 
 		Log("%04x HLock(%08x)\n", trap, hh);
 
-		auto iter = HandleMap.find(hh);
+		auto iter = Context().HandleMap.find(hh);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 		iter->second.locked = true;
+		iter->second.lastUse = ++Context().HandleClock;
 		return SetMemError(0);
 	}
 
@@ -1333,9 +1579,9 @@ namespace MM
 
 		Log("%04x HUnlock(%08x)\n", trap, hh);
 
-		auto iter = HandleMap.find(hh);
+		auto iter = Context().HandleMap.find(hh);
 
-		if (iter == HandleMap.end()) return SetMemError(MacOS::memWZErr);
+		if (iter == Context().HandleMap.end()) return SetMemError(MacOS::memWZErr);
 
 		iter->second.locked = false;
 		return SetMemError(0);
@@ -1360,22 +1606,29 @@ namespace MM
 
 		Log("%04x HandToHand(%08x)\n", trap, srcHandle);
 
-		auto iter = HandleMap.find(srcHandle);
-		if (iter == HandleMap.end())
+		auto iter = Context().HandleMap.find(srcHandle);
+		if (iter == Context().HandleMap.end())
 			return SetMemError(MacOS::memWZErr);
 
 
-		auto const info = iter->second;
-
+		// NewHandle may compact or purge the heap -- keep the source
+		// where it is until it's copied.
+		bool locked = iter->second.locked;
+		iter->second.locked = true;
 
 		uint32_t destHandle;
 		uint32_t destPtr;
-		uint32_t d0 = Native::NewHandle(info.size, false, destHandle, destPtr);
+		uint32_t d0 = Native::NewHandle(iter->second.size, false, destHandle, destPtr);
+
+		// (NewHandle may have added a master pointer block.)
+		auto &info = Context().HandleMap.find(srcHandle)->second;
 		if (d0 == 0)
 		{
-			std::memmove(memoryPointer(destPtr), memoryPointer(info.address), info.size);
+			memoryMove(destPtr, info.address, info.size);
 		}
 
+		info.locked = locked;
+
 		cpuSetAReg(0, destHandle);
 		return d0; // SetMemError called by Native::NewHandle.
 	}
@@ -1404,7 +1657,7 @@ namespace MM
 		uint32_t d0 = Native::NewHandle(size, false, destHandle, destPtr);
 		if (d0 == 0)
 		{
-			std::memmove(memoryPointer(destPtr), memoryPointer(mcptr), size);
+			memoryMove(destPtr, mcptr, size);
 		}
 
 		cpuSetAReg(0, destHandle);
@@ -1448,13 +1701,13 @@ namespace MM
 		d0 = Native::SetHandleSize(handle, oldSize + size);
 		if (d0) return d0;
 
-		auto iter = HandleMap.find(handle);
-		if (iter == HandleMap.end())
+		auto iter = Context().HandleMap.find(handle);
+		if (iter == Context().HandleMap.end())
 			return SetMemError(MacOS::memWZErr);
 
 		auto const info = iter->second;
 
-		std::memmove(memoryPointer(info.address + oldSize), memoryPointer(ptr), size);
+		memoryMove(info.address + oldSize, ptr, size);
 
 		return SetMemError(0);
 	}
@@ -1474,14 +1727,13 @@ namespace MM
 		 *
 		 */
 
-		// TODO -- in 32-bit mode, this is a nop.
-		// have a --24 / --32 flag?
+		// in 32-bit mode, this is a nop.
 
 		uint32_t address = cpuGetDReg(0);
 
 		Log("%04x StripAddress(%08x)\n", trap, address);
 
-		if (MemorySize <= 0x00ffffff)
+		if (!memoryGetAddress32Bit())
 			address &= 0x00ffffff;
 
 		return address;
@@ -1506,7 +1758,7 @@ namespace MM
 		Log("%04x HandleZone(%08x)\n", trap, h);
 
 
-		if (HandleMap.find(h) == HandleMap.end())
+		if (Context().HandleMap.find(h) == Context().HandleMap.end())
 		{
 			cpuSetAReg(0, 0);
 			return SetMemError(MacOS::memWZErr);
@@ -1600,8 +1852,8 @@ namespace MM
 		Log("%04x PurgeSpace()\n", trap);
 
 		 SetMemError(0);
-		 cpuSetAReg(0, mplite_maxmem(&pool));
-		 return mplite_freemem(&pool);
+		 cpuSetAReg(0, Context().Heap->MaxBlock());
+		 return Context().Heap->FreeBytes();
 	}
 
 	uint16_t TempMaxMem(void)
@@ -1616,7 +1868,7 @@ namespace MM
 
 		if (address) memoryWriteLong(0, address);
 
-		ToolReturn<4>(sp, mplite_maxmem(&pool));
+		ToolReturn<4>(sp, Context().Heap->MaxBlock());
 
 		return SetMemError(0);
 	}
@@ -1628,7 +1880,7 @@ namespace MM
 
 		Log("     TempFreeMem()\n");
 
-		ToolReturn<4>(-1, mplite_freemem(&pool));
+		ToolReturn<4>(-1, Context().Heap->FreeBytes());
 
 		return SetMemError(0);
 	}
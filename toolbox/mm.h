@@ -2,6 +2,8 @@
 #define __mpw_mm_h__
 
 #include <cstdint>
+#include <cstdio>
+#include <string>
 
 #include <macos/tool_return.h>
 
@@ -14,6 +16,11 @@ namespace MM
 		void MemoryInfo(uint32_t address);
 		void PrintMemoryStats();
 
+		// --snapshot / --restore.  The caller saves and maps emulated
+		// memory; LoadState expects it to be in the context already.
+		void SaveState(FILE *f);
+		void LoadState(FILE *f);
+
 		uint16_t NewHandle(uint32_t size, bool clear, uint32_t &handle);
 		uint16_t NewHandle(uint32_t size, bool clear, uint32_t &handle, uint32_t &ptr);
 
@@ -32,9 +39,16 @@ namespace MM
 
 		uint16_t HLock(uint32_t handle);
 		uint16_t HUnlock(uint32_t handle);
+
+		// marks a handle as just used -- purgeable handles are purged
+		// least recently used first.
+		void TouchHandle(uint32_t handle);
 	}
 
-	bool Init(uint8_t *memory, uint32_t memorySize, uint32_t globals, uint32_t stack);
+	// allocator is an --allocator name (see mm_allocator.h).  Heap calls
+	// are logged to trace, if there is one.
+	bool Init(uint8_t *memory, uint32_t memorySize, uint32_t globals, uint32_t stack,
+		const std::string &allocator = "buddy", FILE *trace = nullptr);
 
 
 	struct HandleInfo
@@ -44,12 +58,26 @@ namespace MM
 		bool locked = false;
 		bool purgeable = false;
 		bool resource = false;
+		bool purged = false;
+		uint32_t lastUse = 0; // EmulatorContext::HandleClock
 
 		HandleInfo(uint32_t a = 0, uint32_t s = 0) :
 			address(a), size(s)
 		{}
 	};
 
+	// compaction and purge counters, for --memory-stats.
+	struct HeapStats
+	{
+		uint32_t compactions = 0;
+		uint32_t blocksMoved = 0;
+		uint64_t bytesMoved = 0;
+		uint64_t bytesReclaimed = 0; // MaxBlock gained
+
+		uint32_t purges = 0;
+		uint32_t reloads = 0; // purged handles reallocated
+	};
+
 	using MacOS::tool_return;
 
 	tool_return<HandleInfo> GetHandleInfo(uint32_t handle);
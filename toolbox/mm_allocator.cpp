@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+#include "mm_allocator.h"
+#include "mm_slab.h"
+#include "mm_tlsf.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace MM {
+
+	uint32_t Allocator::Reallocate(uint32_t address, uint32_t size)
+	{
+		if (Resize(address, size)) return address;
+
+		uint32_t newAddress = Allocate(size);
+		if (!newAddress) return 0;
+
+		std::memcpy(_memory + newAddress, _memory + address, std::min(BlockSize(address), size));
+		Free(address);
+
+		return newAddress;
+	}
+
+
+	// lowest first, each block moves to a new block if Allocate puts it
+	// lower down.  It's only as good as Allocate's placement.
+	void Allocator::Compact(const Movable &movable, const Moved &moved)
+	{
+		for (uint32_t from : movable)
+		{
+			uint32_t size = BlockSize(from);
+			uint32_t to = Allocate(size);
+			if (!to) continue;
+
+			if (to > from)
+			{
+				Free(to);
+				continue;
+			}
+
+			std::memcpy(_memory + to, _memory + from, size);
+			Free(from);
+			moved(from, to);
+		}
+	}
+
+
+	void Allocator::PrintStats(const BlockIndex &blocks) const
+	{
+		uint64_t requested = 0;
+		uint64_t allocated = 0;
+
+		for (const auto &b : blocks)
+		{
+			requested += b.size;
+			allocated += BlockSize(b.address);
+		}
+
+		uint32_t free = FreeBytes();
+		uint32_t largest = MaxBlock();
+
+		fprintf(stdout, "Allocator: %s\n", Name());
+		fprintf(stdout, "Blocks: %u requested: %llu allocated: %llu (%.1f%% internal fragmentation)\n",
+			(unsigned)blocks.size(),
+			(unsigned long long)requested, (unsigned long long)allocated,
+			allocated ? 100.0 * (allocated - requested) / allocated : 0.0);
+		fprintf(stdout, "Free memory: %u Largest free block: %u (%.1f%% external fragmentation)\n",
+			free, largest,
+			free ? 100.0 * (free - std::min(free, largest)) / free : 0.0);
+	}
+
+
+	std::unique_ptr<Allocator> CreateAllocator(const std::string &name)
+	{
+		if (name == "buddy") return std::unique_ptr<Allocator>(new SlabHeap);
+		if (name == "tlsf") return std::unique_ptr<Allocator>(new TlsfHeap);
+		return nullptr;
+	}
+
+
+	// TraceAllocator
+
+	TraceAllocator::TraceAllocator(std::unique_ptr<Allocator> allocator, FILE *file) :
+		_allocator(std::move(allocator)), _file(file)
+	{}
+
+	TraceAllocator::~TraceAllocator()
+	{
+		fclose(_file);
+	}
+
+	bool TraceAllocator::Init(uint8_t *memory, uint32_t base, uint32_t size)
+	{
+		_memory = memory;
+		fprintf(_file, "# mpw allocation trace %s %x %x\n", _allocator->Name(), base, size);
+		return _allocator->Init(memory, base, size);
+	}
+
+	void TraceAllocator::LoadState(uint8_t *memory, FILE *f)
+	{
+		_memory = memory;
+		_allocator->LoadState(memory, f);
+	}
+
+	uint32_t TraceAllocator::Allocate(uint32_t size)
+	{
+		uint32_t address = _allocator->Allocate(size);
+		fprintf(_file, "a %x %x\n", size, address);
+		return address;
+	}
+
+	void TraceAllocator::Free(uint32_t address)
+	{
+		_allocator->Free(address);
+		fprintf(_file, "f %x\n", address);
+	}
+
+	bool TraceAllocator::Resize(uint32_t address, uint32_t size)
+	{
+		bool ok = _allocator->Resize(address, size);
+		fprintf(_file, "r %x %x %d\n", address, size, ok);
+		return ok;
+	}
+
+	uint32_t TraceAllocator::AllocateHigh(uint32_t size)
+	{
+		uint32_t address = _allocator->AllocateHigh(size);
+		fprintf(_file, "h %x %x\n", size, address);
+		return address;
+	}
+
+	void TraceAllocator::Compact(const Movable &movable, const Moved &moved)
+	{
+		fprintf(_file, "c\n");
+		_allocator->Compact(movable, [&](uint32_t from, uint32_t to) {
+			fprintf(_file, "v %x %x\n", from, to);
+			moved(from, to);
+		});
+	}
+
+	uint32_t TraceAllocator::Reallocate(uint32_t address, uint32_t size)
+	{
+		uint32_t newAddress = _allocator->Reallocate(address, size);
+		fprintf(_file, "m %x %x %x\n", address, size, newAddress);
+		return newAddress;
+	}
+
+}
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+#ifndef __mpw_mm_allocator_h__
+#define __mpw_mm_allocator_h__
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mm_index.h"
+
+/*
+ * The Memory Manager's heap.
+ *
+ * An Allocator hands out blocks of the emulated heap.  Addresses are
+ * emulated addresses; 0 is failure.  Any bookkeeping an allocator keeps
+ * inside the heap must survive the heap being saved and mapped back
+ * somewhere else (--snapshot / --restore), so nothing in there may be a
+ * host pointer.
+ *
+ * --allocator picks the implementation:
+ *
+ * buddy -- mplite (power-of-two blocks) with a slab allocator in front
+ *          for small blocks.  The default.
+ * tlsf  -- two level segregated fit.  O(1) allocate and free, blocks
+ *          are 8 byte granular and can grow into a free neighbor.
+ */
+namespace MM {
+
+	class Allocator
+	{
+	public:
+		// relocatable blocks, sorted by address.
+		typedef std::vector<uint32_t> Movable;
+		typedef std::function<void(uint32_t from, uint32_t to)> Moved;
+
+		virtual ~Allocator() = default;
+
+		virtual const char *Name() const = 0;
+
+		// heap is [base, base + size) in emulated memory.
+		virtual bool Init(uint8_t *memory, uint32_t base, uint32_t size) = 0;
+
+		virtual uint32_t Allocate(uint32_t size) = 0;
+		virtual void Free(uint32_t address) = 0;
+
+		// grow or shrink without moving.
+		virtual bool Resize(uint32_t address, uint32_t size) = 0;
+
+		// may move (and copy) the block.  On failure, 0 is returned and the
+		// old block is untouched.
+		virtual uint32_t Reallocate(uint32_t address, uint32_t size);
+
+		// bytes actually set aside for the block.
+		virtual uint32_t BlockSize(uint32_t address) const = 0;
+
+		virtual uint32_t FreeBytes() const = 0;
+
+		// the largest block Allocate can return.
+		virtual uint32_t MaxBlock() const = 0;
+
+		// like Allocate, but as high in the heap as it can manage (MoveHHi).
+		virtual uint32_t AllocateHigh(uint32_t size) { return Allocate(size); }
+
+		// moves movable blocks (and their contents) to make larger free
+		// blocks.  moved is called for each block that moves; a block moves
+		// at most once.
+		virtual void Compact(const Movable &movable, const Moved &moved);
+
+		// MaxBlock after Compact, if it can tell.
+		virtual uint32_t CompactedMaxBlock(const Movable &movable) const { return MaxBlock(); }
+
+		// fragmentation statistics for the allocated blocks.
+		virtual void PrintStats(const BlockIndex &blocks) const;
+
+		// --snapshot / --restore.  LoadState takes the place of Init -- the
+		// heap is already in memory.
+		virtual void SaveState(FILE *f) const = 0;
+		virtual void LoadState(uint8_t *memory, FILE *f) = 0;
+
+	protected:
+		uint8_t *_memory = nullptr;
+	};
+
+
+	// nullptr if there's no such allocator.
+	std::unique_ptr<Allocator> CreateAllocator(const std::string &name);
+
+
+	/*
+	 * --alloc-trace
+	 *
+	 * Passes everything on to another allocator and logs it, one line per
+	 * call, for alloc_bench to replay:
+	 *
+	 * # mpw allocation trace <allocator> <base> <size>
+	 * a <size> <result>
+	 * f <address>
+	 * r <address> <size> <0|1>
+	 * m <address> <size> <result>
+	 * h <size> <result>
+	 * c
+	 * v <from> <to>
+	 *
+	 * (allocate, free, resize, reallocate, allocate high, compact and a
+	 * block compact moved).  Numbers are hex.
+	 */
+	class TraceAllocator : public Allocator
+	{
+	public:
+		// takes ownership of file.
+		TraceAllocator(std::unique_ptr<Allocator> allocator, FILE *file);
+		~TraceAllocator();
+
+		const char *Name() const override { return _allocator->Name(); }
+		bool Init(uint8_t *memory, uint32_t base, uint32_t size) override;
+
+		uint32_t Allocate(uint32_t size) override;
+		void Free(uint32_t address) override;
+		bool Resize(uint32_t address, uint32_t size) override;
+		uint32_t Reallocate(uint32_t address, uint32_t size) override;
+
+		uint32_t BlockSize(uint32_t address) const override { return _allocator->BlockSize(address); }
+		uint32_t FreeBytes() const override { return _allocator->FreeBytes(); }
+		uint32_t MaxBlock() const override { return _allocator->MaxBlock(); }
+		uint32_t AllocateHigh(uint32_t size) override;
+		void Compact(const Movable &movable, const Moved &moved) override;
+		uint32_t CompactedMaxBlock(const Movable &movable) const override { return _allocator->CompactedMaxBlock(movable); }
+		void PrintStats(const BlockIndex &blocks) const override { _allocator->PrintStats(blocks); }
+
+		void SaveState(FILE *f) const override { _allocator->SaveState(f); }
+		void LoadState(uint8_t *memory, FILE *f) override;
+
+	private:
+		std::unique_ptr<Allocator> _allocator;
+		FILE *_file;
+	};
+
+}
+
+#endif
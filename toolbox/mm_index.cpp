@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#include "mm_index.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace MM {
+
+	// BlockIndex
+
+	std::vector<BlockIndex::Block>::iterator BlockIndex::find(uint32_t address)
+	{
+		return std::lower_bound(_blocks.begin(), _blocks.end(), address,
+			[](const Block &b, uint32_t a) { return b.address < a; });
+	}
+
+	void BlockIndex::Insert(uint32_t address, uint32_t size, uint32_t handle)
+	{
+		auto iter = find(address);
+		if (iter != _blocks.end() && iter->address == address)
+		{
+			*iter = Block{address, size, handle};
+			return;
+		}
+		_blocks.insert(iter, Block{address, size, handle});
+	}
+
+	void BlockIndex::Erase(uint32_t address)
+	{
+		auto iter = find(address);
+		if (iter != _blocks.end() && iter->address == address)
+			_blocks.erase(iter);
+	}
+
+	void BlockIndex::Resize(uint32_t address, uint32_t size)
+	{
+		auto iter = find(address);
+		if (iter != _blocks.end() && iter->address == address)
+			iter->size = size;
+	}
+
+	const BlockIndex::Block *BlockIndex::Find(uint32_t address) const
+	{
+		auto iter = const_cast<BlockIndex *>(this)->find(address);
+		if (iter != _blocks.end() && iter->address == address) return &*iter;
+		return nullptr;
+	}
+
+	const BlockIndex::Block *BlockIndex::Lookup(uint32_t address) const
+	{
+		// the last block starting at or before address.
+		auto iter = std::upper_bound(_blocks.begin(), _blocks.end(), address,
+			[](uint32_t a, const Block &b) { return a < b.address; });
+
+		if (iter == _blocks.begin()) return nullptr;
+		--iter;
+		if (address < iter->end()) return &*iter;
+		return nullptr;
+	}
+
+	void BlockIndex::Assign(std::vector<Block> blocks)
+	{
+		_blocks = std::move(blocks);
+		std::sort(_blocks.begin(), _blocks.end(),
+			[](const Block &a, const Block &b) { return a.address < b.address; });
+	}
+
+
+	// HandleTable
+
+	void HandleTable::iterator::skip()
+	{
+		auto &blocks = _table->_blocks;
+		while (_block < blocks.size())
+		{
+			const auto &used = blocks[_block].used;
+			while (_slot < used.size() && !used[_slot]) ++_slot;
+			if (_slot < used.size()) return;
+			++_block;
+			_slot = 0;
+		}
+		_slot = 0;
+	}
+
+	void HandleTable::AddBlock(uint32_t address, uint32_t count)
+	{
+		auto iter = std::lower_bound(_blocks.begin(), _blocks.end(), address,
+			[](const Block &b, uint32_t a) { return b.address < a; });
+
+		Block block;
+		block.address = address;
+		block.slots.reserve(count);
+		for (uint32_t i = 0; i < count; ++i)
+			block.slots.emplace_back(address + i * 4, HandleInfo());
+		block.used.resize(count, false);
+
+		_blocks.insert(iter, std::move(block));
+	}
+
+	bool HandleTable::locate(uint32_t handle, size_t &block, size_t &slot) const
+	{
+		if (handle & 0x03) return false;
+
+		// the last master pointer block starting at or before handle.
+		auto iter = std::upper_bound(_blocks.begin(), _blocks.end(), handle,
+			[](uint32_t h, const Block &b) { return h < b.address; });
+		if (iter == _blocks.begin()) return false;
+		--iter;
+
+		size_t index = (handle - iter->address) >> 2;
+		if (index >= iter->slots.size()) return false;
+
+		block = iter - _blocks.begin();
+		slot = index;
+		return true;
+	}
+
+	HandleTable::iterator HandleTable::find(uint32_t handle)
+	{
+		size_t block, slot;
+		if (!locate(handle, block, slot) || !_blocks[block].used[slot]) return end();
+		return iterator(this, block, slot);
+	}
+
+	HandleTable::iterator HandleTable::begin()
+	{
+		iterator iter(this, 0, 0);
+		iter.skip();
+		return iter;
+	}
+
+	std::pair<HandleTable::iterator, bool> HandleTable::emplace(const value_type &value)
+	{
+		size_t block, slot;
+		if (!locate(value.first, block, slot))
+		{
+			assert(!"handle is not in a master pointer block");
+			return std::make_pair(end(), false);
+		}
+
+		iterator iter(this, block, slot);
+		if (_blocks[block].used[slot]) return std::make_pair(iter, false);
+
+		_blocks[block].used[slot] = true;
+		_blocks[block].slots[slot].second = value.second;
+		++_size;
+		return std::make_pair(iter, true);
+	}
+
+	void HandleTable::erase(iterator iter)
+	{
+		auto &block = _blocks[iter._block];
+		if (!block.used[iter._slot]) return;
+
+		block.used[iter._slot] = false;
+		block.slots[iter._slot].second = HandleInfo();
+		--_size;
+	}
+
+	std::vector<HandleTable::MasterBlock> HandleTable::MasterBlocks() const
+	{
+		std::vector<MasterBlock> rv;
+		rv.reserve(_blocks.size());
+		for (const auto &b : _blocks)
+			rv.push_back(MasterBlock{b.address, (uint32_t)b.slots.size()});
+		return rv;
+	}
+
+}
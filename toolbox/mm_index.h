@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef __mpw_mm_index_h__
+#define __mpw_mm_index_h__
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "mm.h"
+
+/*
+ * Memory Manager bookkeeping.
+ *
+ * BlockIndex has every allocated block -- pointers and the blocks
+ * handles point to -- sorted by address in a flat vector, so "which
+ * block contains this address" (RecoverHandle, MemoryInfo) is a binary
+ * search.
+ *
+ * HandleTable maps handles (master pointer addresses) to HandleInfo.
+ * Master pointers are allocated in blocks, so the table is a sorted
+ * vector of master pointer blocks, each with a slot per master pointer.
+ * It has the parts of the std::map interface the Memory Manager uses.
+ */
+namespace MM {
+
+	class BlockIndex
+	{
+	public:
+
+		struct Block
+		{
+			uint32_t address;
+			uint32_t size;
+			uint32_t handle; // 0 for a pointer.
+
+			// an empty block still owns its address.
+			uint32_t end() const { return address + (size ? size : 1); }
+		};
+
+		typedef std::vector<Block>::const_iterator const_iterator;
+
+		void Insert(uint32_t address, uint32_t size, uint32_t handle = 0);
+		void Erase(uint32_t address);
+		void Resize(uint32_t address, uint32_t size);
+
+		// the block starting at address.
+		const Block *Find(uint32_t address) const;
+
+		// the block containing address.
+		const Block *Lookup(uint32_t address) const;
+
+		const_iterator begin() const { return _blocks.begin(); }
+		const_iterator end() const { return _blocks.end(); }
+		size_t size() const { return _blocks.size(); }
+		void clear() { _blocks.clear(); }
+
+		// --snapshot / --restore.
+		const std::vector<Block> &Blocks() const { return _blocks; }
+		void Assign(std::vector<Block> blocks);
+
+	private:
+		std::vector<Block>::iterator find(uint32_t address);
+
+		std::vector<Block> _blocks;
+	};
+
+
+	class HandleTable
+	{
+	public:
+
+		typedef uint32_t key_type;
+		typedef HandleInfo mapped_type;
+		typedef std::pair<uint32_t, HandleInfo> value_type;
+
+		class iterator
+		{
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef HandleTable::value_type value_type;
+			typedef ptrdiff_t difference_type;
+			typedef value_type *pointer;
+			typedef value_type &reference;
+
+			iterator() = default;
+
+			value_type &operator*() const { return _table->_blocks[_block].slots[_slot]; }
+			value_type *operator->() const { return &**this; }
+
+			iterator &operator++()
+			{
+				++_slot;
+				skip();
+				return *this;
+			}
+
+			bool operator==(const iterator &rhs) const { return _block == rhs._block && _slot == rhs._slot; }
+			bool operator!=(const iterator &rhs) const { return !(*this == rhs); }
+
+		private:
+			friend class HandleTable;
+
+			iterator(HandleTable *table, size_t block, size_t slot) :
+				_table(table), _block(block), _slot(slot)
+			{}
+
+			// move to the next used slot (or the end).
+			void skip();
+
+			HandleTable *_table = nullptr;
+			size_t _block = 0;
+			size_t _slot = 0;
+		};
+
+		struct MasterBlock
+		{
+			uint32_t address;
+			uint32_t count;
+		};
+
+		// master pointers [address, address + count * 4) are handles.
+		void AddBlock(uint32_t address, uint32_t count);
+
+		iterator find(uint32_t handle);
+		iterator begin();
+		iterator end() { return iterator(this, _blocks.size(), 0); }
+
+		// the handle must be in a master pointer block.
+		std::pair<iterator, bool> emplace(const value_type &value);
+		std::pair<iterator, bool> emplace(uint32_t handle, const HandleInfo &info)
+		{
+			return emplace(value_type(handle, info));
+		}
+
+		void erase(iterator iter);
+
+		size_t size() const { return _size; }
+		void clear() { _blocks.clear(); _size = 0; }
+
+		// --snapshot / --restore.
+		std::vector<MasterBlock> MasterBlocks() const;
+
+	private:
+
+		struct Block
+		{
+			uint32_t address;
+			std::vector<value_type> slots;
+			std::vector<bool> used;
+		};
+
+		bool locate(uint32_t handle, size_t &block, size_t &slot) const;
+
+		std::vector<Block> _blocks;
+		size_t _size = 0;
+	};
+
+}
+
+#endif
@@ -0,0 +1,457 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+#include "mm_slab.h"
+#include "state.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <set>
+
+namespace MM {
+
+	namespace {
+
+		// roughly 1.5x apart -- at most a third of a block is slack.
+		constexpr uint32_t kSizes[] = {
+			8, 16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512
+		};
+
+		constexpr unsigned kClasses = sizeof(kSizes) / sizeof(kSizes[0]);
+
+		static_assert(kSizes[kClasses - 1] == SlabHeap::kMaxSlabBlock, "Bad size classes");
+
+
+		// mplite's free blocks, by size, in szAtom units.  Allocating and
+		// freeing follow mplite's rules (split low, merge buddies), so a
+		// compaction can be planned without touching the heap.
+		class BuddyMap
+		{
+		public:
+			BuddyMap(const mplite_t &pool) : _pool(&pool), _nBlock(pool.nBlock), _free(MPLITE_LOGMAX + 1)
+			{
+				mplite_walk(&pool, [](void *context, const void *p, int size, int free) {
+					if (!free) return;
+
+					auto self = (BuddyMap *)context;
+					const mplite_t *pool = self->_pool;
+					self->_free[log2(size / pool->szAtom)].insert(((const uint8_t *)p - pool->zPool) / pool->szAtom);
+				}, this);
+			}
+
+			static int log2(int n)
+			{
+				int log = 0;
+				while ((1 << log) < n) ++log;
+				return log;
+			}
+
+			// the lowest free block below limit that holds 1 << log units.
+			bool lowest(int log, int limit, int &block, int &bin) const
+			{
+				block = limit;
+				bin = log;
+				for (int i = log; i <= MPLITE_LOGMAX; ++i)
+				{
+					if (!_free[i].empty() && *_free[i].begin() < block)
+					{
+						block = *_free[i].begin();
+						bin = i;
+					}
+				}
+				return block < limit;
+			}
+
+			void take(int block, int bin, int log)
+			{
+				_free[bin].erase(block);
+				while (bin > log)
+				{
+					--bin;
+					_free[bin].insert(block + (1 << bin));
+				}
+			}
+
+			void release(int block, int log)
+			{
+				while (log < MPLITE_LOGMAX)
+				{
+					int size = 1 << log;
+					int buddy = (block >> log) & 1 ? block - size : block + size;
+					if (buddy >= _nBlock || !_free[log].erase(buddy)) break;
+
+					block = std::min(block, buddy);
+					++log;
+				}
+				_free[log].insert(block);
+			}
+
+			int maxLog() const
+			{
+				for (int i = MPLITE_LOGMAX; i >= 0; --i)
+					if (!_free[i].empty()) return i;
+				return -1;
+			}
+
+		private:
+			const mplite_t *_pool;
+			int _nBlock;
+			std::vector<std::set<int>> _free;
+		};
+	}
+
+
+	int SlabHeap::sizeClass(uint32_t size)
+	{
+		if (size > kMaxSlabBlock) return -1;
+		return std::lower_bound(kSizes, kSizes + kClasses, size) - kSizes;
+	}
+
+	SlabHeap::Slab *SlabHeap::slab(uint32_t address)
+	{
+		if (_slabs.empty()) return nullptr;
+
+		auto iter = _slabs.find(address & ~(kSlabSize - 1));
+		return iter == _slabs.end() ? nullptr : &iter->second;
+	}
+
+	const SlabHeap::Slab *SlabHeap::slab(uint32_t address) const
+	{
+		return const_cast<SlabHeap *>(this)->slab(address);
+	}
+
+
+	void SlabHeap::reset()
+	{
+		_slabs.clear();
+		_available.assign(kClasses, std::vector<uint32_t>());
+		_slabCount.assign(kClasses, 0);
+		_freeSlotBytes = 0;
+	}
+
+	bool SlabHeap::Init(uint8_t *memory, uint32_t base, uint32_t size)
+	{
+		_memory = memory;
+		reset();
+
+		return mplite_init(&_pool, memory + base, size, 32, NULL) == MPLITE_OK;
+	}
+
+
+	uint32_t SlabHeap::allocateSlot(unsigned sc)
+	{
+		const uint32_t size = kSizes[sc];
+		auto &list = _available[sc];
+
+		while (!list.empty())
+		{
+			const Slab *s = slab(list.back());
+			if (s && s->sizeClass == sc && !s->free.empty()) break;
+			list.pop_back();
+		}
+
+		if (list.empty())
+		{
+			uint8_t *ptr = (uint8_t *)mplite_malloc(&_pool, kSlabSize);
+			if (!ptr) return 0;
+
+			uint32_t address = ptr - _memory;
+
+			// the heap (and therefore every buddy block) should be page
+			// aligned, but don't count on it.
+			if (address & (kSlabSize - 1))
+			{
+				mplite_free(&_pool, ptr);
+				return 0;
+			}
+
+			Slab s = { address, sc, 0, {} };
+			uint32_t count = kSlabSize / size;
+
+			// hand out the low addresses first.
+			s.free.reserve(count);
+			for (uint32_t i = count; i--; ) s.free.push_back(i);
+
+			_slabs.emplace(address, std::move(s));
+			_slabCount[sc]++;
+			_freeSlotBytes += count * size;
+			list.push_back(address);
+		}
+
+		Slab *s = slab(list.back());
+
+		uint32_t i = s->free.back();
+		s->free.pop_back();
+		s->used++;
+		_freeSlotBytes -= size;
+
+		if (s->free.empty()) list.pop_back();
+
+		return s->address + i * size;
+	}
+
+
+	uint32_t SlabHeap::Allocate(uint32_t size)
+	{
+		if (!size) size = 1;
+
+		int sc = sizeClass(size);
+		if (sc >= 0)
+		{
+			uint32_t address = allocateSlot(sc);
+			if (address) return address;
+			// no room for a new slab -- a smaller buddy block may still fit.
+		}
+
+		uint8_t *ptr = (uint8_t *)mplite_malloc(&_pool, size);
+		return ptr ? ptr - _memory : 0;
+	}
+
+
+	void SlabHeap::Free(uint32_t address)
+	{
+		Slab *s = slab(address);
+		if (!s)
+		{
+			mplite_free(&_pool, _memory + address);
+			return;
+		}
+
+		const unsigned sc = s->sizeClass;
+		const uint32_t size = kSizes[sc];
+		const bool full = s->free.empty();
+
+		s->free.push_back((address - s->address) / size);
+		s->used--;
+		_freeSlotBytes += size;
+
+		// keep one slab per class around so a single block doesn't
+		// bounce a slab in and out of mplite.
+		if (!s->used && _slabCount[sc] > 1)
+		{
+			uint32_t base = s->address;
+
+			_freeSlotBytes -= s->free.size() * size;
+			_slabCount[sc]--;
+			_slabs.erase(base);
+			mplite_free(&_pool, _memory + base);
+			return;
+		}
+
+		if (full) _available[sc].push_back(s->address);
+	}
+
+
+	bool SlabHeap::Resize(uint32_t address, uint32_t size)
+	{
+		if (!size) size = 1;
+
+		if (const Slab *s = slab(address))
+			return size <= kSizes[s->sizeClass];
+
+		int n = mplite_roundup(&_pool, size);
+		return n && mplite_resize(&_pool, _memory + address, n) == MPLITE_OK;
+	}
+
+
+	uint32_t SlabHeap::BlockSize(uint32_t address) const
+	{
+		if (const Slab *s = slab(address))
+			return kSizes[s->sizeClass];
+
+		return mplite_blocksize(&_pool, _memory + address);
+	}
+
+
+	uint32_t SlabHeap::FreeBytes() const
+	{
+		return mplite_freemem(&_pool) + _freeSlotBytes;
+	}
+
+	uint32_t SlabHeap::MaxBlock() const
+	{
+		return mplite_maxmem(&_pool);
+	}
+
+	// lowest first, each block moves to the lowest free block below it
+	// that's large enough (if any).  Freeing it merges its buddies, so
+	// the free space collects at the top.  Slab slots stay put.
+	uint32_t SlabHeap::compact(const Movable &movable, const Moved *moved) const
+	{
+		BuddyMap map(_pool);
+
+		const int atom = _pool.szAtom;
+
+		for (uint32_t address : movable)
+		{
+			if (slab(address)) continue;
+
+			const uint8_t *p = _memory + address;
+			int size = mplite_blocksize(&_pool, p);
+			int log = BuddyMap::log2(size / atom);
+			int block = (p - _pool.zPool) / atom;
+			int to, bin;
+
+			if (!map.lowest(log, block, to, bin)) continue;
+
+			map.take(to, bin, log);
+			map.release(block, log);
+
+			if (!moved) continue;
+
+			uint8_t *q = (uint8_t *)mplite_malloc_at(&_pool, _pool.zPool + to * atom, size);
+			std::memcpy(q, p, size);
+			mplite_free(&_pool, p);
+
+			(*moved)(address, q - _memory);
+		}
+
+		int log = map.maxLog();
+		return log < 0 ? 0 : atom << log;
+	}
+
+	void SlabHeap::Compact(const Movable &movable, const Moved &moved)
+	{
+		compact(movable, &moved);
+	}
+
+	uint32_t SlabHeap::CompactedMaxBlock(const Movable &movable) const
+	{
+		return compact(movable, nullptr);
+	}
+
+
+	void SlabHeap::PrintStats(const BlockIndex &blocks) const
+	{
+		struct Totals
+		{
+			uint32_t count = 0;
+			uint32_t requested = 0;
+			uint32_t allocated = 0;
+		};
+
+		std::vector<uint32_t> slabs(kClasses);
+		std::vector<Totals> classes(kClasses);
+		Totals large;
+
+		for (const auto &kv : _slabs)
+			slabs[kv.second.sizeClass]++;
+
+		for (const auto &b : blocks)
+		{
+			const Slab *s = slab(b.address);
+			Totals &t = s ? classes[s->sizeClass] : large;
+
+			t.count++;
+			t.requested += b.size;
+			t.allocated += BlockSize(b.address);
+		}
+
+		auto percent = [](const Totals &t) {
+			return t.allocated ? 100.0 * (t.allocated - t.requested) / t.allocated : 0.0;
+		};
+
+		mplite_print_stats(&_pool, std::puts);
+
+		fprintf(stdout, "Size  Slabs  Blocks  Slots  Requested  Allocated  Frag\n");
+		for (unsigned i = 0; i < kClasses; ++i)
+		{
+			if (!slabs[i]) continue;
+
+			const Totals &c = classes[i];
+			fprintf(stdout, "%4u  %5u  %6u  %5u  %9u  %9u  %4.1f%%\n",
+				kSizes[i], slabs[i], c.count, slabs[i] * (kSlabSize / kSizes[i]),
+				c.requested, c.allocated, percent(c));
+		}
+
+		fprintf(stdout, "mplite blocks:  %u requested: %u allocated: %u (%.1f%% internal fragmentation)\n",
+			large.count, large.requested, large.allocated, percent(large));
+		fprintf(stdout, "Free slab slots: %u bytes in %u slabs\n",
+			_freeSlotBytes, (unsigned)_slabs.size());
+
+		Allocator::PrintStats(blocks);
+	}
+
+
+	// the pool's pointers are into emulated memory, which may be mapped
+	// somewhere else next time, so they're saved as offsets.
+	void SlabHeap::SaveState(FILE *f) const
+	{
+		mplite_t pool = _pool;
+
+		State::Write(f, (uint32_t)(pool.zPool - _memory));
+		State::Write(f, (uint32_t)(pool.aCtrl - _memory));
+		pool.zPool = pool.aCtrl = nullptr;
+		State::Write(f, pool);
+
+		State::Write(f, (uint32_t)_slabs.size());
+		for (const auto &kv : _slabs)
+		{
+			const Slab &s = kv.second;
+			State::Write(f, s.address);
+			State::Write(f, s.sizeClass);
+			State::Write(f, s.used);
+			State::Write(f, s.free);
+		}
+	}
+
+	void SlabHeap::LoadState(uint8_t *memory, FILE *f)
+	{
+		uint32_t zPool = 0;
+		uint32_t aCtrl = 0;
+		uint32_t count = 0;
+
+		_memory = memory;
+
+		State::Read(f, zPool);
+		State::Read(f, aCtrl);
+		State::Read(f, _pool);
+		_pool.zPool = _memory + zPool;
+		_pool.aCtrl = _memory + aCtrl;
+
+		reset();
+
+		State::Read(f, count);
+		while (count-- && !feof(f))
+		{
+			Slab s = { 0, 0, 0, {} };
+			State::Read(f, s.address);
+			State::Read(f, s.sizeClass);
+			State::Read(f, s.used);
+			State::Read(f, s.free);
+			if (s.sizeClass >= kClasses) continue;
+
+			_slabCount[s.sizeClass]++;
+			_freeSlotBytes += s.free.size() * kSizes[s.sizeClass];
+			if (!s.free.empty()) _available[s.sizeClass].push_back(s.address);
+			_slabs.emplace(s.address, std::move(s));
+		}
+	}
+
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+#ifndef __mpw_mm_slab_h__
+#define __mpw_mm_slab_h__
+
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <vector>
+
+#include <mplite/mplite.h>
+
+#include "mm_allocator.h"
+
+/*
+ * --allocator=buddy
+ *
+ * mplite is a buddy allocator, so a 40 byte symbol table node costs 64
+ * bytes and a 300 byte one costs 512.  SlabHeap sits in front of it:
+ * requests up to kMaxSlabBlock are rounded to a size class and carved
+ * out of 4K slabs (which come from mplite), everything else goes
+ * straight to mplite.
+ *
+ * The slab bookkeeping lives on the host side, so a freed slot isn't
+ * touched and a slab's memory is all block.  Slabs are kSlabSize
+ * aligned, so the slab an address belongs to is address & ~(kSlabSize - 1).
+ */
+namespace MM {
+
+	class SlabHeap : public Allocator
+	{
+	public:
+
+		static const uint32_t kSlabSize = 4096;
+		static const uint32_t kMaxSlabBlock = 512;
+
+		const char *Name() const override { return "buddy"; }
+		bool Init(uint8_t *memory, uint32_t base, uint32_t size) override;
+
+		uint32_t Allocate(uint32_t size) override;
+		void Free(uint32_t address) override;
+		bool Resize(uint32_t address, uint32_t size) override;
+
+		uint32_t BlockSize(uint32_t address) const override;
+
+		// free mplite memory plus free slab slots.
+		uint32_t FreeBytes() const override;
+		uint32_t MaxBlock() const override;
+
+		void Compact(const Movable &movable, const Moved &moved) override;
+		uint32_t CompactedMaxBlock(const Movable &movable) const override;
+
+		void PrintStats(const BlockIndex &blocks) const override;
+
+		void SaveState(FILE *f) const override;
+		void LoadState(uint8_t *memory, FILE *f) override;
+
+	private:
+
+		struct Slab
+		{
+			uint32_t address;
+			uint32_t sizeClass;
+			uint32_t used;
+			std::vector<uint16_t> free; // free slot numbers
+		};
+
+		static int sizeClass(uint32_t size);
+
+		void reset();
+		// plans (and, with moved, does) a compaction.  Returns the
+		// MaxBlock after.
+		uint32_t compact(const Movable &movable, const Moved *moved) const;
+		uint32_t allocateSlot(unsigned sizeClass);
+		Slab *slab(uint32_t address);
+		const Slab *slab(uint32_t address) const;
+
+		// mplite_t isn't const-correct.
+		mutable mplite_t _pool = {};
+
+		std::unordered_map<uint32_t, Slab> _slabs;
+
+		// per size class -- slabs that (may) have a free slot.  Stale
+		// entries are dropped when they're found.
+		std::vector<std::vector<uint32_t>> _available;
+		std::vector<uint32_t> _slabCount;
+
+		uint32_t _freeSlotBytes = 0;
+	};
+
+}
+
+#endif
@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+#include "mm_tlsf.h"
+#include "state.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace MM {
+
+	namespace {
+
+		inline unsigned fls(uint32_t x) { return 31 - __builtin_clz(x); }
+		inline unsigned ffs(uint32_t x) { return __builtin_ctz(x); }
+	}
+
+
+	void TlsfHeap::mapping(uint32_t size, unsigned &fl, unsigned &sl)
+	{
+		if (size < kSmallBlock)
+		{
+			fl = 0;
+			sl = size / (kSmallBlock / kSLCount);
+			return;
+		}
+
+		unsigned f = fls(size);
+		sl = (size >> (f - kSLShift)) ^ kSLCount;
+		fl = f - kFLShift + 1;
+	}
+
+	// 0 if it's too large.
+	uint32_t TlsfHeap::adjust(uint32_t size)
+	{
+		if (size > UINT32_C(0xffff0000)) return 0;
+
+		size = (size + kAlign - 1) & ~(kAlign - 1);
+		return std::max(size, kMinBlock);
+	}
+
+
+	void TlsfHeap::setFree(uint32_t block, bool free)
+	{
+		uint32_t next = nextPhys(block);
+
+		if (free)
+		{
+			sizeWord(block) |= kFree;
+			sizeWord(next) |= kPrevFree;
+		}
+		else
+		{
+			sizeWord(block) &= ~kFree;
+			sizeWord(next) &= ~kPrevFree;
+		}
+		prevPhys(next) = block;
+	}
+
+
+	void TlsfHeap::insert(uint32_t block)
+	{
+		unsigned fl, sl;
+		mapping(size(block), fl, sl);
+
+		uint32_t head = _heads[fl][sl];
+		nextFree(block) = head;
+		prevFree(block) = 0;
+		if (head) prevFree(head) = block;
+
+		_heads[fl][sl] = block;
+		_flBitmap |= 1u << fl;
+		_slBitmap[fl] |= 1u << sl;
+		_freeBytes += size(block);
+	}
+
+	void TlsfHeap::remove(uint32_t block)
+	{
+		unsigned fl, sl;
+		mapping(size(block), fl, sl);
+
+		uint32_t next = nextFree(block);
+		uint32_t prev = prevFree(block);
+
+		if (next) prevFree(next) = prev;
+		if (prev) nextFree(prev) = next;
+		else
+		{
+			_heads[fl][sl] = next;
+			if (!next)
+			{
+				_slBitmap[fl] &= ~(1u << sl);
+				if (!_slBitmap[fl]) _flBitmap &= ~(1u << fl);
+			}
+		}
+		_freeBytes -= size(block);
+	}
+
+
+	// a free block of at least size bytes, or 0.
+	uint32_t TlsfHeap::find(uint32_t size)
+	{
+		unsigned fl, sl;
+
+		// round up to the next list, so any block in it will do.
+		uint32_t rounded = size;
+		if (size >= kSmallBlock) rounded += (1u << (fls(size) - kSLShift)) - 1;
+
+		if (rounded >= size)
+		{
+			mapping(rounded, fl, sl);
+
+			uint32_t slMap = _slBitmap[fl] & (~0u << sl);
+			if (!slMap && fl + 1 < kFLCount)
+			{
+				uint32_t flMap = _flBitmap & (~0u << (fl + 1));
+				if (flMap)
+				{
+					fl = ffs(flMap);
+					slMap = _slBitmap[fl];
+				}
+			}
+			if (slMap) return _heads[fl][ffs(slMap)];
+		}
+
+		// nearly full -- a block in size's own list may still be large
+		// enough.
+		mapping(size, fl, sl);
+		for (uint32_t block = _heads[fl][sl]; block; block = nextFree(block))
+			if (this->size(block) >= size) return block;
+
+		return 0;
+	}
+
+
+	// trims an allocated block to size, freeing the rest.
+	void TlsfHeap::split(uint32_t block, uint32_t size)
+	{
+		uint32_t current = this->size(block);
+		if (current < size + kHeaderSize + kMinBlock) return;
+
+		setSize(block, size);
+
+		uint32_t rest = nextPhys(block);
+		prevPhys(rest) = block;
+		sizeWord(rest) = current - size - kHeaderSize;
+		setFree(rest, true);
+
+		insert(merge(rest));
+	}
+
+	// merges a free block (which isn't in a list) with its free neighbors.
+	uint32_t TlsfHeap::merge(uint32_t block)
+	{
+		if (isPrevFree(block))
+		{
+			uint32_t prev = prevPhys(block);
+			remove(prev);
+			setSize(prev, size(prev) + kHeaderSize + size(block));
+			block = prev;
+		}
+
+		uint32_t next = nextPhys(block);
+		if (isFree(next))
+		{
+			remove(next);
+			setSize(block, size(block) + kHeaderSize + size(next));
+		}
+
+		setFree(block, true);
+		return block;
+	}
+
+
+	bool TlsfHeap::Init(uint8_t *memory, uint32_t base, uint32_t size)
+	{
+		_memory = memory;
+
+		uint32_t start = (base + kAlign - 1) & ~(kAlign - 1);
+		uint32_t end = (base + size) & ~(kAlign - 1);
+		if (end < start || end - start < 2 * kHeaderSize + kMinBlock) return false;
+
+		_freeBytes = 0;
+		_flBitmap = 0;
+		std::fill(std::begin(_slBitmap), std::end(_slBitmap), 0);
+		std::fill(&_heads[0][0], &_heads[0][0] + kFLCount * kSLCount, 0);
+
+		uint32_t sentinel = end - kHeaderSize;
+
+		_firstBlock = start;
+		prevPhys(start) = 0;
+		sizeWord(start) = sentinel - start - kHeaderSize;
+		sizeWord(sentinel) = 0;
+		setFree(start, true);
+
+		insert(start);
+		return true;
+	}
+
+
+	uint32_t TlsfHeap::Allocate(uint32_t size)
+	{
+		size = adjust(size);
+		if (!size) return 0;
+
+		uint32_t block = find(size);
+		if (!block) return 0;
+
+		remove(block);
+		setFree(block, false);
+		split(block, size);
+
+		return block + kHeaderSize;
+	}
+
+
+	void TlsfHeap::Free(uint32_t address)
+	{
+		uint32_t block = address - kHeaderSize;
+
+		setFree(block, true);
+		insert(merge(block));
+	}
+
+
+	bool TlsfHeap::Resize(uint32_t address, uint32_t size)
+	{
+		uint32_t block = address - kHeaderSize;
+
+		size = adjust(size);
+		if (!size) return false;
+
+		uint32_t current = this->size(block);
+		if (size > current)
+		{
+			// grow into the next block.
+			uint32_t next = nextPhys(block);
+			if (!isFree(next) || current + kHeaderSize + this->size(next) < size)
+				return false;
+
+			remove(next);
+			setSize(block, current + kHeaderSize + this->size(next));
+			setFree(block, false);
+		}
+
+		split(block, size);
+		return true;
+	}
+
+
+	uint32_t TlsfHeap::BlockSize(uint32_t address) const
+	{
+		return size(address - kHeaderSize);
+	}
+
+
+	uint32_t TlsfHeap::MaxBlock() const
+	{
+		if (!_flBitmap) return 0;
+
+		unsigned fl = fls(_flBitmap);
+		unsigned sl = fls(_slBitmap[fl]);
+
+		uint32_t largest = 0;
+		for (uint32_t block = _heads[fl][sl]; block; block = nextFree(block))
+			largest = std::max(largest, size(block));
+
+		return largest;
+	}
+
+
+	uint32_t TlsfHeap::AllocateHigh(uint32_t size)
+	{
+		size = adjust(size);
+		if (!size) return 0;
+
+		// the highest free block that's large enough.
+		uint32_t block = 0;
+		for (unsigned fl = 0; fl < kFLCount; ++fl)
+		{
+			if (!(_flBitmap & (1u << fl))) continue;
+			for (unsigned sl = 0; sl < kSLCount; ++sl)
+			{
+				for (uint32_t b = _heads[fl][sl]; b; b = nextFree(b))
+					if (b > block && this->size(b) >= size) block = b;
+			}
+		}
+		if (!block) return 0;
+
+		remove(block);
+
+		uint32_t current = this->size(block);
+		if (current < size + kHeaderSize + kMinBlock)
+		{
+			setFree(block, false);
+			return block + kHeaderSize;
+		}
+
+		// take the top of it.
+		setSize(block, current - size - kHeaderSize);
+		insert(block);
+
+		uint32_t high = nextPhys(block);
+		prevPhys(high) = block;
+		sizeWord(high) = size | kPrevFree;
+		setFree(high, false);
+
+		return high + kHeaderSize;
+	}
+
+
+	void TlsfHeap::Compact(const Movable &movable, const Moved &moved)
+	{
+		auto isMovable = [&](uint32_t block) {
+			return std::binary_search(movable.begin(), movable.end(), block + kHeaderSize);
+		};
+
+		for (uint32_t block = _firstBlock; size(block); block = nextPhys(block))
+		{
+			if (isFree(block) || !isPrevFree(block) || !isMovable(block)) continue;
+
+			// [free][block] -> [block][free]
+			uint32_t to = prevPhys(block);
+			uint32_t size = this->size(block);
+			uint32_t gap = this->size(to);
+
+			remove(to);
+			std::memmove(_memory + to + kHeaderSize, _memory + block + kHeaderSize, size);
+
+			// the block before a free block isn't free.
+			sizeWord(to) = size;
+
+			uint32_t rest = nextPhys(to);
+			prevPhys(rest) = to;
+			sizeWord(rest) = gap;
+			setFree(rest, true);
+			rest = merge(rest);
+			insert(rest);
+
+			moved(block + kHeaderSize, to + kHeaderSize);
+			block = rest;
+		}
+	}
+
+
+	// after Compact, the free blocks between two blocks that can't move
+	// are one block.
+	uint32_t TlsfHeap::CompactedMaxBlock(const Movable &movable) const
+	{
+		uint32_t largest = 0;
+		uint32_t run = 0;
+
+		for (uint32_t block = _firstBlock; ; block = nextPhys(block))
+		{
+			uint32_t size = this->size(block);
+
+			if (isFree(block))
+				run += kHeaderSize + size;
+			else if (!size || !std::binary_search(movable.begin(), movable.end(), block + kHeaderSize))
+			{
+				if (run) largest = std::max(largest, run - kHeaderSize);
+				run = 0;
+				if (!size) break;
+			}
+		}
+
+		return largest;
+	}
+
+
+	void TlsfHeap::PrintStats(const BlockIndex &blocks) const
+	{
+		uint32_t used = 0;
+		uint32_t free = 0;
+
+		for (uint32_t block = _firstBlock; size(block); block = nextPhys(block))
+		{
+			if (isFree(block)) ++free;
+			else ++used;
+		}
+
+		fprintf(stdout, "TLSF blocks: %u allocated, %u free, %u bytes of headers\n",
+			used, free, (used + free + 1) * kHeaderSize);
+
+		Allocator::PrintStats(blocks);
+	}
+
+
+	// the headers and links are in the heap -- only the lists need saving.
+	void TlsfHeap::SaveState(FILE *f) const
+	{
+		State::Write(f, _firstBlock);
+		State::Write(f, _freeBytes);
+		State::Write(f, _flBitmap);
+		State::Write(f, _slBitmap);
+		State::Write(f, _heads);
+	}
+
+	void TlsfHeap::LoadState(uint8_t *memory, FILE *f)
+	{
+		_memory = memory;
+
+		State::Read(f, _firstBlock);
+		State::Read(f, _freeBytes);
+		State::Read(f, _flBitmap);
+		State::Read(f, _slBitmap);
+		State::Read(f, _heads);
+	}
+
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+
+#ifndef __mpw_mm_tlsf_h__
+#define __mpw_mm_tlsf_h__
+
+#include <cstdint>
+#include <cstdio>
+
+#include "mm_allocator.h"
+
+/*
+ * --allocator=tlsf
+ *
+ * Two level segregated fit (Masmano et al.)  Free blocks are kept in
+ * kFLCount x kSLCount lists -- the first level is the power of two, the
+ * second level splits that in kSLCount -- with a bitmap for each level,
+ * so finding a free block is a couple of find-first-set operations.
+ * Freed blocks are merged with free neighbors right away.
+ *
+ * Every block has an 8 byte header just before it in the heap:
+ *
+ * +0 previous block's header (0 for the first block)
+ * +4 size | kFree | kPrevFree
+ *
+ * and a free block keeps its list links in its first 8 bytes.  These are
+ * host-endian emulated addresses.  A zero sized, allocated sentinel
+ * block ends the heap.
+ *
+ * Compact slides each movable block down over the free block before it,
+ * so the free space between two blocks that can't move ends up in one
+ * piece at the top.
+ */
+namespace MM {
+
+	class TlsfHeap : public Allocator
+	{
+	public:
+
+		const char *Name() const override { return "tlsf"; }
+		bool Init(uint8_t *memory, uint32_t base, uint32_t size) override;
+
+		uint32_t Allocate(uint32_t size) override;
+		void Free(uint32_t address) override;
+		bool Resize(uint32_t address, uint32_t size) override;
+
+		uint32_t BlockSize(uint32_t address) const override;
+		uint32_t FreeBytes() const override { return _freeBytes; }
+		uint32_t MaxBlock() const override;
+
+		uint32_t AllocateHigh(uint32_t size) override;
+		void Compact(const Movable &movable, const Moved &moved) override;
+		uint32_t CompactedMaxBlock(const Movable &movable) const override;
+
+		void PrintStats(const BlockIndex &blocks) const override;
+
+		void SaveState(FILE *f) const override;
+		void LoadState(uint8_t *memory, FILE *f) override;
+
+	private:
+
+		static const uint32_t kAlign = 8;
+		static const uint32_t kHeaderSize = 8;
+		static const uint32_t kMinBlock = 8; // room for the links.
+
+		static const unsigned kSLShift = 5;
+		static const unsigned kSLCount = 1 << kSLShift;
+		static const unsigned kFLShift = kSLShift + 3; // 3 == log2(kAlign)
+		static const unsigned kFLCount = 32 - kFLShift + 1;
+		static const uint32_t kSmallBlock = 1 << kFLShift;
+
+		static const uint32_t kFree = 1;
+		static const uint32_t kPrevFree = 2;
+		static const uint32_t kFlags = kFree | kPrevFree;
+
+		// block headers.
+		uint32_t &prevPhys(uint32_t block) const { return word(block); }
+		uint32_t &sizeWord(uint32_t block) const { return word(block + 4); }
+		uint32_t &nextFree(uint32_t block) const { return word(block + 8); }
+		uint32_t &prevFree(uint32_t block) const { return word(block + 12); }
+
+		uint32_t &word(uint32_t address) const { return *(uint32_t *)(_memory + address); }
+
+		uint32_t size(uint32_t block) const { return sizeWord(block) & ~kFlags; }
+		void setSize(uint32_t block, uint32_t size) { sizeWord(block) = size | (sizeWord(block) & kFlags); }
+		bool isFree(uint32_t block) const { return sizeWord(block) & kFree; }
+		bool isPrevFree(uint32_t block) const { return sizeWord(block) & kPrevFree; }
+		uint32_t nextPhys(uint32_t block) const { return block + kHeaderSize + size(block); }
+
+		void setFree(uint32_t block, bool free);
+
+		static void mapping(uint32_t size, unsigned &fl, unsigned &sl);
+		static uint32_t adjust(uint32_t size);
+
+		void insert(uint32_t block);
+		void remove(uint32_t block);
+		uint32_t find(uint32_t size);
+		void split(uint32_t block, uint32_t size);
+		uint32_t merge(uint32_t block);
+
+		uint32_t _firstBlock = 0;
+		uint32_t _freeBytes = 0;
+
+		uint32_t _flBitmap = 0;
+		uint32_t _slBitmap[kFLCount] = {};
+		uint32_t _heads[kFLCount][kSLCount] = {};
+	};
+
+}
+
+#endif
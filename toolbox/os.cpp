@@ -51,11 +51,13 @@
 
 #include "os.h"
 #include "os_internal.h"
+#include "context.h"
 #include "toolbox.h"
 #include "stackframe.h"
 #include "fs_spec.h"
 
 using ToolBox::Log;
+using ToolBox::Context;
 
 using MacOS::macos_error_from_errno;
 
@@ -1129,21 +1131,6 @@ namespace OS
 
 	#pragma mark - Timer
 
-	struct TimerEntry {
-		uint32_t tmTaskPtr = 0; // address of the queue.  passed back in A1.
-		uint32_t tmAddr = 0;
-		bool extended = false;
-		bool active = false;
-
-		std::chrono::time_point<std::chrono::steady_clock> when;
-
-		TimerEntry(uint32_t a, uint32_t b) : tmTaskPtr(a), tmAddr(b)
-		{}
-	};
-
-	// heap sorted by next task to run?
-	static std::deque<TimerEntry> TimerQueue;
-
 	namespace TMTask {
 		enum  {
 			_qLink = 0,
@@ -1183,7 +1170,7 @@ namespace OS
 			memoryWriteLong(0, tmTaskPtr + _tmWakeUp);
 			memoryWriteLong(0, tmTaskPtr + _tmReserved);
 
-			TimerQueue.emplace_back(tmTaskPtr, memoryReadLong(tmTaskPtr + _tmAddr));
+			Context().TimerQueue.emplace_back(tmTaskPtr, memoryReadLong(tmTaskPtr + _tmAddr));
 		}
 
 		return MacOS::noErr;
@@ -1212,11 +1199,12 @@ namespace OS
 
 		if (tmTaskPtr)
 		{
-			auto iter = std::find_if(TimerQueue.begin(), TimerQueue.end(), [tmTaskPtr](const TimerEntry &e){
+			auto &queue = Context().TimerQueue;
+			auto iter = std::find_if(queue.begin(), queue.end(), [tmTaskPtr](const Internal::TimerEntry &e){
 				return e.tmTaskPtr == tmTaskPtr;
 			});
 
-			if (iter != TimerQueue.end() && !iter->active)
+			if (iter != queue.end() && !iter->active)
 			{
 				auto now = std::chrono::steady_clock::now();
 
@@ -1269,11 +1257,12 @@ namespace OS
 
 		if (tmTaskPtr)
 		{
-			auto iter = std::find_if(TimerQueue.begin(), TimerQueue.end(), [tmTaskPtr](const TimerEntry &e){
+			auto &queue = Context().TimerQueue;
+			auto iter = std::find_if(queue.begin(), queue.end(), [tmTaskPtr](const Internal::TimerEntry &e){
 				return e.tmTaskPtr == tmTaskPtr;
 			});
 
-			if (iter != TimerQueue.end())
+			if (iter != queue.end())
 			{
 				uint32_t count = 0;
 				if (iter->active)
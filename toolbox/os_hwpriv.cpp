@@ -54,6 +54,7 @@ namespace OS {
 		// PROCEDURE FlushInstructionCache;
 
 		Log("     FlushInstructionCache()\n");
+		cpuBlockCacheFlush();
 		return 0;
 	}
 
@@ -87,6 +88,7 @@ namespace OS {
 		uint32_t count = cpuGetAReg(1);
 
 		Log("     FlushCodeCacheRange(%08x, %08x)\n", address, count);
+		cpuBlockCacheInvalidate(address, count);
 		return 0;
 	}
 
@@ -94,6 +96,7 @@ namespace OS {
 	{
 		// PROCEDURE FlushCodeCache;
 		Log("%04x FlushCodeCache()\n", trap);
+		cpuBlockCacheFlush();
 		return 0;
 	}
 
@@ -25,6 +25,7 @@
  */
 
 #include "os_internal.h"
+#include "context.h"
 #include "os.h"
 #include "toolbox.h"
 
@@ -383,7 +384,11 @@ namespace OS { namespace Internal {
 
 	//std::deque<FDEntry> FDTable;
 
-	std::deque<FDEntry> FDEntry::FDTable;
+	std::deque<FDEntry> &FDEntry::FDTable()
+	{
+		return ToolBox::Context().FDTable;
+	}
+
 	FDEntry& FDEntry::allocate(int fd)
 	{
 		std::string noname;
@@ -395,10 +400,10 @@ namespace OS { namespace Internal {
 	{
 		if (fd < 0) throw std::out_of_range("Invalid FD");
 
-		if (FDTable.size() <= fd)
-			FDTable.resize(fd + 1);
+		if (FDTable().size() <= fd)
+			FDTable().resize(fd + 1);
 
-		auto &e = FDTable[fd];
+		auto &e = FDTable()[fd];
 		e.refcount = 1;
 		e.text = false;
 		e.resource = false;
@@ -410,10 +415,10 @@ namespace OS { namespace Internal {
 	{
 		if (fd < 0) throw std::out_of_range("Invalid FD");
 
-		if (FDTable.size() <= fd)
-			FDTable.resize(fd + 1);
+		if (FDTable().size() <= fd)
+			FDTable().resize(fd + 1);
 
-		auto &e = FDTable[fd];
+		auto &e = FDTable()[fd];
 		e.refcount = 1;
 		e.text = false;
 		e.resource = false;
@@ -424,12 +429,12 @@ namespace OS { namespace Internal {
 
 	int FDEntry::close(int fd, bool force)
 	{
-		if (fd < 0 || fd >= FDTable.size())
+		if (fd < 0 || fd >= FDTable().size())
 		{
 			errno = EBADF;
 			return -1;
 		}
-		auto &e = FDTable[fd];
+		auto &e = FDTable()[fd];
 		if (!e.refcount)
 		{
 			errno = EBADF;
@@ -447,13 +452,13 @@ namespace OS { namespace Internal {
 
 	ssize_t FDEntry::read(int fd, void *buffer, size_t count)
 	{
-		if (fd < 0 || fd >= FDTable.size())
+		if (fd < 0 || fd >= FDTable().size())
 		{
 			errno = EBADF;
 			return -1;
 		}
 
-		auto const &e = FDTable[fd];
+		auto const &e = FDTable()[fd];
 		if (!e.refcount)
 		{
 			errno = EBADF;
@@ -485,13 +490,13 @@ namespace OS { namespace Internal {
 
 	ssize_t FDEntry::write(int fd, const void *buffer, size_t count)
 	{
-		if (fd < 0 || fd >= FDTable.size())
+		if (fd < 0 || fd >= FDTable().size())
 		{
 			errno = EBADF;
 			return -1;
 		}
 
-		auto const &e = FDTable[fd];
+		auto const &e = FDTable()[fd];
 		if (!e.refcount)
 		{
 			errno = EBADF;
@@ -1,6 +1,8 @@
 #ifndef __mpw_os_internal_h__
 #define __mpw_os_internal_h__
 
+#include <chrono>
+#include <cstdint>
 #include <deque>
 #include <string>
 #include <sys/types.h>
@@ -38,7 +40,8 @@ namespace Internal {
 			resource(false)
 		{}
 
-		static std::deque<FDEntry> FDTable;
+		// the current EmulatorContext's table.
+		static std::deque<FDEntry> &FDTable();
 
 		static FDEntry& allocate(int fd);
 		static FDEntry& allocate(int fd, std::string &&filename);
@@ -55,12 +58,12 @@ namespace Internal {
 		template<class F1, class F2>
 		static int32_t action(int fd, F1 good, F2 bad)
 		{
-			if (fd < 0 || fd >= FDTable.size())
+			if (fd < 0 || fd >= FDTable().size())
 			{
 				return bad(fd);
 			}
 
-			auto &e = FDTable[fd];
+			auto &e = FDTable()[fd];
 			if (e.refcount)
 			{
 				return good(fd, e);
@@ -74,6 +77,19 @@ namespace Internal {
 	};
 
 
+	// Time Manager task (InsTime / PrimeTime).
+	struct TimerEntry {
+		uint32_t tmTaskPtr = 0; // address of the queue.  passed back in A1.
+		uint32_t tmAddr = 0;
+		bool extended = false;
+		bool active = false;
+
+		std::chrono::time_point<std::chrono::steady_clock> when;
+
+		TimerEntry(uint32_t a, uint32_t b) : tmTaskPtr(a), tmAddr(b)
+		{}
+	};
+
 } }
 
 #endif
@@ -46,6 +46,7 @@
 #include "stackframe.h"
 #include "os.h"
 #include "packages.h"
+#include "dispatch.h"
 
 using ToolBox::Log;
 using OS::MacToUnix;
@@ -640,56 +641,38 @@ typedef union LongDateRec               LongDateRec;
 
 	uint16_t Pack6(uint16_t trap)
 	{
+		static ToolBox::SelectorTable table("Pack6", {
+			{ 0x0000, "IUDateString", IUDateString },
+			{ 0x0002, "IUTimeString", IUTimeString },
+			// { 0x0004, "IsMetric", IsMetric },
+			{ 0x0006, "GetIntlResource", GetIntlResource },
+			// { 0x0008, "SetIntlResource", SetIntlResource },
+			{ 0x000e, "IUDatePString", IUDatePString },
+			{ 0x0010, "IUTimePString", IUTimePString },
+		});
 
 		uint16_t selector;
 		StackFrame<2>(selector);
 
 		Log("%04x Pack6(%04x)\n", trap, selector);
 
-		switch(selector)
-		{
-		case 0x0000:
-			return IUDateString();
-		case 0x0002:
-			return IUTimeString();
-		// case 0x0004: return IsMetric();
-		case 0x0006:
-			return GetIntlResource();
-		// case 0x0008: return SetIntlResource();
-		case 0x000e:
-			return IUDatePString();
-		case 0x0010:
-			return IUTimePString();
-
-		default:
-			fprintf(stderr, "Pack6: selector %04x not supported\n", selector);
-			exit(1);
-		}
-		return 0;
+		return table.dispatch(selector);
 	}
 
 
 	uint16_t ScriptUtil(uint16_t trap)
 	{
+		static ToolBox::SelectorTable table("ScriptUtil", {
+			{ 0x8204fff8, "InitDateCache", InitDateCache },
+			{ 0x8214fff6, "StringToDate", StringToDate },
+			{ 0x8214fff4, "StringToTime", StringToTime },
+		});
+
 		uint32_t selector;
 		StackFrame<4>(selector);
 		Log("%04x ScriptUtil(%08x)\n", trap, selector);
 
-		switch(selector)
-		{
-		case 0x8204fff8:
-			return InitDateCache();
-		case 0x8214fff6:
-			return StringToDate();
-		case 0x8214fff4:
-			return StringToTime();
-		default:
-			fprintf(stderr, "ScriptUtil: selector %08x not supported\n", selector);
-			exit(1);
-		}
-
-
-
+		return table.dispatch(selector);
 	}
 
 }
@@ -196,6 +196,7 @@ namespace RM
 				return SetResError(error);
 			}
 			MM::Native::HSetRBit(theHandle);
+			MM::Native::TouchHandle(theHandle);
 
 			if (size)
 				std::memcpy(memoryPointer(ptr), *(void **)nativeHandle, size);
@@ -1177,6 +1178,8 @@ namespace RM
 		// if it has a size, it's loaded...
 		auto info = MM::GetHandleInfo(theResource);
 		if (info.error()) return SetResError(resNotFound);
+
+		MM::Native::TouchHandle(theResource);
 		if (info->size) return SetResError(0);
 
 		// otherwise, load it
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+
+#ifndef __mpw_toolbox_state_h__
+#define __mpw_toolbox_state_h__
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * --snapshot / --restore helpers.  Same host, same build, so values are
+ * written as they are in memory.  Like cpuLoadState, reads don't check
+ * for errors; the caller checks the FILE when everything is read.
+ */
+namespace State {
+
+	template<class T>
+	void Write(FILE *f, const T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "not a plain value");
+		fwrite(&value, sizeof(T), 1, f);
+	}
+
+	template<class T>
+	void Read(FILE *f, T &value)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "not a plain value");
+		fread(&value, sizeof(T), 1, f);
+	}
+
+	inline void Write(FILE *f, const std::string &s)
+	{
+		Write(f, (uint32_t)s.size());
+		fwrite(s.data(), 1, s.size(), f);
+	}
+
+	inline void Read(FILE *f, std::string &s)
+	{
+		uint32_t size = 0;
+		Read(f, size);
+		s.resize(size);
+		if (size) fread(&s[0], 1, size, f);
+	}
+
+	template<class T>
+	void Write(FILE *f, const std::vector<T> &v)
+	{
+		Write(f, (uint32_t)v.size());
+		for (const auto &x : v) Write(f, x);
+	}
+
+	template<class T>
+	void Read(FILE *f, std::vector<T> &v)
+	{
+		uint32_t size = 0;
+		Read(f, size);
+		v.resize(size);
+		for (auto &x : v) Read(f, x);
+	}
+
+	template<class T>
+	void Write(FILE *f, const std::deque<T> &v)
+	{
+		Write(f, (uint32_t)v.size());
+		for (const auto &x : v) Write(f, x);
+	}
+
+	template<class T>
+	void Read(FILE *f, std::deque<T> &v)
+	{
+		uint32_t size = 0;
+		Read(f, size);
+		v.resize(size);
+		for (auto &x : v) Read(f, x);
+	}
+
+	template<class Map>
+	void WriteMap(FILE *f, const Map &m)
+	{
+		Write(f, (uint32_t)m.size());
+		for (const auto &kv : m)
+		{
+			Write(f, kv.first);
+			Write(f, kv.second);
+		}
+	}
+
+	template<class Map>
+	void ReadMap(FILE *f, Map &m)
+	{
+		uint32_t size = 0;
+		Read(f, size);
+		m.clear();
+		while (size-- && !feof(f))
+		{
+			typename Map::key_type key;
+			typename Map::mapped_type value;
+			Read(f, key);
+			Read(f, value);
+			m.emplace(std::move(key), std::move(value));
+		}
+	}
+
+	template<class K, class V>
+	void Write(FILE *f, const std::map<K, V> &m) { WriteMap(f, m); }
+
+	template<class K, class V>
+	void Read(FILE *f, std::map<K, V> &m) { ReadMap(f, m); }
+
+	template<class K, class V>
+	void Write(FILE *f, const std::unordered_map<K, V> &m) { WriteMap(f, m); }
+
+	template<class K, class V>
+	void Read(FILE *f, std::unordered_map<K, V> &m) { ReadMap(f, m); }
+
+}
+
+#endif
@@ -0,0 +1,508 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include <cpu/defs.h>
+#include <cpu/CpuModule.h>
+#include <cpu/fmem.h>
+
+#include "stdclib.h"
+#include "context.h"
+#include "loader.h"
+#include "toolbox.h"
+#include "mm.h"
+#include "state.h"
+
+using ToolBox::Log;
+using ToolBox::Context;
+
+namespace StdCLib {
+
+	unsigned Mode = kDisabled;
+
+	namespace {
+
+		/*
+		 * patched entry point:
+		 * kTrap -- unassigned tool trap
+		 * index -- routine index
+		 *
+		 * the routines use the MPW C calling convention: arguments are
+		 * 4-byte values on the stack, the caller pops them, the result is
+		 * returned in d0.  Only d0 is modified.
+		 */
+		const uint16_t kReturned = 0xffff; // verify mode sentinel.
+
+
+		// guest memory.  Reads past the end are 0 and writes are dropped,
+		// same as the memory layer.  Addresses may have flags in the high
+		// byte under --24; the limit checks use the stripped address.
+
+		bool InRange(uint32_t address, uint32_t size)
+		{
+			uint32_t limit = memoryGetSize();
+			address = memoryStripAddress(address);
+			return size <= limit && address <= limit - size;
+		}
+
+		void Read(uint32_t address, uint8_t *dest, uint32_t size)
+		{
+			if (InRange(address, size))
+			{
+				std::memcpy(dest, memoryPointer(address), size);
+				return;
+			}
+			for (uint32_t i = 0; i < size; ++i)
+				dest[i] = memoryReadByte(address + i);
+		}
+
+		void Write(uint32_t address, const uint8_t *src, uint32_t size)
+		{
+			if (InRange(address, size))
+			{
+				std::memcpy(memoryPointer(address), src, size);
+				cpuBlockCacheInvalidate(address, size);
+				return;
+			}
+			for (uint32_t i = 0; i < size; ++i)
+				memoryWriteByte(src[i], address + i);
+		}
+
+		uint32_t Length(uint32_t s)
+		{
+			uint32_t limit = memoryGetSize();
+			s = memoryStripAddress(s);
+			if (s >= limit) return 0;
+
+			const uint8_t *p = memoryPointer(s);
+			const uint8_t *z = (const uint8_t *)std::memchr(p, 0, limit - s);
+			return z ? z - p : limit - s;
+		}
+
+		void Fill(uint32_t dest, uint8_t c, uint32_t size)
+		{
+			if (InRange(dest, size))
+			{
+				std::memset(memoryPointer(dest), c, size);
+				cpuBlockCacheInvalidate(dest, size);
+				return;
+			}
+			for (uint32_t i = 0; i < size; ++i)
+				memoryWriteByte(c, dest + i);
+		}
+
+		int32_t Compare(uint32_t a, uint32_t b, uint32_t size)
+		{
+			if (InRange(a, size) && InRange(b, size))
+				return std::memcmp(memoryPointer(a), memoryPointer(b), size);
+
+			for (uint32_t i = 0; i < size; ++i)
+			{
+				int32_t d = memoryReadByte(a + i) - memoryReadByte(b + i);
+				if (d) return d;
+			}
+			return 0;
+		}
+
+		uint32_t Find(uint32_t s, uint8_t c, uint32_t size)
+		{
+			if (InRange(s, size))
+			{
+				const uint8_t *p = memoryPointer(s);
+				const uint8_t *q = (const uint8_t *)std::memchr(p, c, size);
+				return q ? s + (q - p) : 0;
+			}
+			for (uint32_t i = 0; i < size; ++i)
+				if (memoryReadByte(s + i) == c) return s + i;
+			return 0;
+		}
+
+
+		struct Routine {
+			const char *name;
+			uint32_t (*call)(const uint32_t *argv);
+			// memory the routine writes (verify mode), nullptr if none.
+			void (*extent)(const uint32_t *argv, uint32_t &address, uint32_t &size);
+			bool sign; // only the sign of the result is defined.
+		};
+
+		const Routine Routines[] = {
+			{ "strlen",
+				[](const uint32_t *argv) -> uint32_t {
+					return Length(argv[0]);
+				},
+				nullptr, false
+			},
+
+			{ "strcpy",
+				[](const uint32_t *argv) -> uint32_t {
+					memoryMove(argv[0], argv[1], Length(argv[1]) + 1);
+					return argv[0];
+				},
+				[](const uint32_t *argv, uint32_t &address, uint32_t &size) {
+					address = argv[0];
+					size = Length(argv[1]) + 1;
+				},
+				false
+			},
+
+			{ "strncpy",
+				[](const uint32_t *argv) -> uint32_t {
+					uint32_t n = std::min(Length(argv[1]), argv[2]);
+					memoryMove(argv[0], argv[1], n);
+					Fill(argv[0] + n, 0, argv[2] - n);
+					return argv[0];
+				},
+				[](const uint32_t *argv, uint32_t &address, uint32_t &size) {
+					address = argv[0];
+					size = argv[2];
+				},
+				false
+			},
+
+			{ "strcat",
+				[](const uint32_t *argv) -> uint32_t {
+					memoryMove(argv[0] + Length(argv[0]), argv[1], Length(argv[1]) + 1);
+					return argv[0];
+				},
+				[](const uint32_t *argv, uint32_t &address, uint32_t &size) {
+					address = argv[0] + Length(argv[0]);
+					size = Length(argv[1]) + 1;
+				},
+				false
+			},
+
+			{ "strcmp",
+				[](const uint32_t *argv) -> uint32_t {
+					uint32_t n = std::min(Length(argv[0]), Length(argv[1])) + 1;
+					return Compare(argv[0], argv[1], n);
+				},
+				nullptr, true
+			},
+
+			{ "strncmp",
+				[](const uint32_t *argv) -> uint32_t {
+					uint32_t n = std::min(Length(argv[0]), Length(argv[1])) + 1;
+					return Compare(argv[0], argv[1], std::min(n, argv[2]));
+				},
+				nullptr, true
+			},
+
+			{ "strchr",
+				[](const uint32_t *argv) -> uint32_t {
+					uint32_t n = Length(argv[0]);
+					if ((uint8_t)argv[1] == 0) return argv[0] + n;
+					return Find(argv[0], argv[1], n);
+				},
+				nullptr, false
+			},
+
+			{ "strrchr",
+				[](const uint32_t *argv) -> uint32_t {
+					uint32_t n = Length(argv[0]);
+					if ((uint8_t)argv[1] == 0) return argv[0] + n;
+
+					// Length keeps the string in range.
+					const uint8_t *p = memoryPointer(argv[0]);
+					while (n--)
+						if (p[n] == (uint8_t)argv[1]) return argv[0] + n;
+					return 0;
+				},
+				nullptr, false
+			},
+
+			{ "memcpy",
+				[](const uint32_t *argv) -> uint32_t {
+					memoryMove(argv[0], argv[1], argv[2]);
+					return argv[0];
+				},
+				[](const uint32_t *argv, uint32_t &address, uint32_t &size) {
+					address = argv[0];
+					size = argv[2];
+				},
+				false
+			},
+
+			{ "memmove",
+				[](const uint32_t *argv) -> uint32_t {
+					memoryMove(argv[0], argv[1], argv[2]);
+					return argv[0];
+				},
+				[](const uint32_t *argv, uint32_t &address, uint32_t &size) {
+					address = argv[0];
+					size = argv[2];
+				},
+				false
+			},
+
+			{ "memset",
+				[](const uint32_t *argv) -> uint32_t {
+					Fill(argv[0], argv[1], argv[2]);
+					return argv[0];
+				},
+				[](const uint32_t *argv, uint32_t &address, uint32_t &size) {
+					address = argv[0];
+					size = argv[2];
+				},
+				false
+			},
+
+			{ "memcmp",
+				[](const uint32_t *argv) -> uint32_t {
+					return Compare(argv[0], argv[1], argv[2]);
+				},
+				nullptr, true
+			},
+
+			{ "memchr",
+				[](const uint32_t *argv) -> uint32_t {
+					return Find(argv[0], argv[1], argv[2]);
+				},
+				nullptr, false
+			},
+		};
+
+		const unsigned kRoutineCount = sizeof(Routines) / sizeof(Routines[0]);
+
+
+		int Sign(uint32_t x)
+		{
+			return (int32_t)x < 0 ? -1 : x != 0;
+		}
+
+		/*
+		 * runs the native version, puts the memory it wrote back, then
+		 * runs the original code (returning to the sentinel) and
+		 * compares the results.  The guest results are kept.
+		 *
+		 * n.b. -- instructions executed here are not included in
+		 * cpuGetInstructionCount().
+		 */
+		uint32_t Verify(const Routine &r, uint32_t entry, const uint32_t *argv)
+		{
+			uint32_t address = 0;
+			uint32_t size = 0;
+
+			if (r.extent)
+			{
+				uint32_t limit = memoryGetSize();
+				r.extent(argv, address, size);
+				address = memoryStripAddress(address);
+				if (address >= limit) size = 0;
+				else size = std::min(size, limit - address);
+			}
+
+			std::vector<uint8_t> before(size), native(size), guest(size);
+
+			Read(address, before.data(), size);
+			uint32_t expected = r.call(argv);
+			Read(address, native.data(), size);
+			Write(address, before.data(), size);
+
+
+			auto &ctx = Context();
+			auto iter = ctx.StdCLibOriginal.find(entry);
+			if (iter == ctx.StdCLibOriginal.end())
+			{
+				fprintf(stderr, "StdCLib: %s at %08x is not patched\n", r.name, entry);
+				exit(255);
+			}
+
+			uint32_t sp = cpuGetAReg(7);
+			uint32_t returnPC = memoryReadLong(sp);
+			uint32_t patch = memoryReadLong(entry);
+
+			memoryWriteLong(ctx.StdCLibSentinel, sp);
+			memoryWriteLong(iter->second, entry);
+			cpuInitializeFromNewPC(entry);
+
+			ctx.StdCLibReturned = false;
+			while (!ctx.StdCLibReturned)
+			{
+				uint32_t reason = cpuExecuteUntil(0x10000, CPU_EXECUTE_TRAP);
+				if ((reason & CPU_EXECUTE_STOP) || cpuGetPC() == 0)
+				{
+					fprintf(stderr, "StdCLib: %s did not return\n", r.name);
+					exit(255);
+				}
+			}
+
+			uint32_t actual = cpuGetDReg(0);
+			Read(address, guest.data(), size);
+
+			memoryWriteLong(returnPC, sp);
+			memoryWriteLong(patch, entry);
+
+			bool ok = r.sign ? Sign(expected) == Sign(actual) : expected == actual;
+			if (!ok || native != guest)
+			{
+				fprintf(stderr, "StdCLib: %s(%08x, %08x, %08x) native: %08x guest: %08x%s\n",
+					r.name, argv[0], argv[1], argv[2], expected, actual,
+					native != guest ? " (memory differs)" : "");
+			}
+
+			return actual;
+		}
+
+		/*
+		 * the MacsBug name table only gives the bounds of the routine.
+		 * make sure it ends with rts (C calling convention) and has room
+		 * for the patch.
+		 */
+		bool IsCFunction(uint32_t start, uint32_t end)
+		{
+			if (start & 0x01) return false;
+
+			for (uint32_t pc = start; pc + 2 <= end; pc += 2)
+			{
+				switch (memoryReadWord(pc))
+				{
+				case 0x4E75: // rts
+					return pc >= start + 2;
+
+				case 0x4E74: // rtd #
+				case 0x4ED0: // jmp (a0)
+					return false;
+
+				default:
+					break;
+				}
+			}
+			return false;
+		}
+
+	}
+
+
+	uint32_t Dispatch(uint16_t trap)
+	{
+		uint32_t pc = cpuGetPC();
+		uint16_t index = memoryReadWord(pc);
+
+		if (index == kReturned)
+		{
+			// back from the original code (verify mode).  Stay on the
+			// sentinel -- moving the pc ends the current block.
+			Context().StdCLibReturned = true;
+			cpuInitializeFromNewPC(pc - 2);
+			return cpuGetDReg(0);
+		}
+
+		if (index >= kRoutineCount)
+		{
+			fprintf(stderr, "StdCLib: invalid routine %04x\n", index);
+			fprintf(stderr, "pc: %08x\n", pc);
+			exit(255);
+		}
+
+		const Routine &r = Routines[index];
+
+		uint32_t sp = cpuGetAReg(7);
+		uint32_t returnPC = memoryReadLong(sp);
+		uint32_t argv[3];
+
+		for (unsigned i = 0; i < 3; ++i)
+			argv[i] = memoryReadLong(sp + 4 + i * 4);
+
+		Log("%04x %s(%08x, %08x, %08x)\n", trap, r.name, argv[0], argv[1], argv[2]);
+
+		uint32_t d0 = Context().StdCLibMode == kVerify ? Verify(r, pc - 2, argv) : r.call(argv);
+
+		// rts
+		cpuSetAReg(7, sp + 4);
+		cpuInitializeFromNewPC(returnPC);
+		return d0;
+	}
+
+
+	void Install()
+	{
+		auto &ctx = Context();
+
+		ctx.StdCLibMode = Mode;
+		ctx.StdCLibOriginal.clear();
+
+		if (Mode == kDisabled) return;
+
+		Loader::DebugNameTable names;
+		Loader::Native::LoadDebugNames(names);
+
+		for (unsigned index = 0; index < kRoutineCount; ++index)
+		{
+			const Routine &r = Routines[index];
+
+			auto iter = names.find(r.name);
+			if (iter == names.end()) continue;
+
+			uint32_t entry = iter->second.first;
+			if (!IsCFunction(entry, iter->second.second)) continue;
+
+			ctx.StdCLibOriginal[entry] = memoryReadLong(entry);
+			memoryWriteWord(kTrap, entry + 0);
+			memoryWriteWord(index, entry + 2);
+		}
+
+		if (ctx.StdCLibOriginal.empty()) return;
+
+		if (Mode == kVerify && !ctx.StdCLibSentinel)
+		{
+			if (MM::Native::NewPtr(4, false, ctx.StdCLibSentinel))
+			{
+				fprintf(stderr, "StdCLib: unable to allocate memory\n");
+				exit(255);
+			}
+			memoryWriteWord(kTrap, ctx.StdCLibSentinel + 0);
+			memoryWriteWord(kReturned, ctx.StdCLibSentinel + 2);
+		}
+	}
+
+	void SaveState(FILE *f)
+	{
+		auto &ctx = Context();
+
+		State::Write(f, ctx.StdCLibMode);
+		State::Write(f, ctx.StdCLibOriginal);
+		State::Write(f, ctx.StdCLibSentinel);
+	}
+
+	void LoadState(FILE *f)
+	{
+		// the patched entry points are in the saved memory, so the saved
+		// mode wins over --native-lib.
+		auto &ctx = Context();
+
+		State::Read(f, ctx.StdCLibMode);
+		State::Read(f, ctx.StdCLibOriginal);
+		State::Read(f, ctx.StdCLibSentinel);
+	}
+
+}
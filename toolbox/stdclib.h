@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2014, Kelvin W Sherlock
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef __mpw_toolbox_stdclib_h__
+#define __mpw_toolbox_stdclib_h__
+
+#include <cstdint>
+#include <cstdio>
+
+/*
+ * native versions of hot StdCLib routines (strlen, memcpy, ...).
+ *
+ * Routines linked into the tool are found by their MacsBug names once
+ * the segments are loaded and their entry points are patched with a
+ * private trap ($abf0 + routine index) that runs the native version on
+ * emulated memory and returns to the caller.
+ */
+namespace StdCLib {
+
+	enum {
+		kDisabled = 0,
+		kEnabled,
+		kVerify, // run both versions and compare.
+	};
+
+	// --native-lib[=verify]
+	extern unsigned Mode;
+
+	// the patched entry points call this unassigned tool trap.  The
+	// handler is registered with the native traps.
+	const uint16_t kTrap = 0xabf0;
+	uint32_t Dispatch(uint16_t trap);
+
+	// called by Loader::Native::LoadFile after all segments are loaded.
+	void Install();
+
+	// --snapshot / --restore.
+	void SaveState(FILE *f);
+	void LoadState(FILE *f);
+
+}
+
+#endif
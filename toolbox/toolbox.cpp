@@ -40,6 +40,7 @@
 #include <macos/errors.h>
 
 #include "toolbox.h"
+#include "context.h"
 
 #include "loader.h"
 #include "mm.h"
@@ -64,6 +65,8 @@ namespace ToolBox {
 
 	bool Trace = false;
 
+	thread_local EmulatorContext *CurrentContext = nullptr;
+
 #ifdef OLD_TRAP_DISPATCH
 
 	uint16_t OSDispatch(uint16_t trap)
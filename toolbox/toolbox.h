@@ -25,6 +25,10 @@ namespace ToolBox
 	bool Init();
 	void dispatch(uint16_t trap);
 
+	// --snapshot / --restore.  LoadState replaces Init.
+	void SaveState(FILE *f);
+	void LoadState(FILE *f);
+
 
 	std::string ReadCString(uint32_t address, bool fname = false);
 	std::string ReadPString(uint32_t address, bool fname = false);